@@ -0,0 +1,16 @@
+#ifndef BOOT_TIME_H
+#define BOOT_TIME_H
+
+#include <cstdint>
+
+// Boot phase timestamps: microseconds since reset at the end of each phase.
+// USB serial is not up yet during boot, so they are kept for boot_report.
+void boot_phase(const char* name);
+
+// Time of the last phase so far (0 before the first)
+uint32_t boot_time_us();
+
+// Phases as JSON: {"boot_us": ..., "phases": [...]}
+void boot_report();
+
+#endif // BOOT_TIME_H
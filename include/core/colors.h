@@ -4,7 +4,7 @@
 #include <cstdint>
 
 // Color conversion function (RGB565)
-inline uint16_t color565(uint8_t red, uint8_t green, uint8_t blue) {
+constexpr uint16_t color565(uint8_t red, uint8_t green, uint8_t blue) {
     return ((red & 0xF8) << 8) | ((green & 0xFC) << 3) | (blue >> 3);
 }
 
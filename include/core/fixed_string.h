@@ -0,0 +1,43 @@
+#ifndef FIXED_STRING_H
+#define FIXED_STRING_H
+
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+
+// String in a fixed buffer of N characters (plus the terminating zero).
+// Longer input is cut at N, so it never touches the heap.
+template <size_t N>
+class FixedString {
+public:
+    FixedString() = default;
+    FixedString(std::string_view text) { assign(text); }
+
+    FixedString& operator=(std::string_view text) {
+        assign(text);
+        return *this;
+    }
+
+    void assign(std::string_view text) {
+        length_ = text.size() < N ? text.size() : N;
+        memcpy(data_, text.data(), length_);
+        data_[length_] = '\0';
+    }
+
+    void clear() {
+        length_ = 0;
+        data_[0] = '\0';
+    }
+
+    bool empty() const { return length_ == 0; }
+    size_t size() const { return length_; }
+    const char* c_str() const { return data_; }
+    std::string_view view() const { return std::string_view(data_, length_); }
+    operator std::string_view() const { return view(); }
+
+private:
+    char data_[N + 1] = {};
+    size_t length_ = 0;
+};
+
+#endif // FIXED_STRING_H
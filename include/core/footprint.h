@@ -0,0 +1,13 @@
+#ifndef FOOTPRINT_H
+#define FOOTPRINT_H
+
+// Memory footprint of the static-allocation profile (ROBOT_STATIC_ALLOC):
+// everything the firmware needs is allocated statically during init, after
+// which footprint_lock_heap() turns any malloc/new into a panic with the
+// allocation caught in the debugger instead of a slow leak.
+void footprint_lock_heap();
+
+// Flash image, static RAM, heap used so far and boot time as JSON: {"flash": ...}
+void footprint_report();
+
+#endif // FOOTPRINT_H
@@ -0,0 +1,69 @@
+#ifndef HEAP_PROF_H
+#define HEAP_PROF_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Heap profiler: every malloc/free/realloc (and so every new/delete) is
+// counted under the call-site tag of the innermost HEAP_TAG scope, with live
+// bytes and peak per tag and overall. On the device newlib's _malloc_r,
+// _free_r and _realloc_r are wrapped at link time (ROBOT_HEAP_PROF); a host
+// run (tools/heap_sim.cpp) feeds the same counters from its own new/delete.
+
+// Tags are string literals (compared by pointer, then by text)
+#ifndef HEAP_PROF_MAX_TAGS
+#define HEAP_PROF_MAX_TAGS 16
+#endif
+
+// Live allocations remembered for attributing frees, must be a power of two
+#ifndef HEAP_PROF_SLOTS
+#define HEAP_PROF_SLOTS 512
+#endif
+
+// Record one allocation or free (null pointers are counted as failed / ignored)
+void heap_prof_alloc(void* ptr, size_t size);
+void heap_prof_free(void* ptr);
+
+// Select the tag for following allocations; returns the previous one
+uint8_t heap_prof_push_tag(const char* tag);
+void heap_prof_pop_tag(uint8_t previous);
+
+// Free space of the arena: total and the largest block one malloc can get
+struct HeapArena {
+    uint32_t size;       // bytes taken from sbrk
+    uint32_t free;       // free chunks plus room left for sbrk
+    uint32_t largest;    // largest of them
+};
+// Provided by the platform glue (src/core/heap_wrap.cpp or the host tool)
+void heap_prof_arena(HeapArena& arena);
+
+// Live and peak bytes; per-tag counters for budgets and soak tests
+uint32_t heap_prof_live();
+uint32_t heap_prof_peak();
+uint32_t heap_prof_tag_peak(const char* tag);
+
+// Counters, arena and tags as JSON: {"heap_live": ...}
+void heap_prof_report();
+// Zero the counters; peaks restart from the live bytes
+void heap_prof_reset();
+
+// Scoped tag for a call site
+class HeapTag {
+public:
+    explicit HeapTag(const char* tag) : previous_(heap_prof_push_tag(tag)) {}
+    ~HeapTag() { heap_prof_pop_tag(previous_); }
+    HeapTag(const HeapTag&) = delete;
+    HeapTag& operator=(const HeapTag&) = delete;
+private:
+    uint8_t previous_;
+};
+
+#if ROBOT_HEAP_PROF
+#define HEAP_CONCAT_INNER(a, b) a##b
+#define HEAP_CONCAT(a, b) HEAP_CONCAT_INNER(a, b)
+#define HEAP_TAG(tag) HeapTag HEAP_CONCAT(heap_tag_, __LINE__)(tag)
+#else
+#define HEAP_TAG(tag) ((void)0)
+#endif
+
+#endif // HEAP_PROF_H
@@ -0,0 +1,22 @@
+#ifndef HOT_PATH_H
+#define HOT_PATH_H
+
+// Placement of the rendering hot paths (ROBOT_HOT_PATH build option). With
+// ROBOT_RAM_HOT_PATH, functions marked HOT_FUNC and face tables marked
+// HOT_ASSET are linked into SRAM, so pixel loops never stall on an XIP cache
+// miss. Library code they call (std::, SDK) stays in flash unless the whole
+// image is copied to RAM (ROBOT_HOT_PATH=copy_to_ram).
+#ifndef ROBOT_RAM_HOT_PATH
+#define ROBOT_RAM_HOT_PATH 0
+#endif
+
+#if ROBOT_RAM_HOT_PATH
+#include "pico.h"
+#define HOT_FUNC(...) __not_in_flash("hot_path") __VA_ARGS__
+#define HOT_ASSET __not_in_flash("hot_assets")
+#else
+#define HOT_FUNC(...) __VA_ARGS__
+#define HOT_ASSET
+#endif
+
+#endif // HOT_PATH_H
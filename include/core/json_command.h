@@ -0,0 +1,37 @@
+#ifndef JSON_COMMAND_H
+#define JSON_COMMAND_H
+
+#include <string_view>
+
+// Flat JSON commands from the serial link: {"cmd": "...", "key": value, ...}.
+// Nested objects and arrays are not supported; every key/value pair is a
+// string view into the command buffer, so parsing never touches the heap.
+
+// Parsed command fields: views into the command buffer
+static const int JSON_MAX_FIELDS = 16;
+
+struct JsonField {
+    std::string_view key;
+    std::string_view value;
+};
+
+struct JsonFields {
+    JsonField fields[JSON_MAX_FIELDS];
+    int count = 0;
+
+    // A repeated key: the last value wins
+    const JsonField* find(std::string_view key) const {
+        for (int i = count - 1; i >= 0; i--) {
+            if (fields[i].key == key) {
+                return &fields[i];
+            }
+        }
+        return nullptr;
+    }
+};
+
+// Parse `json` in place: keys and values are unquoted, moved to the start of
+// the buffer and zero-terminated. Fields past JSON_MAX_FIELDS are dropped.
+JsonFields parse_json(char* json);
+
+#endif // JSON_COMMAND_H
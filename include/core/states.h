@@ -2,9 +2,7 @@
 #define STATES_H
 
 #include <cstdint>
-#include <string>
-#include <unordered_map>
-#include <functional>
+#include <string_view>
 
 // Neutral state structure
 struct NeutralState {
@@ -26,7 +24,6 @@ struct TalkingState {
     uint8_t frame = 0;
     uint32_t start_time = 0;
     uint32_t last_frame = 0;
-    std::string emotion = "neutral";
     uint8_t syllables = 1;
     uint8_t program_step = 0;
     uint32_t last_step_time = 0;
@@ -51,7 +48,7 @@ NeutralState reset_neutral_state();
 TalkingState reset_talking_state();
 AnimState reset_anim_state();
 
-// Generic reset function
-void* reset_state(const std::string& emotion);
+// Generic reset function: the state lives in the caller's static storage
+void reset_state(std::string_view emotion, void* state);
 
 #endif // STATES_H
\ No newline at end of file
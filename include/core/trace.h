@@ -0,0 +1,81 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <cstdint>
+
+// Trace point identifiers (names live in trace.cpp)
+enum TraceId : uint8_t {
+    TRACE_READ_COMMAND = 0,
+    TRACE_PARSE_JSON,
+    TRACE_EMOTION_NEUTRAL,
+    TRACE_EMOTION_SMILE,
+    TRACE_EMOTION_SMILE_LOVE,
+    TRACE_EMOTION_EMBARRASSED,
+    TRACE_EMOTION_SCARY,
+    TRACE_EMOTION_HAPPY,
+    TRACE_EMOTION_SAD,
+    TRACE_EMOTION_SURPRISE,
+    TRACE_EMOTION_TALKING,
+    TRACE_DRAW_FULL,
+    TRACE_DRAW_INCREMENTAL,
+    TRACE_BORDER_CLEAR,
+    TRACE_YAWN_WAIT,
+    TRACE_DRAW_EYES,
+    TRACE_DRAW_PARTICLES,
+    TRACE_TEAR_WAIT,
+    TRACE_DLIST_FENCE,
+    TRACE_ID_COUNT
+};
+
+enum TracePhase : uint8_t {
+    TRACE_PHASE_BEGIN = 'B',
+    TRACE_PHASE_END = 'E'
+};
+
+// One ring buffer entry (8 bytes)
+struct TraceEvent {
+    uint32_t timestamp_us;
+    uint8_t id;
+    uint8_t phase;
+};
+
+// Ring buffer capacity in events, must be a power of two
+#ifndef TRACE_BUFFER_SIZE
+#define TRACE_BUFFER_SIZE 4096
+#endif
+
+// Record one event with a microsecond timestamp
+void trace_record(TraceId id, TracePhase phase);
+
+// Control functions
+void trace_start();
+void trace_stop();
+void trace_clear();
+
+// Print the buffer over serial, oldest event first
+void trace_dump();
+
+// Scoped begin/end pair for functions with several exits
+class TraceScope {
+public:
+    explicit TraceScope(TraceId id) : id_(id) { trace_record(id_, TRACE_PHASE_BEGIN); }
+    ~TraceScope() { trace_record(id_, TRACE_PHASE_END); }
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+private:
+    TraceId id_;
+};
+
+#if ROBOT_TRACE
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_BEGIN(id) trace_record((id), TRACE_PHASE_BEGIN)
+#define TRACE_END(id) trace_record((id), TRACE_PHASE_END)
+#define TRACE_SCOPE(id) TraceScope TRACE_CONCAT(trace_scope_, __LINE__)(id)
+#else
+#define TRACE_BEGIN(id) ((void)0)
+#define TRACE_END(id) ((void)0)
+#define TRACE_SCOPE(id) ((void)0)
+#endif
+
+#endif // TRACE_H
@@ -0,0 +1,9 @@
+#ifndef XIP_STATS_H
+#define XIP_STATS_H
+
+// XIP cache counters of the flash interface: accesses and hits since the
+// last reset, with where the hot paths run and the static RAM they cost
+void xip_stats_report();
+void xip_stats_reset();
+
+#endif // XIP_STATS_H
@@ -0,0 +1,33 @@
+#ifndef BACKLIGHT_H
+#define BACKLIGHT_H
+
+#include <cstdint>
+
+// PWM backlight on DISPLAY_BACKLIGHT_PIN. Levels are perceptual (0..255,
+// gamma 2 to duty). Fades run in the PWM wrap interrupt of the backlight
+// slice, one step per PWM period, so they stay smooth however long a redraw
+// keeps the main loop busy.
+
+#define BACKLIGHT_PWM_HZ 2000
+#define BACKLIGHT_PWM_WRAP 4095
+#define BACKLIGHT_MAX 255
+
+// Take the pin over from st7789_init (plain GPIO, on) at full brightness
+void backlight_init();
+
+// Brightness the panel returns to after dimming or a hidden redraw
+void backlight_set_brightness(uint8_t level, uint32_t fade_ms);
+uint8_t backlight_brightness();
+
+// Fade to `level` without changing the brightness setting
+void backlight_fade_to(uint8_t level, uint32_t duration_ms);
+// Fade back to the brightness setting
+void backlight_restore(uint32_t duration_ms);
+
+// Current level and whether a fade is still running
+uint8_t backlight_level();
+bool backlight_fading();
+// Dark and no fade running: a full redraw now is invisible
+bool backlight_dark();
+
+#endif // BACKLIGHT_H
@@ -0,0 +1,17 @@
+#ifndef BOOT_SPLASH_H
+#define BOOT_SPLASH_H
+
+#include "mrx.h"
+#include "face_geometry.h"
+
+// First image after reset: the neutral face in flat cells and the default
+// palette. The compiler builds its pixel lines into flash, and one draw list
+// sends them by DMA, each line repeated for its cell row.
+using SplashGeometry = FaceGeometry<MATRIX_ROWS, MATRIX_COLS>;
+extern const FaceLines<MATRIX_ROWS, SplashGeometry::WIDTH> NEUTRAL_SPLASH;
+
+// Queue the splash over the whole screen; wait for it before the backlight goes on
+void boot_splash_show();
+void boot_splash_wait();
+
+#endif // BOOT_SPLASH_H
@@ -15,17 +15,53 @@ extern "C" {
 #define DISPLAY_CS_PIN 9
 #define DISPLAY_RESET_PIN 12
 #define DISPLAY_BACKLIGHT_PIN 13
+// Tearing effect output of the panel, -1 if not wired (the TENSTAR module has none)
+#define DISPLAY_TE_PIN -1
+#define DISPLAY_SPI_BAUD (60 * 1000 * 1000)
+
+// Second panel for DISPLAY_DUAL_PANEL (ROBOT_DUAL_PANEL build option): its own
+// SPI bus, backlight shared with the first panel. The screen is split down the
+// middle: the left half goes to this panel, the right half to the first one,
+// each centered on its panel. CS follows DC for the PIO backend.
+#ifndef DISPLAY_DUAL_PANEL
+#define DISPLAY_DUAL_PANEL 0
+#endif
+#define DISPLAY2_SPI_PORT spi0
+#define DISPLAY2_SPI_SCK 2
+#define DISPLAY2_SPI_MOSI 3
+#define DISPLAY2_CS_PIN 5
+#define DISPLAY2_DC_PIN 4
+#define DISPLAY2_RESET_PIN 7
 
 // Display dimensions
 #define DISPLAY_WIDTH 240
 #define DISPLAY_HEIGHT 320
 
+// MADCTL written by st7789_init (MY | MX): frame memory rows run from the bottom
+// of the picture up. Hardware scroll and partial areas are given in memory rows.
+#define DISPLAY_MADCTL 0xC0
+#define DISPLAY_ROWS_REVERSED ((DISPLAY_MADCTL & 0x80) != 0)
+
+// Panel refresh after reset: FRCTRL2 0Fh (60 Hz), PORCTRL back/front porch 0Ch each
+#define DISPLAY_FRAME_RATE_HZ 60
+#define DISPLAY_PORCH_LINES 24
+
 // LCD configuration for TENSTAR ROBOT 2.4" TFT ST7789V
 extern const struct st7789_config lcd_config;
 extern const int lcd_width;
 extern const int lcd_height;
+#if DISPLAY_DUAL_PANEL
+extern const struct st7789_config lcd2_config;
+#endif
 
 // Initialize display
 void init_display();
 
+// The same in steps: begin resets the panels and returns at once, poll sends
+// the init commands whose wait is over (true once the panels take pixels),
+// finish waits for the panels, shows the boot splash and turns the backlight on
+void init_display_begin();
+bool init_display_poll();
+void init_display_finish();
+
 #endif // DISPLAY_CONFIG_H
\ No newline at end of file
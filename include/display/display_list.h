@@ -0,0 +1,34 @@
+#ifndef DISPLAY_LIST_H
+#define DISPLAY_LIST_H
+
+#include <cstdint>
+
+// Double-buffered draw lists for the face renderer. A frame's window, fill and
+// line writes are recorded into one of two fixed st7789 draw lists and sent
+// out by DMA in the background while the CPU goes on with animation and input.
+// Recording only waits when the buffer it is about to reuse is still going
+// out (the fence); a list that fills up mid-frame is submitted and recording
+// continues in the other buffer.
+
+// On by default; off writes through the driver immediately
+void display_list_set_enabled(bool on);
+bool display_list_enabled();
+
+// Record into the current buffer (fenced on first use after a submit)
+void display_list_window(int x0, int y0, int x1, int y1);
+void display_list_fill(uint16_t color, int lines);
+// One line of `width` pixels (the window width), shown `repeat` times
+void display_list_line(const uint16_t* pixels, int width, int repeat);
+// The same without a copy: `pixels` (e.g. in flash) must stay until the list is out
+void display_list_blit(const uint16_t* pixels, int repeat);
+
+// End of a frame: hand the recorded ops to the driver
+void display_list_submit();
+// Wait until everything submitted is on the panel
+void display_list_fence();
+
+// Lists, ops, pixels and fence waits as JSON: {"display_list": ...}
+void display_list_report();
+void display_list_reset_stats();
+
+#endif // DISPLAY_LIST_H
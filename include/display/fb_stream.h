@@ -0,0 +1,59 @@
+#ifndef FB_STREAM_H
+#define FB_STREAM_H
+
+#include <cstdint>
+
+// Framebuffer stream: arbitrary pictures (logos, QR codes, short videos) sent
+// by the host over USB and written to the panel as they arrive. After
+// {"cmd":"stream_start"} is acknowledged the serial link carries binary
+// packets instead of JSON lines until a STOP packet or FB_STREAM_TIMEOUT_MS
+// without data. Received lines go into the double-buffered draw lists
+// (display_list.h), so DMA sends one list while the next one fills from USB.
+//
+// Packet: FbStreamHeader, then `length` payload bytes. Little-endian.
+//
+//   RECT_RGB565  x, y, w, h: rectangle; payload w*h RGB565 pixels row by row
+//   RECT_RLE     x, y, w, h: rectangle; payload (count-1, palette index) byte
+//                pairs covering w*h pixels, runs may cross rows
+//   PALETTE      x: first index, w: entry count; payload w RGB565 colours
+//   FRAME        end of a frame: the lists go out, the frame is counted
+//   STOP         leave stream mode and print the stream report
+//
+// Unknown packet types are skipped by `length`; bytes that do not start with
+// the magic are dropped until the next header (counted as errors).
+
+enum FbStreamPacket : uint8_t {
+    FB_STREAM_RECT_RGB565 = 1,
+    FB_STREAM_RECT_RLE = 2,
+    FB_STREAM_PALETTE = 3,
+    FB_STREAM_FRAME = 4,
+    FB_STREAM_STOP = 5,
+};
+
+struct FbStreamHeader {
+    char magic[2];      // "FS"
+    uint8_t type;       // FbStreamPacket
+    uint8_t reserved;
+    uint16_t x;
+    uint16_t y;
+    uint16_t w;
+    uint16_t h;
+    uint32_t length;    // payload bytes
+};
+static_assert(sizeof(FbStreamHeader) == 16, "stream header is 16 bytes");
+
+// Without data for this long the stream ends as if STOP had arrived
+#define FB_STREAM_TIMEOUT_MS 2000
+
+// Switch the serial link to stream packets; stats restart
+void fb_stream_start();
+bool fb_stream_active();
+
+// Read and draw whatever USB has received; false once the stream has ended
+// (the caller redraws what the stream covered)
+bool fb_stream_poll();
+
+// Frames, bytes, fps and bytes per second of the last stream as JSON: {"stream": ...}
+void fb_stream_report();
+
+#endif // FB_STREAM_H
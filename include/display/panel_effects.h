@@ -0,0 +1,62 @@
+#ifndef PANEL_EFFECTS_H
+#define PANEL_EFFECTS_H
+
+#include <cstdint>
+#include <string_view>
+
+// Effects made of panel commands instead of pixels: hardware vertical scroll
+// (shake, bounce, slide-in), display inversion, 8-colour idle and partial
+// mode. A frame of an effect costs a few command bytes; only the slide-in
+// writes pixels, one row per step, which it would write anyway for a redraw.
+
+// Scroll offsets change at most this often (~60 Hz)
+#define PANEL_EFFECT_FRAME_US 16667
+// Shake and bounce move the whole screen; keep them within the border so
+// rows wrapping around from the other edge are background
+#define PANEL_EFFECT_MAX_OFFSET 40
+
+// Screen rows [first_row, first_row + rows) become the vertical scroll area.
+// The area is shared by all users of hardware scroll (effects, subtitles):
+// the generation changes whenever another area or mode takes over, and a
+// user seeing a new generation has to claim its area again.
+void panel_scroll_area(int first_row, int rows);
+// Show area row `top` at the top of the area; content moves up by `top`
+void panel_scroll_to(int top);
+uint32_t panel_scroll_generation();
+// Shake, bounce or slide-in own the scroll area right now
+bool panel_scroll_busy();
+
+// Whole-screen shake: damped vertical jitter of up to `amplitude` pixels
+void panel_shake(int amplitude, uint32_t duration_ms);
+// Whole screen jumps up by `height` pixels and bounces back down
+void panel_bounce(int height, uint32_t duration_ms);
+
+// Pixels of screen row `y` for the slide-in, DISPLAY_WIDTH of them
+typedef void (*PanelRowSource)(int y, uint16_t* out);
+// Slide new content of rows [first_row, first_row + rows) down over the old
+// one. Each step writes one row of the new content and scrolls by one pixel;
+// at the end the frame memory holds the new content at scroll offset 0.
+void panel_slide_in(PanelRowSource source, int first_row, int rows, uint32_t duration_ms);
+bool panel_slide_active();
+
+// Inverted colours for `flashes` blinks of `period_ms` each
+void panel_invert_flash(int flashes, uint32_t period_ms);
+
+// Sleep look: only rows [first_row, first_row + rows) are shown, in 8-colour
+// idle mode; waking returns to normal mode
+void panel_sleep(int first_row, int rows);
+void panel_wake();
+bool panel_sleeping();
+
+// Line refresh order (MADCTL ML): bottom-to-top when set
+void panel_refresh_bottom_up(bool bottom_up);
+
+// Shake, bounce or flash configured for an emotion; other emotions get none
+void panel_effects_start_for_emotion(std::string_view emotion);
+// Stop every effect and return to scroll offset 0, normal colours
+void panel_effects_stop();
+
+// Advance the running effects, call once per main loop iteration
+void panel_effects_update(uint32_t now_us);
+
+#endif // PANEL_EFFECTS_H
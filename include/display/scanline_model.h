@@ -0,0 +1,65 @@
+#ifndef SCANLINE_MODEL_H
+#define SCANLINE_MODEL_H
+
+#include <cstdint>
+
+// Model of the panel refresh: where the scanline is at a given time and
+// whether writing a band of rows during some interval splits it between two
+// refreshes (a tear). Plain C++ without SDK calls, so tools/tear_sim.cpp can
+// run the same scheduling on the host.
+//
+// A frame is `porch_lines` of blanking followed by `active_lines`; the TE
+// signal (TEON mode 0) rises at the start of the blanking. Window writes
+// always go from the top screen row down.
+
+struct ScanlineModel {
+    uint32_t frame_us = 16667;
+    uint16_t active_lines = 320;
+    uint16_t porch_lines = 24;
+    // Scan runs from the top screen row down, the same way window writes go
+    bool top_down = true;
+    // Time of a blanking start (TE rising edge)
+    uint32_t vsync_us = 0;
+    // SPI write cost: pixel clock and fixed cost of opening a window
+    uint32_t spi_hz = 60000000;
+    uint32_t window_us = 20;
+
+    uint32_t total_lines() const { return active_lines + porch_lines; }
+    // Start of line `line` counted from the blanking start, in microseconds
+    uint32_t line_start_us(int line) const { return (uint64_t)line * frame_us / total_lines(); }
+
+    // Estimated time to open a window and write `pixels` RGB565 pixels
+    uint32_t write_us(uint32_t pixels) const;
+
+    // Time since the last blanking start and the line being scanned at `t`
+    uint32_t beam_us(uint32_t t) const;
+    int beam_line(uint32_t t) const;
+
+    // Delay before writing screen rows [y0, y1] (taking `duration_us`) can
+    // start at `now` without a tear; 0 when impossible to avoid
+    uint32_t safe_delay(int y0, int y1, uint32_t duration_us, uint32_t now) const;
+
+    // Writing rows [y0, y1] from `start` to `end` tore the picture
+    bool tears(int y0, int y1, uint32_t start, uint32_t end) const;
+
+private:
+    // Start time of the band in the frame and the time the beam needs to cross it
+    void band_time(int y0, int y1, uint32_t& start, uint32_t& length) const;
+    // Beam `distance` microseconds past the band start is safe for a write of `duration`
+    bool safe_at(uint32_t distance, uint32_t band, uint32_t duration) const;
+};
+
+// Band to present: screen rows and pixel count
+struct ScanRect {
+    int16_t y0;
+    int16_t y1;
+    uint32_t pixels;
+};
+
+// Order `count` rects so each starts as soon as the beam allows, greedily from
+// `now`; writes `count` indices into `order`. Returns the estimated total wait.
+// More than 32 rects keep their order.
+uint32_t scanline_order(const ScanlineModel& model, const ScanRect* rects, int count,
+                        uint32_t now, uint8_t* order);
+
+#endif // SCANLINE_MODEL_H
@@ -0,0 +1,44 @@
+#ifndef TEAR_SYNC_H
+#define TEAR_SYNC_H
+
+#include <cstdint>
+#include "scanline_model.h"
+
+// Tear-free presentation: incremental face updates are ordered and delayed so
+// the panel's scanline never splits a band being written. The scanline comes
+// from the TE signal (TEON, DISPLAY_TE_PIN) or, without a TE pin, from the
+// configured frame rate with a phase that has to be tuned by hand.
+
+// Bands one frame may queue; more are written as they come
+#define TEAR_SYNC_MAX_RECTS 32
+
+enum TearSyncMode : uint8_t {
+    TEAR_SYNC_OFF,   // write immediately, only count tears (if the phase is known)
+    TEAR_SYNC_TE,    // scanline from TE edges
+    TEAR_SYNC_SCAN,  // scanline from the frame rate and a calibrated phase
+};
+
+// TEON and the TE interrupt when DISPLAY_TE_PIN is wired; the panel refresh
+// order is set to follow window writes (top to bottom)
+void tear_sync_init();
+
+// TE is only available with DISPLAY_TE_PIN; default: TE if wired, else off
+void tear_sync_set_mode(TearSyncMode mode);
+TearSyncMode tear_sync_mode();
+
+// Scan mode: move the assumed blanking start by `shift_us` and set the frame
+// length (0 keeps it), tuned by eye until blinks stop tearing
+void tear_sync_calibrate(int32_t shift_us, uint32_t frame_us);
+
+// Write order of `count` bands for the current scanline
+void tear_sync_order(const ScanRect* rects, int count, uint8_t* order);
+// Wait until `rect` can be written without a tear (no-op when off)
+void tear_sync_wait(const ScanRect& rect);
+// After writing `rect` from `start_us` to `end_us`: tear statistic
+void tear_sync_written(const ScanRect& rect, uint32_t start_us, uint32_t end_us);
+
+// Writes, waits and predicted tears as JSON: {"tear_stats": ...}
+void tear_sync_report();
+void tear_sync_reset_stats();
+
+#endif // TEAR_SYNC_H
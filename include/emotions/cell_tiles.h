@@ -0,0 +1,84 @@
+#ifndef CELL_TILES_H
+#define CELL_TILES_H
+
+#include <cstdint>
+
+// Rounded cell sprites: a lit cell rounds the corners where both neighbours
+// next to the corner are background. Tiles store anti-aliased coverage of the
+// cell colour over the background (0..CELL_COVERAGE_FULL), colours come from a
+// per-palette-entry ramp, so palette changes never regenerate tiles.
+
+// Rounded corners of a cell, the variant index of a tile
+enum CellCorner : uint8_t {
+    CELL_CORNER_TL = 1,
+    CELL_CORNER_TR = 2,
+    CELL_CORNER_BR = 4,
+    CELL_CORNER_BL = 8
+};
+
+#define CELL_TILE_VARIANTS 16
+// 4x4 samples per pixel
+#define CELL_COVERAGE_FULL 16
+#define CELL_COVERAGE_LEVELS (CELL_COVERAGE_FULL + 1)
+
+enum CellStyle {
+    CELL_STYLE_FLAT,
+    CELL_STYLE_ROUNDED
+};
+
+template <int CellSize>
+struct CellTiles {
+    // Corner radius is 3/8 of the cell, in 1/8 pixel units
+    static constexpr int SIZE_X8 = CellSize * 8;
+    static constexpr int RADIUS_X8 = CellSize * 3;
+
+    uint8_t coverage[CELL_TILE_VARIANTS][CellSize][CellSize];
+
+    static bool covered(int corners, int u, int v) {
+        bool left = u < RADIUS_X8;
+        bool right = u > SIZE_X8 - RADIUS_X8;
+        bool top = v < RADIUS_X8;
+        bool bottom = v > SIZE_X8 - RADIUS_X8;
+
+        int corner = top && left ? CELL_CORNER_TL
+                   : top && right ? CELL_CORNER_TR
+                   : bottom && right ? CELL_CORNER_BR
+                   : bottom && left ? CELL_CORNER_BL : 0;
+        if (!(corners & corner)) {
+            return true;
+        }
+        int du = u - (left ? RADIUS_X8 : SIZE_X8 - RADIUS_X8);
+        int dv = v - (top ? RADIUS_X8 : SIZE_X8 - RADIUS_X8);
+        return du * du + dv * dv <= RADIUS_X8 * RADIUS_X8;
+    }
+
+    void generate() {
+        for (int corners = 0; corners < CELL_TILE_VARIANTS; corners++) {
+            for (int y = 0; y < CellSize; y++) {
+                for (int x = 0; x < CellSize; x++) {
+                    uint8_t samples = 0;
+                    for (int sy = 0; sy < 4; sy++) {
+                        for (int sx = 0; sx < 4; sx++) {
+                            samples += covered(corners, x * 8 + sx * 2 + 1, y * 8 + sy * 2 + 1);
+                        }
+                    }
+                    coverage[corners][y][x] = samples;
+                }
+            }
+        }
+    }
+};
+
+// Tiles for one cell size, generated into RAM on first use (400 B per variant at 20 px)
+template <int CellSize>
+const CellTiles<CellSize>& cell_tiles() {
+    static CellTiles<CellSize> tiles;
+    static bool generated = false;
+    if (!generated) {
+        tiles.generate();
+        generated = true;
+    }
+    return tiles;
+}
+
+#endif // CELL_TILES_H
@@ -0,0 +1,34 @@
+#ifndef COLOR_ANIM_H
+#define COLOR_ANIM_H
+
+#include <cstdint>
+#include <string_view>
+
+// Colour animations change palette entries over time without touching geometry:
+// only the cells using the animated index (or the background) are repainted.
+
+// Repaint at most this often (~30 Hz)
+#define COLOR_ANIM_INTERVAL_MS 33
+// Pixels per 60 FPS frame that colour repaints may use, the rest of the SPI
+// bandwidth stays with shape animations
+#define COLOR_ANIM_PIXEL_BUDGET 4800
+
+// Fade a palette entry from its current colour to `target`
+void color_anim_fade(uint8_t index, uint16_t target, uint32_t duration_ms);
+
+// Pulse a palette entry between two colours, `period_ms` per full cycle
+void color_anim_pulse(uint8_t index, uint16_t from, uint16_t to, uint32_t period_ms);
+
+void color_anim_stop(uint8_t index);
+void color_anim_stop_all();
+
+// Start the colour effects configured for an emotion (after its palette is set)
+void color_anim_start_for_emotion(std::string_view emotion);
+
+// Advance colour animations, call once per main loop iteration
+void color_anim_update();
+
+// Linear interpolation between two RGB565 colours, t in 0..256
+uint16_t lerp_color565(uint16_t from, uint16_t to, uint32_t t);
+
+#endif // COLOR_ANIM_H
@@ -0,0 +1,40 @@
+#ifndef COMPOSITOR_H
+#define COMPOSITOR_H
+
+#include "mrx.h"
+#include <cstdint>
+
+// Layered face: an eye layer, a mouth layer and effect overlays are composited
+// into the 12x12 cell grid before the renderer diffs it against the screen.
+// Each layer owns a region; changing a layer marks only its region dirty, so
+// mouth movement recomposites and redraws only the mouth rows.
+
+struct FaceRegion {
+    uint8_t first_row;
+    uint8_t last_row;
+    uint8_t first_col;
+    uint8_t last_col;
+};
+
+#define COMPOSITOR_MAX_OVERLAYS 4
+
+// Layer sources are full faces. The eye layer takes the rows of its source's
+// eye block (find_face_eyes_last_row), the mouth layer the rows below its own
+// source's eye block; where both reach, the eyes win. Rows in neither stay
+// background, so a mouth row of the eye face (surprise, happy: row 6) is dropped
+// and eyes that reach lower (scary: row 6) are kept.
+void compositor_set_eyes(Matrix12x12& source);
+void compositor_set_mouth(Matrix12x12& source);
+
+// Overlay slot drawn over both layers; nullptr clears the slot
+void compositor_set_overlay(int slot, const CellSprite* sprite, int row, int col);
+void compositor_clear_overlays();
+
+// Composite dirty regions and hand the grid to the renderer. Returns false if
+// nothing was dirty or the renderer skipped the frame (retried on the next call).
+bool compositor_present(bool force_redraw = false);
+
+// Something else drew a full face: recomposite everything on the next present
+void compositor_invalidate();
+
+#endif // COMPOSITOR_H
@@ -3,27 +3,38 @@
 
 #include "states.h"
 #include "mrx.h"
-#include <string>
+#include "palette.h"
+#include "face_renderer.h"
+#include "hot_path.h"
+#include "face_assets.h"
+#include <string_view>
 
-// Display is now handled directly via C driver in emotions.cpp
-// No global display pointer needed
-
-// Display and matrix constants
-#define PIXEL_SIZE 20
-#define MATRIX_WIDTH (12 * PIXEL_SIZE)
-#define MATRIX_HEIGHT (12 * PIXEL_SIZE)
-#define DISPLAY_WIDTH 240
-#define DISPLAY_HEIGHT 320
-#define X_OFFSET ((DISPLAY_WIDTH - MATRIX_WIDTH) / 2)
-#define Y_OFFSET ((DISPLAY_HEIGHT - MATRIX_HEIGHT) / 2)
+// Cell size and offsets come from FaceGeometry (face_geometry.h) and are
+// computed at compile time for the configured panel
 
 // Vowels for syllable counting
 #define VOWELS "аеёиоуыэюяaeiouy"
 
 // Function declarations for emotion handling
 void reset_matrix();
-void draw_matrix(const uint8_t matrix[MATRIX_ROWS][MATRIX_COLS], int pixel_size = PIXEL_SIZE, bool force_redraw = false);
-int count_syllables(const std::string& text);
+int count_syllables(std::string_view text);
+
+// Draw a face of any instantiated geometry, only changed areas are written
+template <int Rows, int Cols>
+void HOT_FUNC(draw_matrix)(const uint8_t (&matrix)[Rows][Cols], bool force_redraw = false) {
+    face_renderer<Rows, Cols>().draw(matrix, force_redraw);
+}
+
+// Palette control: a changed entry repaints only the cells that use it
+void set_palette(const Palette& palette);
+void set_palette_entry(uint8_t index, uint16_t color, bool repaint = true);
+const Palette& get_active_palette();
+
+// Budgeted repaint for colour animations: paints rows of cells using `index`
+// (plus the border for the background) starting at `first_row` until the
+// budget is spent. Returns the next row, or PALETTE_REPAINT_DONE.
+#define PALETTE_REPAINT_DONE -1
+int repaint_palette_rows(uint8_t index, int first_row, uint32_t& pixel_budget);
 
 // Animation functions
 void neutral(double speed, NeutralState& state);
@@ -34,21 +45,35 @@ void scary_pixel(double speed, AnimState& state, uint32_t duration);
 void happy_pixel(double speed, AnimState& state, uint32_t duration);
 void sad_pixel(double speed, AnimState& state, uint32_t duration);
 void surprise_pixel(double speed, AnimState& state, uint32_t duration);
+// Uploaded face, animation or clip (face_assets.h), frames looping from flash
+void asset_pixel(const FaceAssetEntry* asset, AnimState& state);
+
+// Talking is composited from layers (compositor.h): the eye set and the mouth
+// set are chosen independently, so any talking emotion can use any eye set
+struct TalkingEyes {
+    Matrix12x12* eyes;      // eye region source
+    bool blush;             // cheek overlays under the eyes
+};
+
+struct TalkingMouth {
+    Matrix12x12* open;      // mouth region sources
+    Matrix12x12* closed;
+    Matrix12x12* rest;      // shown when not speaking
+};
 
 // Talking functions
 void talking_pixel(uint32_t duration, double speed, TalkingState& state,
-                  const std::string& text, double mouth_speed, const std::string& emotion);
+                  std::string_view text, double mouth_speed, std::string_view emotion);
 
-// Animation logic functions
+// Animation logic functions (instantiated for every geometry in FACE_GEOMETRY_LIST)
+template <int Rows, int Cols>
 void anime_logic(AnimState& state, double speed, uint32_t duration,
-                const uint8_t* matrix_start, const uint8_t* matrix_anim_a,
-                const uint8_t* matrix_anim_b, const uint8_t* matrix_anim_c,
-                const uint8_t* matrix_end);
+                FaceMatrix<Rows, Cols>* matrix_start, FaceMatrix<Rows, Cols>* matrix_anim_a,
+                FaceMatrix<Rows, Cols>* matrix_anim_b, FaceMatrix<Rows, Cols>* matrix_anim_c,
+                FaceMatrix<Rows, Cols>* matrix_end);
 
-void talking_logic(TalkingState& state, const std::string& text, uint32_t duration,
+void talking_logic(TalkingState& state, std::string_view text, uint32_t duration,
                   double speed, double mouth_speed,
-                  const uint8_t open_matrix[MATRIX_ROWS][MATRIX_COLS],
-                  const uint8_t closed_matrix[MATRIX_ROWS][MATRIX_COLS],
-                  const uint8_t neutral_matrix[MATRIX_ROWS][MATRIX_COLS]);
+                  const TalkingEyes& eyes, const TalkingMouth& mouth);
 
 #endif // EMOTIONS_H
\ No newline at end of file
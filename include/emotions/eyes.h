@@ -0,0 +1,55 @@
+#ifndef EYES_H
+#define EYES_H
+
+#include <cstdint>
+
+// Eye layer: the contents of two fixed eye boxes are rasterised per pixel
+// line. The face renderer leaves the box cells alone while the layer is
+// enabled, and an update writes only the lines whose spans changed, so gaze
+// can be streamed without redrawing the face.
+
+// Eye boxes in cells of the 12x12 face: rows 1..6, columns 1..4 and 7..10
+#define EYE_BOX_FIRST_ROW 1
+#define EYE_BOX_LAST_ROW 6
+#define EYE_BOX_LEFT_FIRST_COL 1
+#define EYE_BOX_RIGHT_FIRST_COL 7
+#define EYE_BOX_COLS 4
+// Face cells source stops above row 6, where some mouths start
+#define EYE_CELLS_LAST_ROW 5
+
+enum EyeSource {
+    EYE_SOURCE_PROCEDURAL,  // parametric eye shape
+    EYE_SOURCE_FACE_CELLS   // eye cells of the current face, shifted by gaze
+};
+
+struct EyeParams {
+    int8_t gaze_x = 0;       // -100..100, доля хода зрачка по горизонтали
+    int8_t gaze_y = 0;       // -100..100, вниз - положительное
+    uint8_t openness = 100;  // 0..100, 0 - веки сомкнуты
+    uint8_t size = 100;      // 50..100, процент от размера глаза битмапов
+};
+
+// The layer takes over the eye boxes; disabling hands the cells back to
+// the face renderer (the next face draw is a full redraw)
+void eyes_enable(EyeSource source);
+void eyes_disable();
+bool eyes_enabled();
+
+// Target parameters from the host (clamped to the ranges above)
+void eyes_set_params(const EyeParams& params);
+const EyeParams& eyes_get_params();
+
+// Gaze only, from streamed targets; does not count as a host gaze command
+void eyes_set_gaze(int8_t gaze_x, int8_t gaze_y);
+
+// Time since the host last set parameters; the neutral idle glance waits for it
+uint32_t eyes_params_age_ms();
+
+// Blink override from the neutral animation, 100 = follow the host openness
+void eyes_set_blink(uint8_t openness);
+
+// Rasterise and write the changed lines, call once per frame.
+// Returns true if anything was written to the panel.
+bool eyes_update();
+
+#endif // EYES_H
@@ -0,0 +1,84 @@
+#ifndef FACE_ASSETS_H
+#define FACE_ASSETS_H
+
+#include "mrx.h"
+#include <cstdint>
+#include <string_view>
+
+// Faces, animations and clips uploaded over serial into a reserved region at the
+// end of flash. The first sector is the index, records follow it and are
+// only appended (a re-uploaded name shadows the older record) until
+// asset_erase. Faces are stored unpacked with their span table, so the
+// renderer reads them straight from XIP the same way as built-in faces.
+
+// Region size, a multiple of the 4 KB flash sector
+#ifndef FACE_ASSETS_SIZE
+#define FACE_ASSETS_SIZE (64 * 1024)
+#endif
+
+// Names up to 15 characters
+const int FACE_ASSET_NAME_MAX = 15;
+// Frames of one animation
+const int FACE_ASSET_MAX_FRAMES = 64;
+// Clip bytes per asset_clip command
+const int FACE_ASSET_CLIP_CHUNK = 512;
+
+enum FaceAssetType : uint8_t {
+    FACE_ASSET_FACE = 1,
+    FACE_ASSET_ANIMATION = 2,
+    FACE_ASSET_CLIP = 3,    // face_clip.h stream, decoded while it plays
+};
+
+// Index entry; record bytes are at `offset` from the start of the region
+struct FaceAssetEntry {
+    char name[FACE_ASSET_NAME_MAX + 1];
+    uint8_t type;
+    uint8_t frame_count;    // animations
+    uint16_t reserved;
+    uint32_t offset;
+    uint32_t size;
+};
+
+// Face record: cells for draw_matrix and spans for full redraws
+struct FaceAssetFace {
+    uint8_t cells[MATRIX_ROWS][MATRIX_COLS];
+    FaceSpans spans;
+};
+
+// Animation frame: an uploaded face (index entry number) and how long it shows
+struct FaceAssetFrame {
+    uint8_t face;
+    uint8_t reserved;
+    uint16_t duration_ms;
+};
+
+// Newest entry with this name, nullptr if none; the entry and its name stay
+// valid until asset_erase
+const FaceAssetEntry* face_asset_find(std::string_view name);
+
+// Records of an entry, read in place from XIP
+const FaceAssetFace* face_asset_face(const FaceAssetEntry* entry);
+const FaceAssetFace* face_asset_frame_face(const FaceAssetFrame& frame);
+const FaceAssetFrame* face_asset_frames(const FaceAssetEntry* entry);
+const uint8_t* face_asset_clip(const FaceAssetEntry* entry);
+
+// Span table of an uploaded face matrix, nullptr for any other matrix
+const FaceSpans* face_asset_spans(const uint8_t (&matrix)[MATRIX_ROWS][MATRIX_COLS]);
+
+// Uploads; false with an [ASSETS] message on bad input or a full region.
+// `packed_hex`: PackedFace bytes in hex (FACE_BITS_PER_CELL bits per cell, row by row).
+// `frames`: "face:ms,face:ms,..." naming uploaded faces.
+bool face_asset_add_face(std::string_view name, std::string_view packed_hex);
+bool face_asset_add_animation(std::string_view name, std::string_view frames);
+// Clips arrive in chunks of up to FACE_ASSET_CLIP_CHUNK bytes: `offset` 0 reserves
+// `size` bytes, later chunks must continue where the previous one ended, and
+// the entry appears once the last byte is written and the clip checks out.
+// Other uploads are refused until then; a new offset 0 abandons the old clip.
+bool face_asset_add_clip_chunk(std::string_view name, uint32_t offset, uint32_t size, std::string_view data_hex);
+// Erase the whole region (index and records)
+void face_asset_erase();
+
+// Entries and free space as JSON: {"assets": [...], "used": ..., "free": ...}
+void face_asset_report();
+
+#endif // FACE_ASSETS_H
@@ -0,0 +1,70 @@
+#ifndef FACE_CLIP_H
+#define FACE_CLIP_H
+
+#include "mrx.h"
+#include <cstddef>
+#include <cstdint>
+
+// Compressed face clip: a keyframe of packed cells, then one record per frame
+// with its duration and an XOR delta against the previous frame, run-length
+// coded over the packed bytes. Little-endian layout:
+//
+//   FaceClipHeader
+//   keyframe       PackedFace bytes (frame 0)
+//   frame records  uint16 duration_ms, then for frames 1.. the delta tokens:
+//                  0x00..0x7f  skip n+1 unchanged bytes
+//                  0x80..0xff  n-0x7f bytes follow, XORed into the frame
+//                  until the tokens cover every packed byte
+//
+// Decoding touches only the changed bytes, so a clip plays straight from
+// flash with one packed frame and its cells in RAM.
+
+struct FaceClipHeader {
+    char magic[4];          // "FCLP"
+    uint8_t rows;
+    uint8_t cols;
+    uint8_t bits_per_cell;  // FACE_BITS_PER_CELL of the encoder
+    uint8_t reserved;
+    uint16_t frame_count;
+    uint16_t reserved2;
+    uint32_t size;          // whole clip in bytes
+};
+static_assert(sizeof(FaceClipHeader) == 16, "clip header is 16 bytes");
+
+const int FACE_CLIP_PACKED_BYTES = sizeof(PackedFace::data);
+
+// Decoder state; `cells` is what draw_matrix gets
+struct FaceClipPlayer {
+    const uint8_t* clip = nullptr;
+    const uint8_t* end = nullptr;
+    const uint8_t* next = nullptr;  // record of the following frame
+    uint16_t frame_count = 0;
+    uint16_t frame = 0;
+    uint16_t duration_ms = 0;       // of the current frame
+    PackedFace packed{};
+    uint8_t cells[MATRIX_ROWS][MATRIX_COLS] = {};
+};
+
+// Check the header against this build's face size; false with a [CLIP] message
+bool face_clip_valid(const uint8_t* clip, size_t size);
+
+// Start at the keyframe; false if the clip is not valid
+bool face_clip_open(FaceClipPlayer& player, const uint8_t* clip, size_t size);
+
+// Decode the next frame into `cells`, wrapping to the keyframe after the last.
+// Returns false if the clip data ended early (the player rewinds).
+bool face_clip_next(FaceClipPlayer& player);
+
+// Encoder, shared with the host tool. face_clip_begin writes the header and
+// the keyframe, face_clip_add_frame appends one frame record (the first call
+// must pass the keyframe), face_clip_finish patches the header. All return
+// the bytes written so far, or 0 when `capacity` is too small.
+size_t face_clip_begin(const PackedFace& keyframe, uint8_t* out, size_t capacity);
+size_t face_clip_add_frame(const PackedFace& previous, const PackedFace& frame, uint16_t duration_ms,
+                           uint8_t* out, size_t used, size_t capacity);
+size_t face_clip_finish(uint8_t* out, size_t used);
+
+// Encode built-in faces into a clip and time the decoder: {"bench": "clip", ...}
+void face_clip_benchmark();
+
+#endif // FACE_CLIP_H
@@ -0,0 +1,28 @@
+#ifndef FACE_GEOMETRY_H
+#define FACE_GEOMETRY_H
+
+#include "display_config.h"
+
+// Cell size and placement of a Rows x Cols face on the configured panel,
+// all computed at compile time
+template <int Rows, int Cols>
+struct FaceGeometry {
+    static constexpr int ROWS = Rows;
+    static constexpr int COLS = Cols;
+    static constexpr int CELL_SIZE = (DISPLAY_WIDTH / Cols) < (DISPLAY_HEIGHT / Rows)
+                                         ? (DISPLAY_WIDTH / Cols) : (DISPLAY_HEIGHT / Rows);
+    static constexpr int WIDTH = Cols * CELL_SIZE;
+    static constexpr int HEIGHT = Rows * CELL_SIZE;
+    static constexpr int X_OFFSET = (DISPLAY_WIDTH - WIDTH) / 2;
+    static constexpr int Y_OFFSET = (DISPLAY_HEIGHT - HEIGHT) / 2;
+
+    static_assert(CELL_SIZE > 0, "Face does not fit on the panel");
+};
+
+// Geometries the renderer and animation logic are instantiated for
+#define FACE_GEOMETRY_LIST(X) \
+    X(12, 12)                 \
+    X(24, 24)                 \
+    X(48, 48)
+
+#endif // FACE_GEOMETRY_H
@@ -0,0 +1,106 @@
+#ifndef FACE_RENDERER_H
+#define FACE_RENDERER_H
+
+#include "mrx.h"
+#include "palette.h"
+#include "face_geometry.h"
+#include "cell_tiles.h"
+#include <cstdint>
+
+// Flat rectangle fill through one address window
+void st7789_fill_rect_optimized(int x, int y, int width, int height, uint16_t color);
+
+// Diffing renderer for one face geometry. Remembers what is on screen as packed
+// palette indices and writes only changed areas, so the cost of an update
+// follows the changed pixel area rather than the number of cells.
+template <int Rows, int Cols>
+class FaceRenderer {
+public:
+    using Geometry = FaceGeometry<Rows, Cols>;
+
+    // Rate-limited to the animation frame rate unless force_redraw is set.
+    // Returns false if the frame was skipped by the rate limit or because a
+    // panel slide-in still owns the face rows.
+    bool draw(const uint8_t (&matrix)[Rows][Cols], bool force_redraw);
+
+    // Write the frame immediately: full redraw if forced or nothing is on screen yet
+    void present(const uint8_t (&matrix)[Rows][Cols], bool force_redraw);
+
+    // Next draw becomes a full redraw
+    void invalidate() { initialized_ = false; }
+
+    // Redraw what is on screen, e.g. after the cell style changed
+    void refresh();
+
+    // The next full redraw only records the frame and hands its pixel rows to
+    // `writer` (a panel slide-in) instead of writing them itself. Ignored while
+    // cells are masked or the border has not been cleared yet.
+    using FullDrawWriter = void (*)(int first_row, int rows);
+    void defer_full_draw(FullDrawWriter writer) { deferred_writer_ = writer; }
+
+    // Cells owned by another layer (procedural eyes): the renderer never writes them
+    void mask_cells(int first_row, int last_row, int first_col, int last_col);
+    void clear_mask();
+    bool is_masked(int row, int col) const { return (mask_[row] >> col) & 1; }
+
+    bool is_initialized() const { return initialized_; }
+    const PackedCells<Rows, Cols>& screen() const { return screen_; }
+
+    // Changes whenever the renderer rewrites pixels: layers drawn over the face
+    // (particles) compare it to know their pixels may have been overwritten
+    uint32_t epoch() const { return epoch_; }
+
+    // Display pixels [x0, x1) of line y as the renderer last drew them: face
+    // cells in the current style and palette, background outside the face
+    void compose_screen_line(int x0, int x1, int y, uint16_t* out) const;
+
+    // Palette support: repaint or measure the cells of one row using `index`
+    uint32_t repaint_palette_row(uint8_t index, int row, uint16_t color);
+    uint32_t count_palette_row_pixels(uint8_t index, int row) const;
+    void clear_border(uint16_t color);
+    // The part of the border in display lines [first_line, first_line + lines)
+    // and its pixel count, for repaints split into budget-sized strips
+    void clear_border_lines(int first_line, int lines, uint16_t color);
+    uint32_t border_pixels(int first_line, int lines) const;
+
+private:
+    void draw_full(const uint8_t (&matrix)[Rows][Cols]);
+    void draw_changes(const uint8_t (&matrix)[Rows][Cols]);
+    // `cells` is a matrix or the packed screen copy
+    template <typename Cells>
+    void write_cells(const Cells& cells, int first_row, int last_row, int first_col, int last_col);
+    template <typename Cells>
+    void write_unmasked(const Cells& cells);
+
+    static_assert(Cols <= 64, "Cell mask rows are 64-bit");
+
+    PackedCells<Rows, Cols> screen_{};
+    uint64_t mask_[Rows] = {};
+    bool has_mask_ = false;
+    bool initialized_ = false;
+    bool border_cleared_ = false;
+    uint32_t last_draw_time_ = 0;
+    uint32_t epoch_ = 0;
+    FullDrawWriter deferred_writer_ = nullptr;
+};
+
+// One renderer instance per geometry in FACE_GEOMETRY_LIST
+template <int Rows, int Cols>
+FaceRenderer<Rows, Cols>& face_renderer();
+
+// Renderer of the built-in 12x12 faces
+inline FaceRenderer<MATRIX_ROWS, MATRIX_COLS>& main_face_renderer() {
+    return face_renderer<MATRIX_ROWS, MATRIX_COLS>();
+}
+
+// Flat squares or rounded anti-aliased sprite cells; switching redraws the face
+void set_cell_style(CellStyle style);
+CellStyle get_cell_style();
+
+// Generate the cell tiles of every geometry up front instead of on first draw
+void prepare_cell_tiles();
+
+// Full and incremental frame times for every geometry, printed over serial
+void face_geometry_benchmark();
+
+#endif // FACE_RENDERER_H
@@ -0,0 +1,22 @@
+#ifndef FRAME_STATS_H
+#define FRAME_STATS_H
+
+#include <cstdint>
+#include <string_view>
+
+// Lateness above one 60 FPS frame counts as a deadline miss
+#define FRAME_DEADLINE_US (1000000 / 60)
+
+// Select the emotion that subsequent frames are accounted to
+void frame_stats_set_emotion(std::string_view emotion);
+
+// Animation code marks when the next frame is due; draw_matrix() completes
+// the measurement once that frame has actually been written to the panel
+void frame_stats_schedule(uint32_t intended_us);
+void frame_stats_presented(uint32_t presented_us);
+
+// Print per-emotion frame counts, misses and p50/p99/max lateness over serial
+void frame_stats_report();
+void frame_stats_reset();
+
+#endif // FRAME_STATS_H
@@ -0,0 +1,36 @@
+#ifndef GAZE_STREAM_H
+#define GAZE_STREAM_H
+
+#include <cstdint>
+
+// Continuous look-at channel, separate from JSON emotion commands. The host
+// sends plain lines at up to 60 Hz:
+//
+//     G <x> <y> [seq]\n        x, y in -100..100 (right / down positive)
+//
+// Targets are smoothed on-device with a critically damped spring and applied
+// to the eye layer of whatever emotion is active. Lines are handled as soon
+// as they arrive, bypassing the emotion switch gate and debug output.
+
+// Spring stiffness: critically damped, settles to ~2% in about 6/omega seconds
+#define GAZE_OMEGA 24
+// Without new targets for this long the gaze returns to centre and the stream ends
+#define GAZE_STREAM_TIMEOUT_MS 2000
+
+// Parse one "G ..." line (without the newline), received at rx_us
+void gaze_stream_line(const char* line, uint32_t rx_us);
+
+// Advance the smoothing and push the gaze to the eye layer, once per loop iteration
+void gaze_stream_update(uint32_t now_us);
+
+// True while targets are arriving or the eyes are still returning to centre
+bool gaze_stream_active();
+
+// The eye layer wrote a frame: closes latency measurements of pending targets
+void gaze_stream_presented(uint32_t presented_us);
+
+// Print target count, superseded targets and command-to-photon latency p50/p99/max
+void gaze_stream_report();
+void gaze_stream_reset_stats();
+
+#endif // GAZE_STREAM_H
@@ -3,12 +3,181 @@
 
 #include <cstdint>
 
-// Matrix dimensions
+// Matrix dimensions of the built-in faces
 const int MATRIX_ROWS = 12;
 const int MATRIX_COLS = 12;
 
-// Matrix type definition
-using Matrix12x12 = const uint8_t[MATRIX_ROWS][MATRIX_COLS];
+// Face matrix of any size, each cell holds a palette index (0 = background)
+template <int Rows, int Cols>
+using FaceMatrix = const uint8_t[Rows][Cols];
+
+using Matrix12x12 = FaceMatrix<MATRIX_ROWS, MATRIX_COLS>;
+
+// Packed storage: 2 bits per cell (4 colours) or 4 bits per cell (16 colours)
+#ifndef FACE_BITS_PER_CELL
+#define FACE_BITS_PER_CELL 4
+#endif
+static_assert(FACE_BITS_PER_CELL == 2 || FACE_BITS_PER_CELL == 4,
+              "FACE_BITS_PER_CELL must be 2 or 4");
+const int FACE_PALETTE_SIZE = 1 << FACE_BITS_PER_CELL;
+
+template <int Rows, int Cols>
+struct PackedCells {
+    uint8_t data[(Rows * Cols * FACE_BITS_PER_CELL + 7) / 8];
+
+    constexpr uint8_t get(int row, int col) const {
+        int bit = (row * Cols + col) * FACE_BITS_PER_CELL;
+        return (data[bit / 8] >> (bit % 8)) & (FACE_PALETTE_SIZE - 1);
+    }
+
+    constexpr void set(int row, int col, uint8_t value) {
+        int bit = (row * Cols + col) * FACE_BITS_PER_CELL;
+        uint8_t mask = (FACE_PALETTE_SIZE - 1) << (bit % 8);
+        data[bit / 8] = (data[bit / 8] & ~mask) | ((value << (bit % 8)) & mask);
+    }
+};
+
+using PackedFace = PackedCells<MATRIX_ROWS, MATRIX_COLS>;
+
+template <int Rows, int Cols>
+constexpr PackedCells<Rows, Cols> pack_face(const uint8_t (&matrix)[Rows][Cols]) {
+    PackedCells<Rows, Cols> result{};
+    for (int row = 0; row < Rows; row++) {
+        for (int col = 0; col < Cols; col++) {
+            result.set(row, col, matrix[row][col]);
+        }
+    }
+    return result;
+}
+
+template <int Rows, int Cols>
+constexpr bool face_fits_palette(const uint8_t (&matrix)[Rows][Cols]) {
+    for (int row = 0; row < Rows; row++) {
+        for (int col = 0; col < Cols; col++) {
+            if (matrix[row][col] >= FACE_PALETTE_SIZE) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Face cells wrapped in a struct so constexpr functions can return them
+template <int Rows, int Cols>
+struct FaceCells {
+    uint8_t cells[Rows][Cols];
+};
+
+// Nearest-neighbour upscale of a face, e.g. 12x12 assets for a 24x24 or 48x48 panel layout
+template <int Factor, int Rows, int Cols>
+constexpr FaceCells<Rows * Factor, Cols * Factor> upscale_face(const uint8_t (&matrix)[Rows][Cols]) {
+    FaceCells<Rows * Factor, Cols * Factor> result{};
+    for (int row = 0; row < Rows * Factor; row++) {
+        for (int col = 0; col < Cols * Factor; col++) {
+            result.cells[row][col] = matrix[row / Factor][col / Factor];
+        }
+    }
+    return result;
+}
+
+// Run of equal cells within one matrix row
+struct FaceSpan {
+    uint8_t value;
+    uint8_t length;
+};
+
+// Per-row run-length encoding of a face, covering lit and background cells
+template <int Cols>
+struct FaceRowSpans {
+    uint8_t count;
+    FaceSpan spans[Cols];
+};
+
+template <int Rows, int Cols>
+struct FaceSpanTable {
+    FaceRowSpans<Cols> rows[Rows];
+};
+
+using FaceSpans = FaceSpanTable<MATRIX_ROWS, MATRIX_COLS>;
+
+// Usable both at compile time (tables in mrx.cpp) and at runtime
+template <int Rows, int Cols>
+constexpr FaceSpanTable<Rows, Cols> make_face_spans(const uint8_t (&matrix)[Rows][Cols]) {
+    FaceSpanTable<Rows, Cols> result{};
+    for (int row = 0; row < Rows; row++) {
+        FaceRowSpans<Cols>& spans = result.rows[row];
+        for (int col = 0; col < Cols; col++) {
+            if (spans.count > 0 && spans.spans[spans.count - 1].value == matrix[row][col]) {
+                spans.spans[spans.count - 1].length++;
+            } else {
+                spans.spans[spans.count] = {matrix[row][col], 1};
+                spans.count++;
+            }
+        }
+    }
+    return result;
+}
+
+// Last row of a face's eye block: the first run of rows with lit cells, so brows
+// and anything joined to the eyes (the scary faces reach row 6) stay with them.
+// A face without lit cells splits at mid-height.
+template <int Rows, int Cols>
+constexpr int face_eyes_last_row(const uint8_t (&matrix)[Rows][Cols]) {
+    int last = -1;
+    for (int row = 0; row < Rows; row++) {
+        bool lit = false;
+        for (int col = 0; col < Cols; col++) {
+            lit = lit || matrix[row][col] != 0;
+        }
+        if (lit) {
+            last = row;
+        } else if (last >= 0) {
+            break;
+        }
+    }
+    return last >= 0 ? last : Rows / 2 - 1;
+}
+
+// Flat-cell pixel lines of a face, one RGB565 line per cell row: a table the
+// display DMA can send straight from flash, each line repeated CellSize times
+template <int Rows, int Width>
+struct FaceLines {
+    uint16_t pixels[Rows][Width];
+};
+
+template <int CellSize, int Rows, int Cols>
+constexpr FaceLines<Rows, Cols * CellSize> make_face_lines(const uint8_t (&matrix)[Rows][Cols],
+                                                            const uint16_t (&colors)[FACE_PALETTE_SIZE]) {
+    FaceLines<Rows, Cols * CellSize> result{};
+    for (int row = 0; row < Rows; row++) {
+        for (int x = 0; x < Cols * CellSize; x++) {
+            result.pixels[row][x] = colors[matrix[row][x / CellSize]];
+        }
+    }
+    return result;
+}
+
+// Precomputed spans for a built-in face, nullptr for any other matrix
+const FaceSpans* find_face_spans(const uint8_t (&matrix)[MATRIX_ROWS][MATRIX_COLS]);
+
+// face_eyes_last_row, from the compile-time table for built-in faces
+int find_face_eyes_last_row(const uint8_t (&matrix)[MATRIX_ROWS][MATRIX_COLS]);
+
+// Built-in faces upscaled at compile time, used by the geometry benchmark
+extern const FaceCells<24, 24> NEUTRAL_NO_BLINK_24;
+extern const FaceCells<24, 24> NEUTRAL_BLINK_24;
+extern const FaceCells<48, 48> NEUTRAL_NO_BLINK_48;
+extern const FaceCells<48, 48> NEUTRAL_BLINK_48;
+
+// Small cell sprite for effect overlays, background (0) cells are transparent
+struct CellSprite {
+    uint8_t rows;
+    uint8_t cols;
+    const uint8_t* cells;  // rows * cols, row by row
+};
+
+// Effect overlays
+extern const CellSprite BLUSH_CHEEK_SPRITE;
 
 // Angry expressions
 extern Matrix12x12 ANGRY_CLOSED_MOUTH;
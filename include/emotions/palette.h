@@ -0,0 +1,28 @@
+#ifndef PALETTE_H
+#define PALETTE_H
+
+#include "mrx.h"
+#include "colors.h"
+#include <cstdint>
+#include <string_view>
+
+// Palette slots shared by all faces
+enum PaletteIndex : uint8_t {
+    PALETTE_BG = 0,      // Фон
+    PALETTE_FACE = 1,    // Основные линии лица
+    PALETTE_ACCENT = 2,  // Сердечки, злые глаза
+    PALETTE_BLUSH = 3    // Румянец
+};
+
+// RGB565 colour for every palette index a face cell can hold
+struct Palette {
+    uint16_t colors[FACE_PALETTE_SIZE];
+};
+
+// Constant so tables built from it (the boot splash) are made by the compiler
+inline constexpr Palette PALETTE_DEFAULT = {{STYLE_BG, STYLE_FACE, STYLE_FACE_RED, PINK}};
+
+// Palette for an emotion name, PALETTE_DEFAULT for unknown names
+const Palette& palette_for_emotion(std::string_view emotion);
+
+#endif // PALETTE_H
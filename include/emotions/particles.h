@@ -0,0 +1,46 @@
+#ifndef PARTICLES_H
+#define PARTICLES_H
+
+#include <cstdint>
+#include <string_view>
+
+// Particle effects drawn over the face (hearts, tears, sweat, sparkles).
+// Fixed pool, no heap, integer physics. Each frame only the union of the old
+// and new rectangle of every particle is rewritten: face pixels from the
+// renderer with the sprites stamped on top.
+
+#define PARTICLE_POOL_SIZE 48
+// Emitters active at once (an emotion may use several, e.g. one per eye)
+#define PARTICLE_MAX_EMITTERS 4
+// Particles move at most this often (~60 Hz)
+#define PARTICLE_FRAME_US 16667
+
+enum ParticleKind : uint8_t {
+    PARTICLE_HEART,
+    PARTICLE_TEAR,
+    PARTICLE_SWEAT,
+    PARTICLE_SPARKLE,
+    PARTICLE_KIND_COUNT
+};
+
+// Start the emitters configured for an emotion, spawn rates scale with
+// intensity (0.0..1.0); particles of the previous emotion are erased
+void particles_start_for_emotion(std::string_view emotion, double intensity);
+void particles_stop();
+
+// Spawn one particle at display pixel (x, y) with velocity in pixels per second
+bool particles_spawn(ParticleKind kind, int x, int y, int vx, int vy);
+
+// Step, spawn and redraw, call once per main loop iteration after the face is drawn
+void particles_update(uint32_t now_us);
+
+int particles_active();
+
+// Per-frame cost as JSON: {"particle_stats": ...}
+void particles_report();
+void particles_reset_stats();
+
+// Cost of a particle frame for 8..PARTICLE_POOL_SIZE particles, printed over serial
+void particles_benchmark();
+
+#endif // PARTICLES_H
@@ -0,0 +1,181 @@
+// Generated by tools/gen_subtitle_font.py from tools/subtitle_font.txt, do not edit
+#ifndef SUBTITLE_FONT_H
+#define SUBTITLE_FONT_H
+
+#include <cstdint>
+
+#define SUBTITLE_FONT_WIDTH 5
+#define SUBTITLE_FONT_HEIGHT 8
+#define SUBTITLE_FONT_GLYPHS 161
+
+// Glyph rows, leftmost pixel in bit 7; sorted by code point
+struct SubtitleGlyph {
+    uint16_t codepoint;
+    uint8_t rows[SUBTITLE_FONT_HEIGHT];
+};
+
+static const SubtitleGlyph SUBTITLE_FONT[SUBTITLE_FONT_GLYPHS] = {
+    {0x0020, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},  //  
+    {0x0021, {0x20, 0x20, 0x20, 0x20, 0x20, 0x00, 0x20, 0x00}},  // !
+    {0x0022, {0x50, 0x50, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},  // "
+    {0x0023, {0x50, 0x50, 0xf8, 0x50, 0xf8, 0x50, 0x50, 0x00}},  // #
+    {0x0024, {0x20, 0x78, 0xa0, 0x70, 0x28, 0xf0, 0x20, 0x00}},  // $
+    {0x0025, {0xc0, 0xc8, 0x10, 0x20, 0x40, 0x98, 0x18, 0x00}},  // %
+    {0x0026, {0x60, 0x90, 0xa0, 0x40, 0xa8, 0x90, 0x68, 0x00}},  // &
+    {0x0027, {0x20, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},  // '
+    {0x0028, {0x10, 0x20, 0x40, 0x40, 0x40, 0x20, 0x10, 0x00}},  // (
+    {0x0029, {0x40, 0x20, 0x10, 0x10, 0x10, 0x20, 0x40, 0x00}},  // )
+    {0x002a, {0x00, 0x20, 0xa8, 0x70, 0xa8, 0x20, 0x00, 0x00}},  // *
+    {0x002b, {0x00, 0x20, 0x20, 0xf8, 0x20, 0x20, 0x00, 0x00}},  // +
+    {0x002c, {0x00, 0x00, 0x00, 0x00, 0x00, 0x60, 0x20, 0x40}},  // ,
+    {0x002d, {0x00, 0x00, 0x00, 0xf8, 0x00, 0x00, 0x00, 0x00}},  // -
+    {0x002e, {0x00, 0x00, 0x00, 0x00, 0x00, 0x60, 0x60, 0x00}},  // .
+    {0x002f, {0x00, 0x08, 0x10, 0x20, 0x40, 0x80, 0x00, 0x00}},  // /
+    {0x0030, {0x70, 0x88, 0x98, 0xa8, 0xc8, 0x88, 0x70, 0x00}},  // 0
+    {0x0031, {0x20, 0x60, 0x20, 0x20, 0x20, 0x20, 0x70, 0x00}},  // 1
+    {0x0032, {0x70, 0x88, 0x08, 0x10, 0x20, 0x40, 0xf8, 0x00}},  // 2
+    {0x0033, {0xf8, 0x10, 0x20, 0x10, 0x08, 0x88, 0x70, 0x00}},  // 3
+    {0x0034, {0x10, 0x30, 0x50, 0x90, 0xf8, 0x10, 0x10, 0x00}},  // 4
+    {0x0035, {0xf8, 0x80, 0xf0, 0x08, 0x08, 0x88, 0x70, 0x00}},  // 5
+    {0x0036, {0x30, 0x40, 0x80, 0xf0, 0x88, 0x88, 0x70, 0x00}},  // 6
+    {0x0037, {0xf8, 0x08, 0x10, 0x20, 0x40, 0x40, 0x40, 0x00}},  // 7
+    {0x0038, {0x70, 0x88, 0x88, 0x70, 0x88, 0x88, 0x70, 0x00}},  // 8
+    {0x0039, {0x70, 0x88, 0x88, 0x78, 0x08, 0x10, 0x60, 0x00}},  // 9
+    {0x003a, {0x00, 0x60, 0x60, 0x00, 0x60, 0x60, 0x00, 0x00}},  // :
+    {0x003b, {0x00, 0x60, 0x60, 0x00, 0x60, 0x20, 0x40, 0x00}},  // ;
+    {0x003c, {0x10, 0x20, 0x40, 0x80, 0x40, 0x20, 0x10, 0x00}},  // <
+    {0x003d, {0x00, 0x00, 0xf8, 0x00, 0xf8, 0x00, 0x00, 0x00}},  // =
+    {0x003e, {0x40, 0x20, 0x10, 0x08, 0x10, 0x20, 0x40, 0x00}},  // >
+    {0x003f, {0x70, 0x88, 0x08, 0x10, 0x20, 0x00, 0x20, 0x00}},  // ?
+    {0x0040, {0x70, 0x88, 0x08, 0x68, 0xa8, 0xa8, 0x70, 0x00}},  // @
+    {0x0041, {0x70, 0x88, 0x88, 0xf8, 0x88, 0x88, 0x88, 0x00}},  // A
+    {0x0042, {0xf0, 0x88, 0x88, 0xf0, 0x88, 0x88, 0xf0, 0x00}},  // B
+    {0x0043, {0x70, 0x88, 0x80, 0x80, 0x80, 0x88, 0x70, 0x00}},  // C
+    {0x0044, {0xe0, 0x90, 0x88, 0x88, 0x88, 0x90, 0xe0, 0x00}},  // D
+    {0x0045, {0xf8, 0x80, 0x80, 0xf0, 0x80, 0x80, 0xf8, 0x00}},  // E
+    {0x0046, {0xf8, 0x80, 0x80, 0xf0, 0x80, 0x80, 0x80, 0x00}},  // F
+    {0x0047, {0x70, 0x88, 0x80, 0xb8, 0x88, 0x88, 0x78, 0x00}},  // G
+    {0x0048, {0x88, 0x88, 0x88, 0xf8, 0x88, 0x88, 0x88, 0x00}},  // H
+    {0x0049, {0x70, 0x20, 0x20, 0x20, 0x20, 0x20, 0x70, 0x00}},  // I
+    {0x004a, {0x38, 0x10, 0x10, 0x10, 0x10, 0x90, 0x60, 0x00}},  // J
+    {0x004b, {0x88, 0x90, 0xa0, 0xc0, 0xa0, 0x90, 0x88, 0x00}},  // K
+    {0x004c, {0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0xf8, 0x00}},  // L
+    {0x004d, {0x88, 0xd8, 0xa8, 0xa8, 0x88, 0x88, 0x88, 0x00}},  // M
+    {0x004e, {0x88, 0x88, 0xc8, 0xa8, 0x98, 0x88, 0x88, 0x00}},  // N
+    {0x004f, {0x70, 0x88, 0x88, 0x88, 0x88, 0x88, 0x70, 0x00}},  // O
+    {0x0050, {0xf0, 0x88, 0x88, 0xf0, 0x80, 0x80, 0x80, 0x00}},  // P
+    {0x0051, {0x70, 0x88, 0x88, 0x88, 0xa8, 0x90, 0x68, 0x00}},  // Q
+    {0x0052, {0xf0, 0x88, 0x88, 0xf0, 0xa0, 0x90, 0x88, 0x00}},  // R
+    {0x0053, {0x78, 0x80, 0x80, 0x70, 0x08, 0x08, 0xf0, 0x00}},  // S
+    {0x0054, {0xf8, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x00}},  // T
+    {0x0055, {0x88, 0x88, 0x88, 0x88, 0x88, 0x88, 0x70, 0x00}},  // U
+    {0x0056, {0x88, 0x88, 0x88, 0x88, 0x88, 0x50, 0x20, 0x00}},  // V
+    {0x0057, {0x88, 0x88, 0x88, 0xa8, 0xa8, 0xa8, 0x50, 0x00}},  // W
+    {0x0058, {0x88, 0x88, 0x50, 0x20, 0x50, 0x88, 0x88, 0x00}},  // X
+    {0x0059, {0x88, 0x88, 0x50, 0x20, 0x20, 0x20, 0x20, 0x00}},  // Y
+    {0x005a, {0xf8, 0x08, 0x10, 0x20, 0x40, 0x80, 0xf8, 0x00}},  // Z
+    {0x005b, {0x70, 0x40, 0x40, 0x40, 0x40, 0x40, 0x70, 0x00}},  // [
+    {0x005c, {0x00, 0x80, 0x40, 0x20, 0x10, 0x08, 0x00, 0x00}},  //  
+    {0x005d, {0x70, 0x10, 0x10, 0x10, 0x10, 0x10, 0x70, 0x00}},  // ]
+    {0x005e, {0x20, 0x50, 0x88, 0x00, 0x00, 0x00, 0x00, 0x00}},  // ^
+    {0x005f, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xf8}},  // _
+    {0x0060, {0x40, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},  // `
+    {0x0061, {0x00, 0x00, 0x70, 0x08, 0x78, 0x88, 0x78, 0x00}},  // a
+    {0x0062, {0x80, 0x80, 0xb0, 0xc8, 0x88, 0x88, 0xf0, 0x00}},  // b
+    {0x0063, {0x00, 0x00, 0x70, 0x80, 0x80, 0x88, 0x70, 0x00}},  // c
+    {0x0064, {0x08, 0x08, 0x68, 0x98, 0x88, 0x88, 0x78, 0x00}},  // d
+    {0x0065, {0x00, 0x00, 0x70, 0x88, 0xf8, 0x80, 0x70, 0x00}},  // e
+    {0x0066, {0x30, 0x48, 0x40, 0xe0, 0x40, 0x40, 0x40, 0x00}},  // f
+    {0x0067, {0x00, 0x00, 0x78, 0x88, 0x88, 0x78, 0x08, 0x70}},  // g
+    {0x0068, {0x80, 0x80, 0xb0, 0xc8, 0x88, 0x88, 0x88, 0x00}},  // h
+    {0x0069, {0x20, 0x00, 0x60, 0x20, 0x20, 0x20, 0x70, 0x00}},  // i
+    {0x006a, {0x10, 0x00, 0x30, 0x10, 0x10, 0x10, 0x90, 0x60}},  // j
+    {0x006b, {0x80, 0x80, 0x90, 0xa0, 0xc0, 0xa0, 0x90, 0x00}},  // k
+    {0x006c, {0x60, 0x20, 0x20, 0x20, 0x20, 0x20, 0x70, 0x00}},  // l
+    {0x006d, {0x00, 0x00, 0xd0, 0xa8, 0xa8, 0x88, 0x88, 0x00}},  // m
+    {0x006e, {0x00, 0x00, 0xb0, 0xc8, 0x88, 0x88, 0x88, 0x00}},  // n
+    {0x006f, {0x00, 0x00, 0x70, 0x88, 0x88, 0x88, 0x70, 0x00}},  // o
+    {0x0070, {0x00, 0x00, 0xf0, 0x88, 0x88, 0xf0, 0x80, 0x80}},  // p
+    {0x0071, {0x00, 0x00, 0x78, 0x88, 0x88, 0x78, 0x08, 0x08}},  // q
+    {0x0072, {0x00, 0x00, 0xb0, 0xc8, 0x80, 0x80, 0x80, 0x00}},  // r
+    {0x0073, {0x00, 0x00, 0x78, 0x80, 0x70, 0x08, 0xf0, 0x00}},  // s
+    {0x0074, {0x40, 0x40, 0xe0, 0x40, 0x40, 0x48, 0x30, 0x00}},  // t
+    {0x0075, {0x00, 0x00, 0x88, 0x88, 0x88, 0x98, 0x68, 0x00}},  // u
+    {0x0076, {0x00, 0x00, 0x88, 0x88, 0x88, 0x50, 0x20, 0x00}},  // v
+    {0x0077, {0x00, 0x00, 0x88, 0x88, 0xa8, 0xa8, 0x50, 0x00}},  // w
+    {0x0078, {0x00, 0x00, 0x88, 0x50, 0x20, 0x50, 0x88, 0x00}},  // x
+    {0x0079, {0x00, 0x00, 0x88, 0x88, 0x88, 0x78, 0x08, 0x70}},  // y
+    {0x007a, {0x00, 0x00, 0xf8, 0x10, 0x20, 0x40, 0xf8, 0x00}},  // z
+    {0x007b, {0x10, 0x20, 0x20, 0x40, 0x20, 0x20, 0x10, 0x00}},  // {
+    {0x007c, {0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x00}},  // |
+    {0x007d, {0x40, 0x20, 0x20, 0x10, 0x20, 0x20, 0x40, 0x00}},  // }
+    {0x007e, {0x00, 0x00, 0x40, 0xa8, 0x10, 0x00, 0x00, 0x00}},  // ~
+    {0x0401, {0x50, 0x00, 0xf8, 0x80, 0xf0, 0x80, 0xf8, 0x00}},  // Ё
+    {0x0410, {0x70, 0x88, 0x88, 0xf8, 0x88, 0x88, 0x88, 0x00}},  // А
+    {0x0411, {0xf8, 0x80, 0x80, 0xf0, 0x88, 0x88, 0xf0, 0x00}},  // Б
+    {0x0412, {0xf0, 0x88, 0x88, 0xf0, 0x88, 0x88, 0xf0, 0x00}},  // В
+    {0x0413, {0xf8, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x00}},  // Г
+    {0x0414, {0x30, 0x50, 0x50, 0x50, 0x50, 0xf8, 0x88, 0x00}},  // Д
+    {0x0415, {0xf8, 0x80, 0x80, 0xf0, 0x80, 0x80, 0xf8, 0x00}},  // Е
+    {0x0416, {0xa8, 0xa8, 0x70, 0x20, 0x70, 0xa8, 0xa8, 0x00}},  // Ж
+    {0x0417, {0x70, 0x88, 0x08, 0x30, 0x08, 0x88, 0x70, 0x00}},  // З
+    {0x0418, {0x88, 0x88, 0x98, 0xa8, 0xc8, 0x88, 0x88, 0x00}},  // И
+    {0x0419, {0x50, 0x88, 0x98, 0xa8, 0xc8, 0x88, 0x88, 0x00}},  // Й
+    {0x041a, {0x88, 0x90, 0xa0, 0xc0, 0xa0, 0x90, 0x88, 0x00}},  // К
+    {0x041b, {0x38, 0x48, 0x48, 0x48, 0x48, 0x48, 0x88, 0x00}},  // Л
+    {0x041c, {0x88, 0xd8, 0xa8, 0xa8, 0x88, 0x88, 0x88, 0x00}},  // М
+    {0x041d, {0x88, 0x88, 0x88, 0xf8, 0x88, 0x88, 0x88, 0x00}},  // Н
+    {0x041e, {0x70, 0x88, 0x88, 0x88, 0x88, 0x88, 0x70, 0x00}},  // О
+    {0x041f, {0xf8, 0x88, 0x88, 0x88, 0x88, 0x88, 0x88, 0x00}},  // П
+    {0x0420, {0xf0, 0x88, 0x88, 0xf0, 0x80, 0x80, 0x80, 0x00}},  // Р
+    {0x0421, {0x70, 0x88, 0x80, 0x80, 0x80, 0x88, 0x70, 0x00}},  // С
+    {0x0422, {0xf8, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x00}},  // Т
+    {0x0423, {0x88, 0x88, 0x88, 0x78, 0x08, 0x88, 0x70, 0x00}},  // У
+    {0x0424, {0x20, 0x70, 0xa8, 0xa8, 0xa8, 0x70, 0x20, 0x00}},  // Ф
+    {0x0425, {0x88, 0x88, 0x50, 0x20, 0x50, 0x88, 0x88, 0x00}},  // Х
+    {0x0426, {0x90, 0x90, 0x90, 0x90, 0x90, 0xf8, 0x08, 0x00}},  // Ц
+    {0x0427, {0x88, 0x88, 0x88, 0x78, 0x08, 0x08, 0x08, 0x00}},  // Ч
+    {0x0428, {0xa8, 0xa8, 0xa8, 0xa8, 0xa8, 0xa8, 0xf8, 0x00}},  // Ш
+    {0x0429, {0xa8, 0xa8, 0xa8, 0xa8, 0xa8, 0xf8, 0x08, 0x00}},  // Щ
+    {0x042a, {0xc0, 0x40, 0x40, 0x70, 0x48, 0x48, 0x70, 0x00}},  // Ъ
+    {0x042b, {0x88, 0x88, 0x88, 0xc8, 0xa8, 0xa8, 0xc8, 0x00}},  // Ы
+    {0x042c, {0x80, 0x80, 0x80, 0xf0, 0x88, 0x88, 0xf0, 0x00}},  // Ь
+    {0x042d, {0x70, 0x88, 0x08, 0x38, 0x08, 0x88, 0x70, 0x00}},  // Э
+    {0x042e, {0x90, 0xa8, 0xa8, 0xe8, 0xa8, 0xa8, 0x90, 0x00}},  // Ю
+    {0x042f, {0x78, 0x88, 0x88, 0x78, 0x28, 0x48, 0x88, 0x00}},  // Я
+    {0x0430, {0x00, 0x00, 0x70, 0x08, 0x78, 0x88, 0x78, 0x00}},  // а
+    {0x0431, {0x18, 0x60, 0x80, 0xf0, 0x88, 0x88, 0x70, 0x00}},  // б
+    {0x0432, {0x00, 0x00, 0xf0, 0x88, 0xf0, 0x88, 0xf0, 0x00}},  // в
+    {0x0433, {0x00, 0x00, 0xf8, 0x80, 0x80, 0x80, 0x80, 0x00}},  // г
+    {0x0434, {0x00, 0x00, 0x30, 0x50, 0x50, 0xf8, 0x88, 0x00}},  // д
+    {0x0435, {0x00, 0x00, 0x70, 0x88, 0xf8, 0x80, 0x70, 0x00}},  // е
+    {0x0436, {0x00, 0x00, 0xa8, 0x70, 0x20, 0x70, 0xa8, 0x00}},  // ж
+    {0x0437, {0x00, 0x00, 0x70, 0x08, 0x30, 0x08, 0x70, 0x00}},  // з
+    {0x0438, {0x00, 0x00, 0x88, 0x98, 0xa8, 0xc8, 0x88, 0x00}},  // и
+    {0x0439, {0x50, 0x20, 0x88, 0x98, 0xa8, 0xc8, 0x88, 0x00}},  // й
+    {0x043a, {0x80, 0x80, 0x90, 0xa0, 0xc0, 0xa0, 0x90, 0x00}},  // к
+    {0x043b, {0x00, 0x00, 0x38, 0x48, 0x48, 0x48, 0x88, 0x00}},  // л
+    {0x043c, {0x00, 0x00, 0x88, 0xd8, 0xa8, 0x88, 0x88, 0x00}},  // м
+    {0x043d, {0x00, 0x00, 0x88, 0x88, 0xf8, 0x88, 0x88, 0x00}},  // н
+    {0x043e, {0x00, 0x00, 0x70, 0x88, 0x88, 0x88, 0x70, 0x00}},  // о
+    {0x043f, {0x00, 0x00, 0xf8, 0x88, 0x88, 0x88, 0x88, 0x00}},  // п
+    {0x0440, {0x00, 0x00, 0xf0, 0x88, 0x88, 0xf0, 0x80, 0x80}},  // р
+    {0x0441, {0x00, 0x00, 0x70, 0x80, 0x80, 0x88, 0x70, 0x00}},  // с
+    {0x0442, {0x00, 0x00, 0xf8, 0x20, 0x20, 0x20, 0x20, 0x00}},  // т
+    {0x0443, {0x00, 0x00, 0x88, 0x88, 0x88, 0x78, 0x08, 0x70}},  // у
+    {0x0444, {0x00, 0x20, 0x70, 0xa8, 0xa8, 0x70, 0x20, 0x00}},  // ф
+    {0x0445, {0x00, 0x00, 0x88, 0x50, 0x20, 0x50, 0x88, 0x00}},  // х
+    {0x0446, {0x00, 0x00, 0x90, 0x90, 0x90, 0xf8, 0x08, 0x00}},  // ц
+    {0x0447, {0x00, 0x00, 0x88, 0x88, 0x78, 0x08, 0x08, 0x00}},  // ч
+    {0x0448, {0x00, 0x00, 0xa8, 0xa8, 0xa8, 0xa8, 0xf8, 0x00}},  // ш
+    {0x0449, {0x00, 0x00, 0xa8, 0xa8, 0xa8, 0xf8, 0x08, 0x00}},  // щ
+    {0x044a, {0x00, 0x00, 0xc0, 0x40, 0x70, 0x48, 0x70, 0x00}},  // ъ
+    {0x044b, {0x00, 0x00, 0x88, 0x88, 0xc8, 0xa8, 0xc8, 0x00}},  // ы
+    {0x044c, {0x00, 0x00, 0x80, 0x80, 0xf0, 0x88, 0xf0, 0x00}},  // ь
+    {0x044d, {0x00, 0x00, 0x70, 0x88, 0x38, 0x88, 0x70, 0x00}},  // э
+    {0x044e, {0x00, 0x00, 0x90, 0xa8, 0xe8, 0xa8, 0x90, 0x00}},  // ю
+    {0x044f, {0x00, 0x00, 0x78, 0x88, 0x78, 0x48, 0x88, 0x00}},  // я
+    {0x0451, {0x50, 0x00, 0x70, 0x88, 0xf8, 0x80, 0x70, 0x00}},  // ё
+};
+
+#endif // SUBTITLE_FONT_H
@@ -0,0 +1,39 @@
+#ifndef SUBTITLES_H
+#define SUBTITLES_H
+
+#include <cstdint>
+#include <string_view>
+
+// Subtitles for the talking emotion in the band below the face. Text is UTF-8
+// (Latin and Cyrillic, tools/subtitle_font.txt), word-wrapped into lines; the
+// band shows two lines and moves to the next one with the panel's hardware
+// vertical scroll, so each scroll step writes a single pixel row.
+
+// Font pixels per glyph pixel
+#define SUBTITLE_SCALE 2
+#define SUBTITLE_MAX_CHARS 256
+#define SUBTITLE_MAX_LINES 24
+// Rendered glyphs kept in RGB565 for the current colours. Rows are composed
+// left to right across the whole line, so the cache must hold a full line
+// (DISPLAY_WIDTH / 12 = 20 glyphs) or every row evicts what the next one needs
+#define SUBTITLE_CACHE_SIZE 24
+// One scroll pixel per step (~60 Hz)
+#define SUBTITLE_SCROLL_STEP_US 16667
+
+// Empty the glyph cache; called once at startup
+void subtitles_init();
+
+// Off by default; turning off clears the band
+void subtitles_set_enabled(bool enabled);
+bool subtitles_enabled();
+
+// Show `text` for a speech of `duration_ms`: lines scroll as the speech advances
+void subtitles_start(std::string_view text, uint32_t duration_ms);
+
+// Blank the band and reset the scroll
+void subtitles_clear();
+
+// Scroll and repaint, call once per main loop iteration
+void subtitles_update(uint32_t now_us);
+
+#endif // SUBTITLES_H
@@ -10,6 +10,37 @@
 
 #include "hardware/spi.h"
 
+// Bus backend, chosen at build time: 0 - hardware SPI, the driver frames
+// commands with CS/DC GPIOs; 1 - a PIO state machine frames them and is fed by
+// DMA from a list of commands and pixel runs (needs gpio_cs == gpio_dc + 1).
+#ifndef ST7789_BACKEND_PIO
+#define ST7789_BACKEND_PIO 0
+#endif
+
+#if ST7789_BACKEND_PIO
+#include "hardware/pio.h"
+
+// PIO bit clock (two instructions per bit, limited by clk_sys / 2)
+#ifndef ST7789_PIO_BAUD
+#define ST7789_PIO_BAUD (62500 * 1000)
+#endif
+// Halfwords of queued commands per display
+#define ST7789_LIST_LEN 64
+// Pixels per RAMWR/RAMWRC entry: the bit count is 16 bits wide
+#define ST7789_PIO_MAX_RUN 4095
+#define ST7789_MAX_RUN ST7789_PIO_MAX_RUN
+#else
+#define ST7789_MAX_RUN 0xffffffffu
+#endif
+
+// Draw list capacity: ops, pixels of blit lines, lines per blit op
+#define ST7789_DRAW_LIST_OPS 96
+#define ST7789_DRAW_LIST_PIXELS 4096
+#define ST7789_DRAW_LIST_MAX_LINES 64
+// Control blocks of one blit: a run (and a PIO header) per line, the queued
+// commands and the null block
+#define ST7789_CHAIN_BLOCKS (2 * ST7789_DRAW_LIST_MAX_LINES + 2)
+
 struct st7789_config {
     spi_inst_t* spi;
     uint gpio_din;
@@ -20,11 +51,115 @@ struct st7789_config {
     uint gpio_bl;
 };
 
+// One panel on its own SPI bus (or PIO state machine). Pixel writes are
+// streamed by a DMA channel claimed at init, so panels on different buses can
+// be written at once.
+struct st7789_display {
+    struct st7789_config cfg;
+    uint16_t width;
+    uint16_t height;
+    bool data_mode;
+    int dma_channel;        // -1: no free channel, writes are blocking
+    uint16_t fill_pixel;    // DMA source of fill transfers
+    int ctrl_channel;       // reloads the pixel channel from `chain`, -1 if none
+    uint32_t chain[2 * ST7789_CHAIN_BLOCKS];
+    uint8_t init_step;      // next step of the init sequence
+    uint32_t init_until;    // time_us_32 the step waits for
+#if ST7789_BACKEND_PIO
+    PIO pio;
+    uint sm;
+    int list_channel;       // commands, chained to the pixel channel
+    uint16_t list_len;
+    uint16_t list[ST7789_LIST_LEN];
+    uint16_t chain_headers[2 * ST7789_DRAW_LIST_MAX_LINES];
+#endif
+};
+
+// Panels one logical screen can be split across
+#define ST7789_MAX_SCREEN_PARTS 2
+
+void st7789_display_init(struct st7789_display* display, const struct st7789_config* config, uint16_t width, uint16_t height);
+// Non-blocking init: begin claims the bus and returns at once, poll sends the
+// commands whose wait is over and returns true once the panel takes pixels.
+// The backlight stays off; the caller switches it on after the first image.
+void st7789_display_init_begin(struct st7789_display* display, const struct st7789_config* config, uint16_t width, uint16_t height);
+bool st7789_display_init_poll(struct st7789_display* display);
+void st7789_display_set_window(struct st7789_display* display, uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1);
+void st7789_display_write(struct st7789_display* display, const void* data, size_t len);
+// Start streaming into the window; `data` must stay valid until st7789_display_wait
+void st7789_display_write_async(struct st7789_display* display, const void* data, size_t len);
+void st7789_display_fill_async(struct st7789_display* display, uint16_t pixel, size_t count);
+void st7789_display_wait(struct st7789_display* display);
+
+// The functions below draw on a logical screen: the display of st7789_init,
+// or two panels side by side after st7789_split_screen. Screen columns from
+// `split_x` on go to `right` starting at its column `right_x`; columns before
+// it go to `left` starting at `left_x`. Panel commands go to every panel.
+void st7789_split_screen(struct st7789_display* left, uint16_t left_x,
+                         struct st7789_display* right, uint16_t right_x, uint16_t split_x);
+struct st7789_display* st7789_default_display(void);
+
+// Draw list: window, fill and blit ops recorded into a fixed buffer and
+// executed in the background by chained DMA, one interrupt per fill or blit.
+// Fills and blits cover whole lines of the last window. Drawing with the
+// functions below waits until submitted lists are out.
+enum st7789_op_type {
+    ST7789_OP_WINDOW,
+    ST7789_OP_FILL,
+    ST7789_OP_BLIT,
+};
+
+struct st7789_op {
+    uint8_t type;
+    uint16_t x0, y0, x1, y1;    // window
+    uint16_t pixel;             // fill colour
+    uint16_t lines;             // fill and blit
+    uint16_t stride;            // blit: pixels between lines, 0 repeats one line
+    const uint16_t* data;       // blit: first line, in `pixels` or caller memory
+};
+
+struct st7789_draw_list {
+    struct st7789_op ops[ST7789_DRAW_LIST_OPS];
+    uint16_t op_count;
+    uint16_t pixels[ST7789_DRAW_LIST_PIXELS];
+    uint16_t pixel_count;
+    uint16_t width;             // of the last window
+    volatile bool in_flight;
+};
+
+void st7789_draw_list_reset(struct st7789_draw_list* list);
+// Appending returns false (NULL) when the list is full
+bool st7789_draw_list_window(struct st7789_draw_list* list, uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1);
+bool st7789_draw_list_fill(struct st7789_draw_list* list, uint16_t pixel, uint16_t lines);
+// Room for one window line, shown `repeat` times; the caller fills it before submitting
+uint16_t* st7789_draw_list_line(struct st7789_draw_list* list, uint16_t repeat);
+// Window lines read from `data` (e.g. a table in flash) instead of the list
+bool st7789_draw_list_blit(struct st7789_draw_list* list, const uint16_t* data, uint16_t lines, uint16_t stride);
+// Start executing (or queue behind the list going out); written in place if
+// no DMA channels are free. The list must not change until it is done.
+void st7789_draw_list_submit(struct st7789_draw_list* list);
+bool st7789_draw_list_busy(const struct st7789_draw_list* list);
+void st7789_draw_list_fence(const struct st7789_draw_list* list);
+// Wait for every submitted list
+void st7789_draw_list_sync(void);
+
 void st7789_init(const struct st7789_config* config, uint16_t width, uint16_t height);
+// st7789_display_init_begin/poll for the default display
+void st7789_init_begin(const struct st7789_config* config, uint16_t width, uint16_t height);
+bool st7789_init_poll(void);
 void st7789_write(const void* data, size_t len);
 void st7789_put(uint16_t pixel);
 void st7789_fill(uint16_t pixel);
 void st7789_set_cursor(uint16_t x, uint16_t y);
+void st7789_set_window(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1);
+void st7789_fill_pixels(uint16_t pixel, size_t count);
 void st7789_vertical_scroll(uint16_t row);
+void st7789_vertical_scroll_area(uint16_t top_fixed, uint16_t scroll_height, uint16_t bottom_fixed);
+void st7789_invert(bool on);
+void st7789_idle_mode(bool on);
+void st7789_partial_area(uint16_t start_row, uint16_t end_row);
+void st7789_partial_mode(bool on);
+void st7789_madctl(uint8_t value);
+void st7789_tearing_effect(bool on);
 
 #endif
@@ -8,49 +8,363 @@
 #include <string.h>
 
 #include "hardware/gpio.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
 #include "pico/stdlib.h"
 #include "pico/st7789.h"
 
-static struct st7789_config st7789_cfg;
+#if ST7789_BACKEND_PIO
+#include "hardware/pio.h"
+#include "hardware/clocks.h"
+#include "st7789_lcd.pio.h"
+#endif
+
+// ST7789_RAM_FUNCS: the command, pixel and draw list paths run from SRAM
+// instead of through the XIP cache
+#ifndef ST7789_RAM_FUNCS
+#define ST7789_RAM_FUNCS 0
+#endif
+#if ST7789_RAM_FUNCS
+#define ST7789_FUNC(name) __not_in_flash_func(name)
+#else
+#define ST7789_FUNC(name) name
+#endif
+
+// Display of st7789_init and the logical screen drawn by the single-display API:
+// one part per panel, each owning a range of screen columns
+struct st7789_screen_part {
+    struct st7789_display* display;
+    uint16_t x0;        // first screen column of the part
+    uint16_t x1;        // one past the last screen column
+    uint16_t panel_x;   // panel column showing screen column x0
+    bool in_window;
+};
+
+static struct st7789_display st7789_default;
+static struct st7789_screen_part st7789_parts[ST7789_MAX_SCREEN_PARTS];
+static int st7789_part_count = 0;
 static uint16_t st7789_width;
 static uint16_t st7789_height;
-static bool st7789_data_mode = false;
 
-static void st7789_cmd(uint8_t cmd, const uint8_t* data, size_t len)
+// Current screen window and write position in it
+static uint16_t win_x0, win_x1, win_y0, win_y1;
+static uint16_t cur_x, cur_y;
+
+#if ST7789_BACKEND_PIO
+
+// PIO backend: a state machine does the CS/DC toggling and command/data
+// framing (st7789_lcd.pio). Commands are appended to the display's list and
+// go out by DMA with the next pixel run or flush; the CPU only writes the list.
+
+static int st7789_pio_offset = -1;
+
+static void st7789_bus_init(struct st7789_display* display)
+{
+    // The program drives DC and CS as one pin pair
+    hard_assert(display->cfg.gpio_cs == (int)display->cfg.gpio_dc + 1);
+
+    display->pio = pio0;
+    if (st7789_pio_offset < 0) {
+        st7789_pio_offset = pio_add_program(display->pio, &st7789_lcd_program);
+    }
+    display->sm = pio_claim_unused_sm(display->pio, true);
+    display->list_len = 0;
+
+    // Two instructions per bit
+    float div = (float)clock_get_hz(clk_sys) / (2.0f * ST7789_PIO_BAUD);
+    st7789_lcd_program_init(display->pio, display->sm, st7789_pio_offset, display->cfg.gpio_din,
+                            display->cfg.gpio_clk, display->cfg.gpio_dc, div < 1.0f ? 1.0f : div);
+
+    // Pixel runs and the list both feed the state machine's TX FIFO, 16-bit transfers
+    display->dma_channel = dma_claim_unused_channel(true);
+    display->list_channel = dma_claim_unused_channel(true);
+    dma_channel_config c = dma_channel_get_default_config(display->dma_channel);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+    channel_config_set_dreq(&c, pio_get_dreq(display->pio, display->sm, true));
+    channel_config_set_write_increment(&c, false);
+    dma_channel_configure(display->dma_channel, &c, &display->pio->txf[display->sm], NULL, 0, false);
+    channel_config_set_read_increment(&c, true);
+    dma_channel_configure(display->list_channel, &c, &display->pio->txf[display->sm], NULL, 0, false);
+}
+
+static void ST7789_FUNC(st7789_list_start)(struct st7789_display* display, bool pixels)
+{
+    // With pixels, the pixel channel (already set up) starts when the list is out
+    dma_channel_config c = dma_get_channel_config(display->list_channel);
+    channel_config_set_chain_to(&c, pixels ? display->dma_channel : display->list_channel);
+    dma_channel_set_config(display->list_channel, &c, false);
+    dma_channel_transfer_from_buffer_now(display->list_channel, display->list, display->list_len);
+    display->list_len = 0;
+}
+
+static void ST7789_FUNC(st7789_flush)(struct st7789_display* display)
 {
-    if (st7789_cfg.gpio_cs > -1) {
-        spi_set_format(st7789_cfg.spi, 8, SPI_CPOL_0, SPI_CPHA_0, SPI_MSB_FIRST);
+    if (display->list_len == 0) {
+        return;
+    }
+    // Commands must not overtake pixels still going to the FIFO
+    dma_channel_wait_for_finish_blocking(display->dma_channel);
+    st7789_list_start(display, false);
+}
+
+static void ST7789_FUNC(st7789_list_put)(struct st7789_display* display, uint16_t value)
+{
+    if (display->list_len == ST7789_LIST_LEN) {
+        st7789_flush(display);
+    }
+    if (display->list_len == 0) {
+        // The buffer may still be going out
+        dma_channel_wait_for_finish_blocking(display->list_channel);
+    }
+    display->list[display->list_len++] = value;
+}
+
+// Entry header: command byte, then the number of data bits that follow
+static void ST7789_FUNC(st7789_list_entry)(struct st7789_display* display, uint8_t cmd, uint32_t bits)
+{
+    st7789_list_put(display, cmd << 8);
+    st7789_list_put(display, bits);
+}
+
+static void ST7789_FUNC(st7789_cmd)(struct st7789_display* display, uint8_t cmd, const uint8_t* data, size_t len)
+{
+    display->data_mode = false;
+    st7789_list_entry(display, cmd, len * 8);
+    for (size_t i = 0; i < len; i += 2) {
+        st7789_list_put(display, data[i] << 8 | (i + 1 < len ? data[i + 1] : 0));
+    }
+}
+
+void ST7789_FUNC(st7789_display_wait)(struct st7789_display* display)
+{
+    st7789_flush(display);
+    dma_channel_wait_for_finish_blocking(display->list_channel);
+    dma_channel_wait_for_finish_blocking(display->dma_channel);
+
+    // Done once the state machine stalls on an empty FIFO at the next entry
+    uint32_t stall = 1u << (PIO_FDEBUG_TXSTALL_LSB + display->sm);
+    display->pio->fdebug = stall;
+    while (!(display->pio->fdebug & stall)) {
+        tight_loop_contents();
+    }
+}
+
+static void ST7789_FUNC(st7789_pixels_async)(struct st7789_display* display, const uint16_t* data, size_t count, bool increment)
+{
+    while (count) {
+        size_t run = count < ST7789_PIO_MAX_RUN ? count : ST7789_PIO_MAX_RUN;
+
+        // The list may still be about to trigger the previous run
+        dma_channel_wait_for_finish_blocking(display->list_channel);
+        dma_channel_wait_for_finish_blocking(display->dma_channel);
+
+        // RAMWR (2Ch) starts at the window origin, RAMWRC (3Ch) continues after the last pixel
+        st7789_list_entry(display, display->data_mode ? 0x3c : 0x2c, run * 16);
+        display->data_mode = true;
+
+        dma_channel_config c = dma_get_channel_config(display->dma_channel);
+        channel_config_set_read_increment(&c, increment);
+        dma_channel_configure(display->dma_channel, &c, &display->pio->txf[display->sm], data, run, false);
+        st7789_list_start(display, true);
+
+        if (increment) {
+            data += run;
+        }
+        count -= run;
+    }
+}
+
+void ST7789_FUNC(st7789_display_write_async)(struct st7789_display* display, const void* data, size_t len)
+{
+    st7789_pixels_async(display, data, len / 2, true);
+}
+
+void ST7789_FUNC(st7789_display_fill_async)(struct st7789_display* display, uint16_t pixel, size_t count)
+{
+    // The source of a running fill must not change
+    dma_channel_wait_for_finish_blocking(display->list_channel);
+    dma_channel_wait_for_finish_blocking(display->dma_channel);
+    display->fill_pixel = pixel;
+    st7789_pixels_async(display, &display->fill_pixel, count, false);
+}
+
+#else
+
+static void ST7789_FUNC(st7789_set_format)(struct st7789_display* display, uint bits)
+{
+    if (display->cfg.gpio_cs > -1) {
+        spi_set_format(display->cfg.spi, bits, SPI_CPOL_0, SPI_CPHA_0, SPI_MSB_FIRST);
     } else {
-        spi_set_format(st7789_cfg.spi, 8, SPI_CPOL_1, SPI_CPHA_1, SPI_MSB_FIRST);
+        spi_set_format(display->cfg.spi, bits, SPI_CPOL_1, SPI_CPHA_1, SPI_MSB_FIRST);
     }
-    st7789_data_mode = false;
+}
+
+// Framing delays busy-wait: draw lists issue commands from the DMA interrupt
+static void ST7789_FUNC(st7789_cmd)(struct st7789_display* display, uint8_t cmd, const uint8_t* data, size_t len)
+{
+    st7789_display_wait(display);
+    st7789_set_format(display, 8);
+    display->data_mode = false;
 
-    sleep_us(1);
-    if (st7789_cfg.gpio_cs > -1) {
-        gpio_put(st7789_cfg.gpio_cs, 0);
+    busy_wait_us_32(1);
+    if (display->cfg.gpio_cs > -1) {
+        gpio_put(display->cfg.gpio_cs, 0);
     }
-    gpio_put(st7789_cfg.gpio_dc, 0);
-    sleep_us(1);
+    gpio_put(display->cfg.gpio_dc, 0);
+    busy_wait_us_32(1);
     
-    spi_write_blocking(st7789_cfg.spi, &cmd, sizeof(cmd));
+    spi_write_blocking(display->cfg.spi, &cmd, sizeof(cmd));
     
     if (len) {
-        sleep_us(1);
-        gpio_put(st7789_cfg.gpio_dc, 1);
-        sleep_us(1);
+        busy_wait_us_32(1);
+        gpio_put(display->cfg.gpio_dc, 1);
+        busy_wait_us_32(1);
         
-        spi_write_blocking(st7789_cfg.spi, data, len);
+        spi_write_blocking(display->cfg.spi, data, len);
+    }
+
+    busy_wait_us_32(1);
+    if (display->cfg.gpio_cs > -1) {
+        gpio_put(display->cfg.gpio_cs, 1);
+    }
+    gpio_put(display->cfg.gpio_dc, 1);
+    busy_wait_us_32(1);
+}
+
+static void ST7789_FUNC(st7789_flush)(struct st7789_display* display)
+{
+    // Commands are written as they are issued
+    (void)display;
+}
+
+static void st7789_bus_init(struct st7789_display* display)
+{
+    spi_init(display->cfg.spi, 60 * 1000 * 1000);  // Match Python baudrate
+    st7789_set_format(display, 8);
+
+    gpio_set_function(display->cfg.gpio_din, GPIO_FUNC_SPI);
+    gpio_set_function(display->cfg.gpio_clk, GPIO_FUNC_SPI);
+
+    if (display->cfg.gpio_cs > -1) {
+        gpio_init(display->cfg.gpio_cs);
+    }
+    gpio_init(display->cfg.gpio_dc);
+
+    if (display->cfg.gpio_cs > -1) {
+        gpio_set_dir(display->cfg.gpio_cs, GPIO_OUT);
+    }
+    gpio_set_dir(display->cfg.gpio_dc, GPIO_OUT);
+
+    if (display->cfg.gpio_cs > -1) {
+        gpio_put(display->cfg.gpio_cs, 1);
+    }
+    gpio_put(display->cfg.gpio_dc, 1);
+
+    // Pixel stream of this panel's SPI TX FIFO, 16-bit transfers; -1 if no channel is free
+    display->dma_channel = dma_claim_unused_channel(false);
+    if (display->dma_channel >= 0) {
+        dma_channel_config c = dma_channel_get_default_config(display->dma_channel);
+        channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+        channel_config_set_dreq(&c, spi_get_dreq(display->cfg.spi, true));
+        channel_config_set_write_increment(&c, false);
+        dma_channel_configure(display->dma_channel, &c, &spi_get_hw(display->cfg.spi)->dr, NULL, 0, false);
+    }
+}
+
+static void ST7789_FUNC(st7789_ramwr)(struct st7789_display* display)
+{
+    busy_wait_us_32(1);
+    if (display->cfg.gpio_cs > -1) {
+        gpio_put(display->cfg.gpio_cs, 0);
+    }
+    gpio_put(display->cfg.gpio_dc, 0);
+    busy_wait_us_32(1);
+
+    // RAMWR (2Ch): Memory Write
+    uint8_t cmd = 0x2c;
+    spi_write_blocking(display->cfg.spi, &cmd, sizeof(cmd));
+
+    busy_wait_us_32(1);
+    if (display->cfg.gpio_cs > -1) {
+        gpio_put(display->cfg.gpio_cs, 0);
+    }
+    gpio_put(display->cfg.gpio_dc, 1);
+    busy_wait_us_32(1);
+}
+
+static void ST7789_FUNC(st7789_data_mode)(struct st7789_display* display)
+{
+    if (!display->data_mode) {
+        st7789_ramwr(display);
+        st7789_set_format(display, 16);
+        display->data_mode = true;
     }
+}
 
-    sleep_us(1);
-    if (st7789_cfg.gpio_cs > -1) {
-        gpio_put(st7789_cfg.gpio_cs, 1);
+void ST7789_FUNC(st7789_display_wait)(struct st7789_display* display)
+{
+    if (display->dma_channel < 0) {
+        return;
+    }
+    dma_channel_wait_for_finish_blocking(display->dma_channel);
+    // DMA only feeds the TX FIFO: wait for the last frame, drop what was received
+    while (spi_is_busy(display->cfg.spi)) {
+        tight_loop_contents();
     }
-    gpio_put(st7789_cfg.gpio_dc, 1);
-    sleep_us(1);
+    while (spi_is_readable(display->cfg.spi)) {
+        (void)spi_get_hw(display->cfg.spi)->dr;
+    }
+    spi_get_hw(display->cfg.spi)->icr = SPI_SSPICR_RORIC_BITS;
+}
+
+static void ST7789_FUNC(st7789_dma_start)(struct st7789_display* display, const void* data, size_t count, bool increment)
+{
+    dma_channel_config c = dma_get_channel_config(display->dma_channel);
+    channel_config_set_read_increment(&c, increment);
+    dma_channel_set_config(display->dma_channel, &c, false);
+    dma_channel_transfer_from_buffer_now(display->dma_channel, data, count);
 }
 
-void st7789_caset(uint16_t xs, uint16_t xe)
+void ST7789_FUNC(st7789_display_write_async)(struct st7789_display* display, const void* data, size_t len)
+{
+    st7789_display_wait(display);
+    st7789_data_mode(display);
+    if (display->dma_channel < 0) {
+        spi_write16_blocking(display->cfg.spi, data, len / 2);
+        return;
+    }
+    st7789_dma_start(display, data, len / 2, true);
+}
+
+void ST7789_FUNC(st7789_display_fill_async)(struct st7789_display* display, uint16_t pixel, size_t count)
+{
+    st7789_display_wait(display);
+    st7789_data_mode(display);
+    if (display->dma_channel < 0) {
+        for (size_t i = 0; i < count; i++) {
+            spi_write16_blocking(display->cfg.spi, &pixel, 1);
+        }
+        return;
+    }
+    display->fill_pixel = pixel;
+    st7789_dma_start(display, &display->fill_pixel, count, false);
+}
+
+#endif // ST7789_BACKEND_PIO
+
+void st7789_draw_list_sync(void);
+
+// Panel-wide commands go to every panel of the screen
+static void ST7789_FUNC(st7789_screen_cmd)(uint8_t cmd, const uint8_t* data, size_t len)
+{
+    st7789_draw_list_sync();
+    for (int i = 0; i < st7789_part_count; i++) {
+        st7789_cmd(st7789_parts[i].display, cmd, data, len);
+        st7789_flush(st7789_parts[i].display);
+    }
+}
+
+static void ST7789_FUNC(st7789_caset)(struct st7789_display* display, uint16_t xs, uint16_t xe)
 {
     uint8_t data[] = {
         xs >> 8,
@@ -60,10 +374,10 @@ void st7789_caset(uint16_t xs, uint16_t xe)
     };
 
     // CASET (2Ah): Column Address Set
-    st7789_cmd(0x2a, data, sizeof(data));
+    st7789_cmd(display, 0x2a, data, sizeof(data));
 }
 
-void st7789_raset(uint16_t ys, uint16_t ye)
+static void ST7789_FUNC(st7789_raset)(struct st7789_display* display, uint16_t ys, uint16_t ye)
 {
     uint8_t data[] = {
         ys >> 8,
@@ -73,141 +387,632 @@ void st7789_raset(uint16_t ys, uint16_t ye)
     };
 
     // RASET (2Bh): Row Address Set
-    st7789_cmd(0x2b, data, sizeof(data));
+    st7789_cmd(display, 0x2b, data, sizeof(data));
+}
+
+void st7789_display_init_begin(struct st7789_display* display, const struct st7789_config* config, uint16_t width, uint16_t height)
+{
+    memcpy(&display->cfg, config, sizeof(display->cfg));
+    display->width = width;
+    display->height = height;
+    display->data_mode = false;
+
+    st7789_bus_init(display);
+    // Control channel of draw list chains
+    display->ctrl_channel = display->dma_channel >= 0 ? dma_claim_unused_channel(false) : -1;
+
+    gpio_init(display->cfg.gpio_rst);
+    gpio_init(display->cfg.gpio_bl);
+    gpio_set_dir(display->cfg.gpio_rst, GPIO_OUT);
+    gpio_set_dir(display->cfg.gpio_bl, GPIO_OUT);
+    gpio_put(display->cfg.gpio_rst, 1);
+
+    display->init_step = 0;
+    display->init_until = time_us_32() + 100 * 1000;
+}
+
+#define ST7789_INIT_DONE 3
+
+bool st7789_display_init_poll(struct st7789_display* display)
+{
+    while (display->init_step != ST7789_INIT_DONE) {
+        if ((int32_t)(time_us_32() - display->init_until) < 0) {
+            return false;
+        }
+
+        uint32_t wait_ms = 0;
+        switch (display->init_step++) {
+        case 0:
+            // SWRESET (01h): Software Reset
+            st7789_cmd(display, 0x01, NULL, 0);
+            wait_ms = 150;
+            break;
+
+        case 1:
+            // SLPOUT (11h): Sleep Out
+            st7789_cmd(display, 0x11, NULL, 0);
+            wait_ms = 50;
+            break;
+
+        case 2:
+            // The commands below need no wait after them
+
+            // COLMOD (3Ah): Interface Pixel Format
+            // - RGB interface color format     = 65K of RGB interface
+            // - Control interface color format = 16bit/pixel
+            st7789_cmd(display, 0x3a, (uint8_t[]){ 0x55 }, 1);
+
+            // MADCTL (36h): Memory Data Access Control
+            // - Page Address Order            = Top to Bottom
+            // - Column Address Order          = Left to Right
+            // - Page/Column Order             = Normal Mode
+            // - Line Address Order            = LCD Refresh Top to Bottom
+            // - RGB/BGR Order                 = RGB
+            // - Display Data Latch Data Order = LCD Refresh Left to Right
+            st7789_cmd(display, 0x36, (uint8_t[]){ 0xC0 }, 1);
+
+            st7789_caset(display, 0, display->width - 1);
+            st7789_raset(display, 0, display->height - 1);
+
+            // NORON (13h): Normal Display Mode On
+            st7789_cmd(display, 0x13, NULL, 0);
+
+            // DISPON (29h): Display On
+            st7789_cmd(display, 0x29, NULL, 0);
+            st7789_flush(display);
+            break;
+        }
+
+        if (wait_ms) {
+            st7789_display_wait(display);
+            display->init_until = time_us_32() + wait_ms * 1000;
+        }
+    }
+    return true;
+}
+
+void st7789_display_init(struct st7789_display* display, const struct st7789_config* config, uint16_t width, uint16_t height)
+{
+    st7789_display_init_begin(display, config, width, height);
+    while (!st7789_display_init_poll(display)) {
+        sleep_us(100);
+    }
+    st7789_display_wait(display);
+
+    gpio_put(display->cfg.gpio_bl, 1);
 }
 
 void st7789_init(const struct st7789_config* config, uint16_t width, uint16_t height)
 {
-    memcpy(&st7789_cfg, config, sizeof(st7789_cfg));
-    st7789_width = width;
-    st7789_height = height;
+    st7789_display_init(&st7789_default, config, width, height);
+    st7789_split_screen(&st7789_default, 0, NULL, 0, width);
+}
 
-    spi_init(st7789_cfg.spi, 60 * 1000 * 1000);  // Match Python baudrate
-    if (st7789_cfg.gpio_cs > -1) {
-        spi_set_format(st7789_cfg.spi, 8, SPI_CPOL_0, SPI_CPHA_0, SPI_MSB_FIRST);
-    } else {
-        spi_set_format(st7789_cfg.spi, 8, SPI_CPOL_1, SPI_CPHA_1, SPI_MSB_FIRST);
+void st7789_init_begin(const struct st7789_config* config, uint16_t width, uint16_t height)
+{
+    st7789_display_init_begin(&st7789_default, config, width, height);
+    st7789_split_screen(&st7789_default, 0, NULL, 0, width);
+}
+
+bool st7789_init_poll(void)
+{
+    return st7789_display_init_poll(&st7789_default);
+}
+
+struct st7789_display* st7789_default_display(void)
+{
+    return &st7789_default;
+}
+
+void st7789_split_screen(struct st7789_display* left, uint16_t left_x,
+                         struct st7789_display* right, uint16_t right_x, uint16_t split_x)
+{
+    for (int i = 0; i < st7789_part_count; i++) {
+        st7789_display_wait(st7789_parts[i].display);
+    }
+    st7789_width = left->width;
+    st7789_height = left->height;
+    st7789_parts[0] = (struct st7789_screen_part){ left, 0, right ? split_x : st7789_width, left_x, false };
+    st7789_part_count = 1;
+    if (right) {
+        st7789_parts[1] = (struct st7789_screen_part){ right, split_x, st7789_width, right_x, false };
+        st7789_part_count = 2;
     }
+}
 
-    gpio_set_function(st7789_cfg.gpio_din, GPIO_FUNC_SPI);
-    gpio_set_function(st7789_cfg.gpio_clk, GPIO_FUNC_SPI);
+void ST7789_FUNC(st7789_display_set_window)(struct st7789_display* display, uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1)
+{
+    st7789_caset(display, x0, x1);
+    st7789_raset(display, y0, y1);
+}
 
-    if (st7789_cfg.gpio_cs > -1) {
-        gpio_init(st7789_cfg.gpio_cs);
+void ST7789_FUNC(st7789_display_write)(struct st7789_display* display, const void* data, size_t len)
+{
+    st7789_display_write_async(display, data, len);
+    st7789_display_wait(display);
+}
+
+static void ST7789_FUNC(st7789_screen_window)(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1)
+{
+    win_x0 = x0;
+    win_x1 = x1;
+    win_y0 = y0;
+    win_y1 = y1;
+    cur_x = x0;
+    cur_y = y0;
+
+    // Each panel gets the part of the window in its columns
+    for (int i = 0; i < st7789_part_count; i++) {
+        struct st7789_screen_part* part = &st7789_parts[i];
+        uint16_t px0 = x0 > part->x0 ? x0 : part->x0;
+        uint16_t px1 = x1 + 1 < part->x1 ? x1 + 1 : part->x1;
+        part->in_window = px0 < px1;
+        if (part->in_window) {
+            st7789_display_set_window(part->display, px0 - part->x0 + part->panel_x, y0,
+                                      px1 - 1 - part->x0 + part->panel_x, y1);
+        }
     }
-    gpio_init(st7789_cfg.gpio_dc);
-    gpio_init(st7789_cfg.gpio_rst);
-    gpio_init(st7789_cfg.gpio_bl);
+}
 
-    if (st7789_cfg.gpio_cs > -1) {
-        gpio_set_dir(st7789_cfg.gpio_cs, GPIO_OUT);
+static struct st7789_screen_part* ST7789_FUNC(st7789_part_at)(uint16_t x)
+{
+    for (int i = 0; i < st7789_part_count; i++) {
+        if (x < st7789_parts[i].x1) {
+            return &st7789_parts[i];
+        }
     }
-    gpio_set_dir(st7789_cfg.gpio_dc, GPIO_OUT);
-    gpio_set_dir(st7789_cfg.gpio_rst, GPIO_OUT);
-    gpio_set_dir(st7789_cfg.gpio_bl, GPIO_OUT);
+    return &st7789_parts[st7789_part_count - 1];
+}
+
+// Pixels up to the end of the window line or of the part under the write position
+static size_t ST7789_FUNC(st7789_segment)(size_t count, struct st7789_screen_part** part)
+{
+    *part = st7789_part_at(cur_x);
+    uint16_t end = (*part)->x1 < win_x1 + 1 ? (*part)->x1 : win_x1 + 1;
+    size_t segment = end - cur_x;
+    return count < segment ? count : segment;
+}
+
+static void ST7789_FUNC(st7789_advance)(size_t count)
+{
+    size_t line_width = win_x1 - win_x0 + 1;
+    size_t offset = cur_x - win_x0 + count;
+    cur_x = win_x0 + offset % line_width;
+    cur_y += offset / line_width;
+}
 
-    if (st7789_cfg.gpio_cs > -1) {
-        gpio_put(st7789_cfg.gpio_cs, 1);
+static void ST7789_FUNC(st7789_wait_all)(void)
+{
+    for (int i = 0; i < st7789_part_count; i++) {
+        st7789_display_wait(st7789_parts[i].display);
     }
-    gpio_put(st7789_cfg.gpio_dc, 1);
-    gpio_put(st7789_cfg.gpio_rst, 1);
-    sleep_ms(100);
-    
-    // SWRESET (01h): Software Reset
-    st7789_cmd(0x01, NULL, 0);
-    sleep_ms(150);
+}
 
-    // SLPOUT (11h): Sleep Out
-    st7789_cmd(0x11, NULL, 0);
-    sleep_ms(50);
+static void ST7789_FUNC(st7789_screen_write)(const void* data, size_t len)
+{
+    const uint16_t* pixels = data;
+    size_t count = len / 2;
 
-    // COLMOD (3Ah): Interface Pixel Format
-    // - RGB interface color format     = 65K of RGB interface
-    // - Control interface color format = 16bit/pixel
-    st7789_cmd(0x3a, (uint8_t[]){ 0x55 }, 1);
-    sleep_ms(10);
+    if (st7789_part_count == 1) {
+        st7789_display_write(st7789_parts[0].display, data, len);
+        st7789_advance(count);
+        return;
+    }
 
-    // MADCTL (36h): Memory Data Access Control
-    // - Page Address Order            = Top to Bottom
-    // - Column Address Order          = Left to Right
-    // - Page/Column Order             = Normal Mode
-    // - Line Address Order            = LCD Refresh Top to Bottom
-    // - RGB/BGR Order                 = RGB
-    // - Display Data Latch Data Order = LCD Refresh Left to Right
-    st7789_cmd(0x36, (uint8_t[]){ 0xC0 }, 1);
-   
-    st7789_caset(0, width - 1);
-    st7789_raset(0, height - 1);
+    // Segments of different panels stream at the same time; the caller may
+    // reuse the buffer once this returns
+    while (count) {
+        struct st7789_screen_part* part;
+        size_t segment = st7789_segment(count, &part);
+        st7789_display_write_async(part->display, pixels, segment * 2);
+        pixels += segment;
+        count -= segment;
+        st7789_advance(segment);
+    }
+    st7789_wait_all();
+}
 
-    // NORON (13h): Normal Display Mode On
-    st7789_cmd(0x13, NULL, 0);
-    sleep_ms(10);
+static void ST7789_FUNC(st7789_screen_fill)(uint16_t pixel, size_t count)
+{
+    uint16_t line_width = win_x1 - win_x0 + 1;
 
-    // DISPON (29h): Display On
-    st7789_cmd(0x29, NULL, 0);
-    sleep_ms(10);
+    while (count) {
+        // Whole window lines: each panel fills its share in one transfer
+        if (cur_x == win_x0 && count >= line_width) {
+            size_t lines = count / line_width;
+            for (int i = 0; i < st7789_part_count; i++) {
+                struct st7789_screen_part* part = &st7789_parts[i];
+                if (part->in_window) {
+                    uint16_t px0 = win_x0 > part->x0 ? win_x0 : part->x0;
+                    uint16_t px1 = win_x1 + 1 < part->x1 ? win_x1 + 1 : part->x1;
+                    st7789_display_fill_async(part->display, pixel, lines * (px1 - px0));
+                }
+            }
+            count -= lines * line_width;
+            st7789_advance(lines * line_width);
+            continue;
+        }
 
-    gpio_put(st7789_cfg.gpio_bl, 1);
+        struct st7789_screen_part* part;
+        size_t segment = st7789_segment(count, &part);
+        st7789_display_fill_async(part->display, pixel, segment);
+        count -= segment;
+        st7789_advance(segment);
+    }
+    st7789_wait_all();
 }
 
-void st7789_ramwr()
+// Draw lists: recorded window/fill/blit ops executed in the background. Each
+// fill or blit step starts DMA on every panel of the window; the DMA interrupt
+// of the last panel to finish runs the next step. Blits are control-block
+// chains, so a band of lines costs one interrupt.
+
+static struct st7789_draw_list* volatile exec_list = NULL;
+static struct st7789_draw_list* volatile exec_next = NULL;
+static uint16_t exec_op = 0;
+static uint16_t exec_line = 0;
+static volatile int exec_pending = 0;
+static bool exec_irq_added = false;
+
+static void ST7789_FUNC(st7789_part_span)(const struct st7789_screen_part* part, uint16_t* px0, uint16_t* px1)
 {
-    sleep_us(1);
-    if (st7789_cfg.gpio_cs > -1) {
-        gpio_put(st7789_cfg.gpio_cs, 0);
+    *px0 = win_x0 > part->x0 ? win_x0 : part->x0;
+    *px1 = win_x1 + 1 < part->x1 ? win_x1 + 1 : part->x1;
+}
+
+// Lines of `width` pixels `stride` apart through the control channel. Blocks
+// are {count, read address} written to the data channel's alias 3 (transfer
+// count, read address + trigger); a null block ends the chain and raises the
+// channel interrupt (IRQ_QUIET).
+static void ST7789_FUNC(st7789_chain_start)(struct st7789_display* display, const uint16_t* data,
+                                            uint16_t width, uint16_t lines, uint16_t stride)
+{
+    uint32_t* block = display->chain;
+#if ST7789_BACKEND_PIO
+    // Queued commands (the window) go out first, then a RAMWR/RAMWRC header per run
+    dma_channel_wait_for_finish_blocking(display->list_channel);
+    if (display->list_len) {
+        *block++ = display->list_len;
+        *block++ = (uint32_t)(uintptr_t)display->list;
+        display->list_len = 0;
     }
-    gpio_put(st7789_cfg.gpio_dc, 0);
-    sleep_us(1);
+    uint16_t* header = display->chain_headers;
+#else
+    st7789_data_mode(display);
+#endif
 
-    // RAMWR (2Ch): Memory Write
-    uint8_t cmd = 0x2c;
-    spi_write_blocking(st7789_cfg.spi, &cmd, sizeof(cmd));
+    bool contiguous = stride == width;
+    uint16_t runs = contiguous ? 1 : lines;
+    uint32_t run_pixels = contiguous ? (uint32_t)width * lines : width;
+    for (uint16_t run = 0; run < runs; run++) {
+        const uint16_t* src = data + (size_t)run * stride;
+        uint32_t left = run_pixels;
+        while (left) {
+#if ST7789_BACKEND_PIO
+            uint32_t piece = left < ST7789_PIO_MAX_RUN ? left : ST7789_PIO_MAX_RUN;
+            header[0] = (display->data_mode ? 0x3c : 0x2c) << 8;
+            header[1] = piece * 16;
+            display->data_mode = true;
+            *block++ = 2;
+            *block++ = (uint32_t)(uintptr_t)header;
+            header += 2;
+#else
+            uint32_t piece = left;
+#endif
+            *block++ = piece;
+            *block++ = (uint32_t)(uintptr_t)src;
+            src += piece;
+            left -= piece;
+        }
+    }
+    *block++ = 0;
+    *block++ = 0;
 
-    sleep_us(1);
-    if (st7789_cfg.gpio_cs > -1) {
-        gpio_put(st7789_cfg.gpio_cs, 0);
+    dma_channel_config c = dma_get_channel_config(display->dma_channel);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_chain_to(&c, display->ctrl_channel);
+    channel_config_set_irq_quiet(&c, true);
+    dma_channel_set_config(display->dma_channel, &c, false);
+
+    c = dma_channel_get_default_config(display->ctrl_channel);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_ring(&c, true, 3);
+    dma_channel_configure(display->ctrl_channel, &c, &dma_hw->ch[display->dma_channel].al3_transfer_count,
+                          display->chain, 2, true);
+}
+
+static void ST7789_FUNC(st7789_chain_end)(struct st7789_display* display)
+{
+    dma_channel_config c = dma_get_channel_config(display->dma_channel);
+    channel_config_set_chain_to(&c, display->dma_channel);
+    channel_config_set_irq_quiet(&c, false);
+    dma_channel_set_config(display->dma_channel, &c, false);
+}
+
+static void ST7789_FUNC(st7789_exec_irqs)(bool on)
+{
+    for (int i = 0; i < st7789_part_count; i++) {
+        dma_channel_set_irq1_enabled(st7789_parts[i].display->dma_channel, on);
+    }
+}
+
+static void ST7789_FUNC(st7789_exec_step)(void)
+{
+    while (exec_list) {
+        struct st7789_draw_list* list = exec_list;
+        if (exec_op == list->op_count) {
+            list->in_flight = false;
+            exec_list = exec_next;
+            exec_next = NULL;
+            exec_op = 0;
+            exec_line = 0;
+            continue;
+        }
+
+        const struct st7789_op* op = &list->ops[exec_op];
+        if (op->type == ST7789_OP_WINDOW) {
+            st7789_screen_window(op->x0, op->y0, op->x1, op->y1);
+            exec_op++;
+            continue;
+        }
+
+        uint16_t lines = op->lines - exec_line;
+        if (op->type == ST7789_OP_FILL) {
+            // A fill is one run per panel: keep it within the backend's run limit
+            uint32_t per_step = ST7789_MAX_RUN / (win_x1 - win_x0 + 1);
+            if (per_step == 0) {
+                per_step = 1;
+            }
+            if (lines > per_step) {
+                lines = per_step;
+            }
+        }
+
+        int parts = 0;
+        for (int i = 0; i < st7789_part_count; i++) {
+            parts += st7789_parts[i].in_window;
+        }
+        exec_pending = parts;
+        for (int i = 0; i < st7789_part_count; i++) {
+            struct st7789_screen_part* part = &st7789_parts[i];
+            if (!part->in_window) {
+                continue;
+            }
+            uint16_t px0, px1;
+            st7789_part_span(part, &px0, &px1);
+            if (op->type == ST7789_OP_FILL) {
+                st7789_display_fill_async(part->display, op->pixel, (size_t)lines * (px1 - px0));
+            } else {
+                const uint16_t* data = op->data + (size_t)exec_line * op->stride + (px0 - win_x0);
+                st7789_chain_start(part->display, data, px1 - px0, lines, op->stride);
+            }
+        }
+        exec_line += lines;
+        if (exec_line == op->lines) {
+            exec_op++;
+            exec_line = 0;
+        }
+        if (parts) {
+            return;
+        }
+    }
+    st7789_exec_irqs(false);
+}
+
+static void ST7789_FUNC(st7789_dma_irq)(void)
+{
+    for (int i = 0; i < st7789_part_count; i++) {
+        struct st7789_display* display = st7789_parts[i].display;
+        uint32_t mask = 1u << display->dma_channel;
+        if (!(dma_hw->ints1 & mask)) {
+            continue;
+        }
+        dma_hw->ints1 = mask;
+        st7789_chain_end(display);
+        if (--exec_pending == 0) {
+            st7789_exec_step();
+        }
     }
-    gpio_put(st7789_cfg.gpio_dc, 1);
-    sleep_us(1);
 }
 
-void st7789_write(const void* data, size_t len)
+// Background execution needs a DMA and a control channel on every panel
+static bool st7789_exec_ready(void)
 {
-    if (!st7789_data_mode) {
-        st7789_ramwr();
+    for (int i = 0; i < st7789_part_count; i++) {
+        if (st7789_parts[i].display->ctrl_channel < 0) {
+            return false;
+        }
+    }
+    if (!exec_irq_added) {
+        irq_add_shared_handler(DMA_IRQ_1, st7789_dma_irq, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+        irq_set_enabled(DMA_IRQ_1, true);
+        exec_irq_added = true;
+    }
+    return true;
+}
 
-        if (st7789_cfg.gpio_cs > -1) {
-            spi_set_format(st7789_cfg.spi, 16, SPI_CPOL_0, SPI_CPHA_0, SPI_MSB_FIRST);
+// Without free channels a list is written in place
+static void st7789_draw_list_run(struct st7789_draw_list* list)
+{
+    for (uint16_t i = 0; i < list->op_count; i++) {
+        const struct st7789_op* op = &list->ops[i];
+        uint16_t width = win_x1 - win_x0 + 1;
+        if (op->type == ST7789_OP_WINDOW) {
+            st7789_screen_window(op->x0, op->y0, op->x1, op->y1);
+        } else if (op->type == ST7789_OP_FILL) {
+            st7789_screen_fill(op->pixel, (size_t)width * op->lines);
         } else {
-            spi_set_format(st7789_cfg.spi, 16, SPI_CPOL_1, SPI_CPHA_1, SPI_MSB_FIRST);
+            for (uint16_t line = 0; line < op->lines; line++) {
+                st7789_screen_write(op->data + (size_t)line * op->stride, width * sizeof(uint16_t));
+            }
         }
+    }
+}
 
-        st7789_data_mode = true;
+void ST7789_FUNC(st7789_draw_list_reset)(struct st7789_draw_list* list)
+{
+    list->op_count = 0;
+    list->pixel_count = 0;
+    list->width = 0;
+}
+
+static struct st7789_op* ST7789_FUNC(st7789_draw_list_op)(struct st7789_draw_list* list, uint8_t type)
+{
+    if (list->op_count == ST7789_DRAW_LIST_OPS) {
+        return NULL;
     }
+    struct st7789_op* op = &list->ops[list->op_count++];
+    op->type = type;
+    return op;
+}
 
-    spi_write16_blocking(st7789_cfg.spi, data, len / 2);
+bool ST7789_FUNC(st7789_draw_list_window)(struct st7789_draw_list* list, uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1)
+{
+    struct st7789_op* op = st7789_draw_list_op(list, ST7789_OP_WINDOW);
+    if (!op) {
+        return false;
+    }
+    op->x0 = x0;
+    op->y0 = y0;
+    op->x1 = x1;
+    op->y1 = y1;
+    list->width = x1 - x0 + 1;
+    return true;
 }
 
-void st7789_put(uint16_t pixel)
+bool ST7789_FUNC(st7789_draw_list_fill)(struct st7789_draw_list* list, uint16_t pixel, uint16_t lines)
 {
-    st7789_write(&pixel, sizeof(pixel));
+    struct st7789_op* op = st7789_draw_list_op(list, ST7789_OP_FILL);
+    if (!op) {
+        return false;
+    }
+    op->pixel = pixel;
+    op->lines = lines;
+    return true;
 }
 
-void st7789_fill(uint16_t pixel)
+uint16_t* ST7789_FUNC(st7789_draw_list_line)(struct st7789_draw_list* list, uint16_t repeat)
+{
+    if (list->pixel_count + list->width > ST7789_DRAW_LIST_PIXELS || repeat > ST7789_DRAW_LIST_MAX_LINES) {
+        return NULL;
+    }
+    uint16_t* line = &list->pixels[list->pixel_count];
+
+    // The next line of a band continues the last blit
+    struct st7789_op* last = list->op_count ? &list->ops[list->op_count - 1] : NULL;
+    if (repeat == 1 && last && last->type == ST7789_OP_BLIT && last->stride == list->width
+        && last->lines < ST7789_DRAW_LIST_MAX_LINES && last->data + (size_t)last->lines * last->stride == line) {
+        last->lines++;
+    } else {
+        struct st7789_op* op = st7789_draw_list_op(list, ST7789_OP_BLIT);
+        if (!op) {
+            return NULL;
+        }
+        op->data = line;
+        op->lines = repeat;
+        op->stride = repeat == 1 ? list->width : 0;
+    }
+    list->pixel_count += list->width;
+    return line;
+}
+
+bool ST7789_FUNC(st7789_draw_list_blit)(struct st7789_draw_list* list, const uint16_t* data, uint16_t lines, uint16_t stride)
+{
+    if (lines > ST7789_DRAW_LIST_MAX_LINES) {
+        return false;
+    }
+    struct st7789_op* op = st7789_draw_list_op(list, ST7789_OP_BLIT);
+    if (!op) {
+        return false;
+    }
+    op->data = data;
+    op->lines = lines;
+    op->stride = stride;
+    return true;
+}
+
+void ST7789_FUNC(st7789_draw_list_submit)(struct st7789_draw_list* list)
+{
+    if (list->op_count == 0) {
+        return;
+    }
+    if (!st7789_exec_ready()) {
+        st7789_draw_list_run(list);
+        return;
+    }
+
+    // One list going out and one queued behind it
+    while (exec_next) {
+        tight_loop_contents();
+    }
+    list->in_flight = true;
+    irq_set_enabled(DMA_IRQ_1, false);
+    if (exec_list) {
+        exec_next = list;
+    } else {
+        exec_list = list;
+        exec_op = 0;
+        exec_line = 0;
+        st7789_exec_irqs(true);
+        st7789_exec_step();
+    }
+    irq_set_enabled(DMA_IRQ_1, true);
+}
+
+bool ST7789_FUNC(st7789_draw_list_busy)(const struct st7789_draw_list* list)
 {
-    int num_pixels = st7789_width * st7789_height;
+    return list->in_flight;
+}
 
-    st7789_set_cursor(0, 0);
+void ST7789_FUNC(st7789_draw_list_fence)(const struct st7789_draw_list* list)
+{
+    while (list->in_flight) {
+        tight_loop_contents();
+    }
+}
 
-    for (int i = 0; i < num_pixels; i++) {
-        st7789_put(pixel);
+void ST7789_FUNC(st7789_draw_list_sync)(void)
+{
+    while (exec_list) {
+        tight_loop_contents();
     }
 }
 
+// Immediate drawing waits for submitted lists, so it always lands after them
+void ST7789_FUNC(st7789_set_window)(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1)
+{
+    st7789_draw_list_sync();
+    st7789_screen_window(x0, y0, x1, y1);
+}
+
+void ST7789_FUNC(st7789_write)(const void* data, size_t len)
+{
+    st7789_draw_list_sync();
+    st7789_screen_write(data, len);
+}
+
+void ST7789_FUNC(st7789_fill_pixels)(uint16_t pixel, size_t count)
+{
+    st7789_draw_list_sync();
+    st7789_screen_fill(pixel, count);
+}
+
+void ST7789_FUNC(st7789_put)(uint16_t pixel)
+{
+    st7789_write(&pixel, sizeof(pixel));
+}
+
+void st7789_fill(uint16_t pixel)
+{
+    st7789_set_window(0, 0, st7789_width - 1, st7789_height - 1);
+    st7789_fill_pixels(pixel, (size_t)st7789_width * st7789_height);
+}
+
 void st7789_set_cursor(uint16_t x, uint16_t y)
 {
-    st7789_caset(x, st7789_width - 1);
-    st7789_raset(y, st7789_height - 1);
+    st7789_set_window(x, y, st7789_width - 1, st7789_height - 1);
 }
 
 void st7789_vertical_scroll(uint16_t row)
@@ -218,5 +1023,68 @@ void st7789_vertical_scroll(uint16_t row)
     };
 
     // VSCSAD (37h): Vertical Scroll Start Address of RAM 
-    st7789_cmd(0x37, data, sizeof(data));
+    st7789_screen_cmd(0x37, data, sizeof(data));
+}
+
+void st7789_vertical_scroll_area(uint16_t top_fixed, uint16_t scroll_height, uint16_t bottom_fixed)
+{
+    uint8_t data[] = {
+        (top_fixed >> 8) & 0xff,
+        top_fixed & 0x00ff,
+        (scroll_height >> 8) & 0xff,
+        scroll_height & 0x00ff,
+        (bottom_fixed >> 8) & 0xff,
+        bottom_fixed & 0x00ff
+    };
+
+    // VSCRDEF (33h): Vertical Scrolling Definition, in frame memory lines
+    st7789_screen_cmd(0x33, data, sizeof(data));
+}
+
+void st7789_invert(bool on)
+{
+    // INVON (21h) / INVOFF (20h): Display Inversion On / Off
+    st7789_screen_cmd(on ? 0x21 : 0x20, NULL, 0);
+}
+
+void st7789_idle_mode(bool on)
+{
+    // IDMON (39h) / IDMOFF (38h): Idle Mode On / Off, 8 colours
+    st7789_screen_cmd(on ? 0x39 : 0x38, NULL, 0);
+}
+
+void st7789_partial_area(uint16_t start_row, uint16_t end_row)
+{
+    uint8_t data[] = {
+        (start_row >> 8) & 0xff,
+        start_row & 0x00ff,
+        (end_row >> 8) & 0xff,
+        end_row & 0x00ff
+    };
+
+    // PTLAR (30h): Partial Area, in frame memory lines
+    st7789_screen_cmd(0x30, data, sizeof(data));
+}
+
+void st7789_partial_mode(bool on)
+{
+    // PTLON (12h) / NORON (13h): Partial Display Mode On / Normal Display Mode On.
+    // Both also leave vertical scroll mode.
+    st7789_screen_cmd(on ? 0x12 : 0x13, NULL, 0);
+}
+
+void st7789_madctl(uint8_t value)
+{
+    // MADCTL (36h): Memory Data Access Control
+    st7789_screen_cmd(0x36, &value, 1);
+}
+
+void st7789_tearing_effect(bool on)
+{
+    // TEON (35h), mode 0: TE output high during vertical blanking / TEOFF (34h)
+    if (on) {
+        st7789_screen_cmd(0x35, (uint8_t[]){ 0x00 }, 1);
+    } else {
+        st7789_screen_cmd(0x34, NULL, 0);
+    }
 }
@@ -0,0 +1,37 @@
+#include "boot_time.h"
+#include "pico/stdlib.h"
+#include <stdio.h>
+
+static const int BOOT_MAX_PHASES = 16;
+
+static struct {
+    const char* name;
+    uint32_t at_us;
+} phases[BOOT_MAX_PHASES];
+static int phase_count = 0;
+
+void boot_phase(const char* name) {
+    if (phase_count == BOOT_MAX_PHASES) {
+        return;
+    }
+    // Таймер считает с момента сброса
+    phases[phase_count].name = name;
+    phases[phase_count].at_us = time_us_32();
+    phase_count++;
+}
+
+uint32_t boot_time_us() {
+    return phase_count ? phases[phase_count - 1].at_us : 0;
+}
+
+void boot_report() {
+    uint32_t total = boot_time_us();
+    printf("{\"boot_us\": %lu, \"phases\": [", (unsigned long)total);
+    uint32_t previous = 0;
+    for (int i = 0; i < phase_count; i++) {
+        printf("%s{\"phase\": \"%s\", \"at_us\": %lu, \"us\": %lu}", i ? ", " : "", phases[i].name,
+               (unsigned long)phases[i].at_us, (unsigned long)(phases[i].at_us - previous));
+        previous = phases[i].at_us;
+    }
+    printf("]}\n");
+}
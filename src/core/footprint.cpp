@@ -0,0 +1,39 @@
+#include "footprint.h"
+#include "boot_time.h"
+#include "pico/stdlib.h"
+#include "hardware/regs/addressmap.h"
+#include <stdio.h>
+#include <unistd.h>
+
+// Границы из компоновщика: конец образа во флеше и конец .bss (начало кучи)
+extern char __flash_binary_end;
+extern char end;
+
+static bool heap_locked = false;
+
+#if ROBOT_STATIC_ALLOC
+// malloc из newlib берёт этот замок на каждом выделении и освобождении,
+// так что здесь ловится любое обращение к куче, включая operator new
+extern "C" void __malloc_lock(struct _reent*) {
+    if (heap_locked) {
+        panic("heap used after init");
+    }
+}
+
+extern "C" void __malloc_unlock(struct _reent*) {
+}
+#endif
+
+void footprint_lock_heap() {
+    heap_locked = true;
+    printf("[FOOTPRINT] Heap locked, %lu bytes used during init\n",
+           (unsigned long)((char*)sbrk(0) - &end));
+}
+
+void footprint_report() {
+    printf("{\"flash\": %lu, \"static_ram\": %lu, \"heap\": %lu, \"heap_locked\": %s, \"boot_us\": %lu}\n",
+           (unsigned long)((uintptr_t)&__flash_binary_end - XIP_BASE),
+           (unsigned long)((uintptr_t)&end - SRAM_BASE),
+           (unsigned long)((char*)sbrk(0) - &end),
+           heap_locked ? "true" : "false", (unsigned long)boot_time_us());
+}
@@ -0,0 +1,207 @@
+#include "heap_prof.h"
+#include <stdio.h>
+#include <string.h>
+
+#if ROBOT_HEAP_PROF
+
+struct HeapTagStats {
+    const char* name;
+    uint32_t allocs;
+    uint32_t frees;
+    uint32_t bytes;     // всего выделено
+    uint32_t live;
+    uint32_t peak;
+};
+
+// Живое выделение: по нему free находит размер и тег
+struct HeapSlot {
+    void* ptr;
+    uint32_t size;
+    uint8_t tag;
+};
+
+// Освобождённый слот: поиск идёт дальше, вставка занимает его снова
+static void* const SLOT_DELETED = (void*)1;
+
+static HeapTagStats tags[HEAP_PROF_MAX_TAGS] = {{"untagged", 0, 0, 0, 0, 0}};
+static int tag_count = 1;
+static uint8_t current_tag = 0;
+static HeapSlot slots[HEAP_PROF_SLOTS];
+
+static uint32_t live_bytes = 0;
+static uint32_t peak_bytes = 0;
+static uint32_t alloc_count = 0;
+static uint32_t free_count = 0;
+static uint32_t failed_count = 0;
+static uint32_t untracked_count = 0;  // таблица слотов была полна или free чужого указателя
+
+static uint32_t slot_hash(const void* ptr) {
+    // Блоки выровнены на 8: младшие биты не различают их
+    uintptr_t value = (uintptr_t)ptr >> 3;
+    return (uint32_t)(value * 2654435761u) & (HEAP_PROF_SLOTS - 1);
+}
+
+static HeapSlot* find_slot(const void* ptr) {
+    uint32_t index = slot_hash(ptr);
+    for (int probe = 0; probe < HEAP_PROF_SLOTS; probe++) {
+        HeapSlot& slot = slots[(index + probe) & (HEAP_PROF_SLOTS - 1)];
+        if (slot.ptr == ptr) {
+            return &slot;
+        }
+        if (!slot.ptr) {
+            return nullptr;
+        }
+    }
+    return nullptr;
+}
+
+static HeapSlot* insert_slot(void* ptr) {
+    uint32_t index = slot_hash(ptr);
+    for (int probe = 0; probe < HEAP_PROF_SLOTS; probe++) {
+        HeapSlot& slot = slots[(index + probe) & (HEAP_PROF_SLOTS - 1)];
+        if (!slot.ptr || slot.ptr == SLOT_DELETED) {
+            slot.ptr = ptr;
+            return &slot;
+        }
+    }
+    return nullptr;
+}
+
+void heap_prof_alloc(void* ptr, size_t size) {
+    if (!ptr) {
+        failed_count++;
+        return;
+    }
+    alloc_count++;
+    HeapSlot* slot = insert_slot(ptr);
+    if (!slot) {
+        untracked_count++;
+        return;
+    }
+    slot->size = (uint32_t)size;
+    slot->tag = current_tag;
+
+    HeapTagStats& stats = tags[current_tag];
+    stats.allocs++;
+    stats.bytes += slot->size;
+    stats.live += slot->size;
+    if (stats.live > stats.peak) {
+        stats.peak = stats.live;
+    }
+    live_bytes += slot->size;
+    if (live_bytes > peak_bytes) {
+        peak_bytes = live_bytes;
+    }
+}
+
+void heap_prof_free(void* ptr) {
+    if (!ptr) {
+        return;
+    }
+    free_count++;
+    HeapSlot* slot = find_slot(ptr);
+    if (!slot) {
+        untracked_count++;
+        return;
+    }
+    HeapTagStats& stats = tags[slot->tag];
+    stats.frees++;
+    stats.live -= slot->size;
+    live_bytes -= slot->size;
+    slot->ptr = SLOT_DELETED;
+}
+
+static int find_tag(const char* tag) {
+    for (int i = 0; i < tag_count; i++) {
+        if (tags[i].name == tag || strcmp(tags[i].name, tag) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+uint8_t heap_prof_push_tag(const char* tag) {
+    uint8_t previous = current_tag;
+    int index = find_tag(tag);
+    if (index < 0 && tag_count < HEAP_PROF_MAX_TAGS) {
+        index = tag_count++;
+        tags[index] = {tag, 0, 0, 0, 0, 0};
+    }
+    // Тегов больше, чем мест: выделения идут в untagged
+    current_tag = index < 0 ? 0 : (uint8_t)index;
+    return previous;
+}
+
+void heap_prof_pop_tag(uint8_t previous) {
+    current_tag = previous;
+}
+
+uint32_t heap_prof_live() {
+    return live_bytes;
+}
+
+uint32_t heap_prof_peak() {
+    return peak_bytes;
+}
+
+uint32_t heap_prof_tag_peak(const char* tag) {
+    int index = find_tag(tag);
+    return index < 0 ? 0 : tags[index].peak;
+}
+
+void heap_prof_report() {
+    HeapArena arena = {};
+    heap_prof_arena(arena);
+    // Фрагментация: доля свободного места, которую нельзя получить одним блоком
+    uint32_t fragmentation = arena.free ? 1000 - (uint32_t)((uint64_t)arena.largest * 1000 / arena.free) : 0;
+    printf("{\"heap_live\": %lu, \"heap_peak\": %lu, \"allocs\": %lu, \"frees\": %lu, \"failed\": %lu, "
+           "\"untracked\": %lu, \"arena\": %lu, \"free\": %lu, \"largest_free\": %lu, "
+           "\"fragmentation_permille\": %lu, \"tags\": [",
+           (unsigned long)live_bytes, (unsigned long)peak_bytes, (unsigned long)alloc_count,
+           (unsigned long)free_count, (unsigned long)failed_count, (unsigned long)untracked_count,
+           (unsigned long)arena.size, (unsigned long)arena.free, (unsigned long)arena.largest,
+           (unsigned long)fragmentation);
+    for (int i = 0; i < tag_count; i++) {
+        const HeapTagStats& stats = tags[i];
+        printf("%s{\"tag\": \"%s\", \"allocs\": %lu, \"frees\": %lu, \"bytes\": %lu, \"live\": %lu, \"peak\": %lu}",
+               i ? ", " : "", stats.name, (unsigned long)stats.allocs, (unsigned long)stats.frees,
+               (unsigned long)stats.bytes, (unsigned long)stats.live, (unsigned long)stats.peak);
+    }
+    printf("]}\n");
+}
+
+void heap_prof_reset() {
+    // Живые байты остаются: их освобождение ещё придёт
+    for (int i = 0; i < tag_count; i++) {
+        tags[i].allocs = 0;
+        tags[i].frees = 0;
+        tags[i].bytes = 0;
+        tags[i].peak = tags[i].live;
+    }
+    peak_bytes = live_bytes;
+    alloc_count = 0;
+    free_count = 0;
+    failed_count = 0;
+    untracked_count = 0;
+    printf("[HEAP] Counters reset\n");
+}
+
+#else
+
+// Без ROBOT_HEAP_PROF выделения не перехватываются
+void heap_prof_alloc(void*, size_t) {}
+void heap_prof_free(void*) {}
+uint8_t heap_prof_push_tag(const char*) { return 0; }
+void heap_prof_pop_tag(uint8_t) {}
+uint32_t heap_prof_live() { return 0; }
+uint32_t heap_prof_peak() { return 0; }
+uint32_t heap_prof_tag_peak(const char*) { return 0; }
+
+void heap_prof_report() {
+    printf("{\"heap_prof\": \"off\"}\n");
+}
+
+void heap_prof_reset() {
+}
+
+#endif
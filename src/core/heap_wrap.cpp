@@ -0,0 +1,98 @@
+#include "heap_prof.h"
+
+#if ROBOT_HEAP_PROF
+#include "pico/stdlib.h"
+#include <stdint.h>
+#include <unistd.h>
+
+// Перехват кучи newlib: компоновщик с --wrap=_malloc_r/_free_r/_realloc_r
+// направляет сюда все выделения, включая malloc/calloc из pico_malloc и operator new
+struct _reent;
+
+// Граница стека из компоновщика: до неё куча ещё может вырасти через sbrk
+extern char __StackLimit;
+
+static char* heap_start = nullptr;
+// Внутри realloc newlib сам зовёт malloc и free - их не считаем второй раз
+static bool inside_heap = false;
+
+extern "C" {
+
+void* __real__malloc_r(struct _reent* r, size_t size);
+void __real__free_r(struct _reent* r, void* ptr);
+void* __real__realloc_r(struct _reent* r, void* ptr, size_t size);
+
+void* __wrap__malloc_r(struct _reent* r, size_t size) {
+    if (inside_heap) {
+        return __real__malloc_r(r, size);
+    }
+    if (!heap_start) {
+        // Первый sbrk newlib начнёт отсюда
+        heap_start = (char*)sbrk(0);
+    }
+    inside_heap = true;
+    void* ptr = __real__malloc_r(r, size);
+    inside_heap = false;
+    heap_prof_alloc(ptr, size);
+    return ptr;
+}
+
+void __wrap__free_r(struct _reent* r, void* ptr) {
+    if (!inside_heap) {
+        heap_prof_free(ptr);
+    }
+    __real__free_r(r, ptr);
+}
+
+void* __wrap__realloc_r(struct _reent* r, void* ptr, size_t size) {
+    if (inside_heap) {
+        return __real__realloc_r(r, ptr, size);
+    }
+    inside_heap = true;
+    void* moved = __real__realloc_r(r, ptr, size);
+    inside_heap = false;
+    // Неудачный realloc оставляет старый блок; realloc(p, 0) его освобождает
+    if (moved || size == 0) {
+        heap_prof_free(ptr);
+    }
+    heap_prof_alloc(moved, size);
+    return moved;
+}
+
+}
+
+// Обход блоков кучи newlib (dlmalloc): слово размера лежит по смещению 4,
+// его младший бит - «предыдущий блок занят»; блок свободен, если этот бит
+// сброшен у следующего. Последний блок (top) растёт дальше через sbrk.
+void heap_prof_arena(HeapArena& arena) {
+    arena = {};
+    char* top = (char*)sbrk(0);
+    uint32_t room = (uint32_t)(&__StackLimit - top);
+    if (!heap_start) {
+        arena.free = arena.largest = room;
+        return;
+    }
+    char* chunk = (char*)(((uintptr_t)heap_start + 7) & ~(uintptr_t)7);
+    arena.size = (uint32_t)(top - heap_start);
+    uint32_t top_free = room;
+    while (chunk + 8 <= top) {
+        uint32_t size = ((const uint32_t*)chunk)[1] & ~3u;
+        if (size == 0) {
+            break;
+        }
+        char* next = chunk + size;
+        if (next + 8 > top) {
+            top_free += (uint32_t)(top - chunk);
+            break;
+        }
+        if (!(((const uint32_t*)next)[1] & 1)) {
+            arena.free += size;
+            arena.largest = size > arena.largest ? size : arena.largest;
+        }
+        chunk = next;
+    }
+    arena.free += top_free;
+    arena.largest = top_free > arena.largest ? top_free : arena.largest;
+}
+
+#endif
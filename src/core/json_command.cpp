@@ -0,0 +1,91 @@
+#include "json_command.h"
+#include "trace.h"
+#include "heap_prof.h"
+#include "hot_path.h"
+#include <stdio.h>
+
+// Enhanced JSON parser for commands with debug output.
+// Ключи и значения сжимаются на месте в начало той же строки и завершаются нулём:
+// запись никогда не обгоняет чтение, так что куча не нужна
+JsonFields HOT_FUNC(parse_json)(char* json) {
+    TRACE_SCOPE(TRACE_PARSE_JSON);
+    HEAP_TAG("parse_json");
+    JsonFields result;
+    char* out = json;
+    char* key = nullptr;
+    char* value = nullptr;
+    size_t key_length = 0, value_length = 0;
+    bool in_key = false, in_value = false;
+    bool in_string = false;
+    char quote_char = 0;
+    
+    printf("[JSON_PARSE] Starting parse of: %s\n", json);
+
+    auto add_pair = [&](const char* label) {
+        printf("[JSON_PARSE] %s pair: '%.*s' = '%.*s'\n", label, (int)key_length, key, (int)value_length, value);
+        if (result.count < JSON_MAX_FIELDS) {
+            result.fields[result.count++] = {std::string_view(key, key_length), std::string_view(value, value_length)};
+        } else {
+            printf("[JSON_PARSE] Too many fields, dropping '%.*s'\n", (int)key_length, key);
+        }
+        key_length = 0;
+        value_length = 0;
+    };
+    // Символ дописывается к полю, только если поле лежит в конце вывода
+    auto append = [&](char*& field, size_t& length, char c) {
+        if (length == 0 || field + length != out) {
+            field = out;
+            length = 0;
+        }
+        *out++ = c;
+        length++;
+    };
+    
+    for (char* p = json; *p; ++p) {
+        char c = *p;
+        
+        if (!in_string && (c == '{' || c == '}' || c == ',' || c == ':')) {
+            // Разделитель завершает предыдущее поле
+            *out++ = '\0';
+            if (key_length && value_length) {
+                add_pair("Found");
+            }
+            if (c == ':') {
+                in_value = true;
+                in_key = false;
+                printf("[JSON_PARSE] Switching to value mode, key='%.*s'\n", (int)key_length, key);
+            } else if (c == ',') {
+                in_key = true;
+                in_value = false;
+                printf("[JSON_PARSE] Switching to key mode\n");
+            } else if (c == '{') {
+                in_key = true;
+                printf("[JSON_PARSE] JSON start, entering key mode\n");
+            }
+            continue;
+        }
+
+        if ((c == '"' || c == '\'') && (!in_string || quote_char == c)) {
+            in_string = !in_string;
+            quote_char = in_string ? c : 0;
+            printf("[JSON_PARSE] String mode: %s, quote_char: %c\n", in_string ? "ON" : "OFF", quote_char);
+            continue;
+        }
+
+        if (in_string || (c != ' ' && c != '\t' && c != '\n' && c != '\r')) {
+            if (in_key) {
+                append(key, key_length, c);
+            } else if (in_value) {
+                append(value, value_length, c);
+            }
+        }
+    }
+
+    *out = '\0';
+    if (key_length && value_length) {
+        add_pair("Final");
+    }
+    
+    printf("[JSON_PARSE] Parse complete, found %d pairs\n", result.count);
+    return result;
+}
@@ -1,180 +1,252 @@
 #include <stdio.h>
 #include <stdlib.h>
-#include <iostream>
-#include <string>
-#include <map>
-#include <functional>
+#include <string.h>
 #include <ctime>
+#include <algorithm>
+#include <string_view>
 #include "pico/stdlib.h"
 #include "display_config.h"
 #include "emotions.h"
 #include "states.h"
 #include "colors.h"
+#include "trace.h"
+#include "frame_stats.h"
+#include "color_anim.h"
+#include "eyes.h"
+#include "gaze_stream.h"
+#include "particles.h"
+#include "subtitles.h"
+#include "panel_effects.h"
+#include "backlight.h"
+#include "tear_sync.h"
+#include "display_list.h"
+#include "boot_time.h"
+#include "hot_path.h"
+#include "xip_stats.h"
+#include "fixed_string.h"
+#include "footprint.h"
+#include "heap_prof.h"
+#include "face_clip.h"
+#include "fb_stream.h"
+#include "json_command.h"
 
 // Global display initialization flag
 bool display_initialized = false;
 
 // Global variables similar to Python
-std::string current_emotion = "neutral";
-std::string talking_emotion = "";
+// Имя текущей эмоции указывает в таблицу emotions
+std::string_view current_emotion = "neutral";
+FixedString<16> talking_emotion;
 double current_duration = 65.5;
 double current_intensity = 0.4;
-std::string current_text = "";
+FixedString<3 * SUBTITLE_MAX_CHARS> current_text;
 double current_mouth_speed = 0.5;
 double emotion_timer = 0.0;
 double anim_duration = 5.0;
 double last_emotion_time = 0.0;
 
-// Emotion states
-std::map<std::string, void*> emotion_states;
+// Emotion states: static storage, reset in place on every switch
+static NeutralState neutral_state;
+static TalkingState talking_state;
+static AnimState anim_states[7];
+static AnimState asset_state;
+
+// Загруженный ассет, выбранный командой; его имя указывает в индекс во флеше
+static const FaceAssetEntry* current_asset = nullptr;
 
 // Function to get current time in seconds
 double get_time() {
     return (double)to_ms_since_boot(get_absolute_time()) / 1000.0;
 }
 
+// Переход между эмоциями: новое лицо въезжает сверху аппаратной прокруткой
+// или рисуется при погашенной подсветке
+enum EmotionTransition {
+    TRANSITION_NONE,
+    TRANSITION_SLIDE,
+    TRANSITION_FADE,
+};
+EmotionTransition emotion_transition = TRANSITION_NONE;
+static const uint32_t SLIDE_TRANSITION_MS = 300;
+static const uint32_t FADE_OUT_MS = 60;
+static const uint32_t FADE_IN_MS = 120;
+static const uint32_t WAKE_FADE_MS = 300;
+static const uint32_t SLEEP_FADE_MS = 1500;
+static const uint8_t SLEEP_BRIGHTNESS = 24;
+static bool fading_out = false;
+static bool pending_reveal = false;
+
+static void compose_face_row(int y, uint16_t* out) {
+    main_face_renderer().compose_screen_line(0, DISPLAY_WIDTH, y, out);
+}
+
+static void slide_in_face(int first_row, int rows) {
+    panel_slide_in(compose_face_row, first_row, rows, SLIDE_TRANSITION_MS);
+}
+
 // Reset emotion state
-void reset_emotion_state(const std::string& emotion) {
-    emotion_states[emotion] = reset_state(emotion);
-    emotion_timer = get_time();
-    printf("[DEBUG] Reset state for %s\n", emotion.c_str());
+// Процедурные глаза включаются командой gaze и работают в нейтральной эмоции
+bool procedural_eyes = false;
+
+// Слой глаз: процедурные глаза в neutral, при потоке взгляда - сдвиг клеток глаз любой эмоции
+void update_eye_layer(std::string_view emotion) {
+    if (procedural_eyes && emotion == "neutral") {
+        eyes_enable(EYE_SOURCE_PROCEDURAL);
+    } else if (gaze_stream_active()) {
+        eyes_enable(EYE_SOURCE_FACE_CELLS);
+    } else {
+        eyes_disable();
+    }
 }
 
-// Emotion functions map
-std::map<std::string, std::function<void(double)>> emotions;
-
-// Initialize emotions map
-void init_emotions() {
-    emotions["neutral"] = [](double i) {
-        NeutralState* state = static_cast<NeutralState*>(emotion_states["neutral"]);
-        neutral(0.2 * i, *state);
-    };
-
-    emotions["smile"] = [](double i) {
-        AnimState* state = static_cast<AnimState*>(emotion_states["smile"]);
-        smile_pixel(current_mouth_speed * i, *state, anim_duration);
-    };
-
-    emotions["smile_love"] = [](double i) {
-        AnimState* state = static_cast<AnimState*>(emotion_states["smile_love"]);
-        smile_love_pixel(current_mouth_speed * i, *state, anim_duration);
-    };
-
-    emotions["embarrassed"] = [](double i) {
-        AnimState* state = static_cast<AnimState*>(emotion_states["embarrassed"]);
-        embarrassed_pixel(current_mouth_speed * i, *state);
-    };
-
-    emotions["scary"] = [](double i) {
-        AnimState* state = static_cast<AnimState*>(emotion_states["scary"]);
-        scary_pixel(current_mouth_speed * i, *state, anim_duration);
-    };
-
-    emotions["happy"] = [](double i) {
-        AnimState* state = static_cast<AnimState*>(emotion_states["happy"]);
-        happy_pixel(current_mouth_speed * i, *state, anim_duration);
-    };
-
-    emotions["sad"] = [](double i) {
-        AnimState* state = static_cast<AnimState*>(emotion_states["sad"]);
-        sad_pixel(current_mouth_speed * i, *state, anim_duration);
-    };
-
-    emotions["surprise"] = [](double i) {
-        AnimState* state = static_cast<AnimState*>(emotion_states["surprise"]);
-        surprise_pixel(current_mouth_speed * i, *state, anim_duration);
-    };
-
-    emotions["talking"] = [](double i) {
-        TalkingState* state = static_cast<TalkingState*>(emotion_states["talking"]);
-        std::string emotion = talking_emotion.empty() ? "neutral" : talking_emotion;
+// Emotion table: name, frame function and its state
+struct EmotionEntry {
+    std::string_view name;
+    void (*frame)(double intensity, void* state);
+    void* state;
+};
+
+static const EmotionEntry emotions[] = {
+    {"neutral", [](double i, void* state) {
+        neutral(0.2 * i, *static_cast<NeutralState*>(state));
+    }, &neutral_state},
+    {"smile", [](double i, void* state) {
+        smile_pixel(current_mouth_speed * i, *static_cast<AnimState*>(state), anim_duration);
+    }, &anim_states[0]},
+    {"smile_love", [](double i, void* state) {
+        smile_love_pixel(current_mouth_speed * i, *static_cast<AnimState*>(state), anim_duration);
+    }, &anim_states[1]},
+    {"embarrassed", [](double i, void* state) {
+        embarrassed_pixel(current_mouth_speed * i, *static_cast<AnimState*>(state));
+    }, &anim_states[2]},
+    {"scary", [](double i, void* state) {
+        scary_pixel(current_mouth_speed * i, *static_cast<AnimState*>(state), anim_duration);
+    }, &anim_states[3]},
+    {"happy", [](double i, void* state) {
+        happy_pixel(current_mouth_speed * i, *static_cast<AnimState*>(state), anim_duration);
+    }, &anim_states[4]},
+    {"sad", [](double i, void* state) {
+        sad_pixel(current_mouth_speed * i, *static_cast<AnimState*>(state), anim_duration);
+    }, &anim_states[5]},
+    {"surprise", [](double i, void* state) {
+        surprise_pixel(current_mouth_speed * i, *static_cast<AnimState*>(state), anim_duration);
+    }, &anim_states[6]},
+    {"talking", [](double i, void* state) {
+        std::string_view emotion = talking_emotion.empty() ? std::string_view("neutral") : talking_emotion.view();
         // Передаем правильные параметры: duration в секундах, не в мс
-        talking_pixel((uint32_t)current_duration, current_intensity * i, *state,
+        talking_pixel((uint32_t)current_duration, current_intensity * i, *static_cast<TalkingState*>(state),
                      current_text, current_mouth_speed, emotion);
-    };
-}
-
-// Enhanced JSON parser for commands with debug output
-std::map<std::string, std::string> parse_json(const std::string& json_str) {
-    std::map<std::string, std::string> result;
-    std::string key, value;
-    bool in_key = false, in_value = false;
-    bool in_string = false;
-    char quote_char = 0;
-    
-    printf("[JSON_PARSE] Starting parse of: %s\n", json_str.c_str());
-    
-    for (size_t i = 0; i < json_str.length(); ++i) {
-        char c = json_str[i];
-        
-        if (!in_string && (c == '{' || c == '}' || c == ',' || c == ':')) {
-            if (!key.empty() && !value.empty()) {
-                printf("[JSON_PARSE] Found pair: '%s' = '%s'\n", key.c_str(), value.c_str());
-                result[key] = value;
-                key.clear();
-                value.clear();
-            }
-            if (c == ':') {
-                in_value = true;
-                in_key = false;
-                printf("[JSON_PARSE] Switching to value mode, key='%s'\n", key.c_str());
-            } else if (c == ',') {
-                in_key = true;
-                in_value = false;
-                printf("[JSON_PARSE] Switching to key mode\n");
-            } else if (c == '{') {
-                in_key = true;
-                printf("[JSON_PARSE] JSON start, entering key mode\n");
-            }
-            continue;
+    }, &talking_state},
+};
+
+// Ассеты из флеша играются одной записью; какой ассет - current_asset
+static const EmotionEntry ASSET_EMOTION = {"asset", [](double, void* state) {
+    asset_pixel(current_asset, *static_cast<AnimState*>(state));
+}, &asset_state};
+
+static const EmotionEntry* find_emotion(std::string_view name) {
+    for (const EmotionEntry& entry : emotions) {
+        if (entry.name == name) {
+            return &entry;
         }
+    }
+    // Имя ассета найдено в индексе при разборе команды: сравниваем указатель, без поиска
+    if (current_asset && name.data() == current_asset->name) {
+        return &ASSET_EMOTION;
+    }
+    return nullptr;
+}
 
-        if ((c == '"' || c == '\'') && (!in_string || quote_char == c)) {
-            in_string = !in_string;
-            quote_char = in_string ? c : 0;
-            printf("[JSON_PARSE] String mode: %s, quote_char: %c\n", in_string ? "ON" : "OFF", quote_char);
-            continue;
-        }
+// Кадр эмоции из таблицы (имя всегда из неё)
+static void run_emotion(std::string_view name, double intensity) {
+    const EmotionEntry* entry = find_emotion(name);
+    // Куча каждой эмоции считается под её именем (имена в таблице - литералы)
+    HEAP_TAG(entry->name.data());
+    entry->frame(intensity, entry->state);
+}
 
-        if (in_string) {
-            if (in_key) {
-                key += c;
-            } else if (in_value) {
-                value += c;
-            }
-        } else if (c != ' ' && c != '\t' && c != '\n' && c != '\r') {
-            if (in_key) {
-                key += c;
-            } else if (in_value) {
-                value += c;
-            }
+void reset_emotion_state(std::string_view emotion) {
+    HEAP_TAG("reset_state");
+    const EmotionEntry* entry = find_emotion(emotion);
+    reset_state(entry->name, entry->state);
+    frame_stats_set_emotion(emotion);
+    // Разговор окрашивается по базовой эмоции (например, красный для angry)
+    bool talking_with_emotion = emotion == "talking" && !talking_emotion.empty();
+    std::string_view palette_emotion = talking_with_emotion ? talking_emotion.view() : emotion;
+    color_anim_stop_all();
+    set_palette(palette_for_emotion(palette_emotion));
+    color_anim_start_for_emotion(palette_emotion);
+    particles_start_for_emotion(palette_emotion, current_intensity);
+    subtitles_clear();
+    panel_effects_stop();
+    if (panel_sleeping()) {
+        panel_wake();
+        // При переходе затуханием подсветку вернёт первый нарисованный кадр
+        if (emotion_transition != TRANSITION_FADE) {
+            backlight_restore(WAKE_FADE_MS);
         }
     }
+    panel_effects_start_for_emotion(palette_emotion);
+    // Тряска или прыжок эмоции уже двигают экран - переход без прокрутки
+    if (emotion_transition == TRANSITION_SLIDE && !panel_scroll_busy()) {
+        main_face_renderer().defer_full_draw(slide_in_face);
+    }
+    update_eye_layer(emotion);
+    emotion_timer = get_time();
+    printf("[DEBUG] Reset state for %.*s\n", (int)emotion.size(), emotion.data());
+}
 
-    if (!key.empty() && !value.empty()) {
-        printf("[JSON_PARSE] Final pair: '%s' = '%s'\n", key.c_str(), value.c_str());
-        result[key] = value;
+// Переход затуханием: эмоция меняется, когда подсветка погасла
+static bool transition_ready() {
+    if (emotion_transition != TRANSITION_FADE) {
+        return true;
     }
-    
-    printf("[JSON_PARSE] Parse complete, found %d pairs\n", result.size());
-    return result;
+    if (!fading_out) {
+        backlight_fade_to(0, FADE_OUT_MS);
+        fading_out = true;
+    }
+    return backlight_dark();
 }
 
-// Read command from stdin (non-blocking with improved JSON detection)
-std::string read_command() {
-    static std::string buffer = "";
+// Read command from stdin (non-blocking with improved JSON detection).
+// Returns the command in a static buffer, valid until the next call, or nullptr
+char* read_command() {
+    // Пустой опрос идёт раз в ~1 мс и в трассу не пишется: только когда пришли символы.
+    // Готовая команда без перевода строки возвращается в конце того же вызова,
+    // так что между вызовами ничего не ждёт
+    int result = getchar_timeout_us(1000); // Small timeout to gather chars
+    if (result == PICO_ERROR_TIMEOUT) {
+        return nullptr;
+    }
+    TRACE_SCOPE(TRACE_READ_COMMAND);
+    HEAP_TAG("read_command");
+    static const int COMMAND_MAX = 2048;
+    static char buffer[COMMAND_MAX + 2];
+    static int length = 0;
     static bool in_json = false;
     static int brace_count = 0;
+    static char gaze_line[32];
+    static int gaze_length = -1;  // -1: not inside a "G" line
     
     // Read all available characters
-    while (true) {
-        int result = getchar_timeout_us(1000); // Small timeout to gather chars
-        if (result == PICO_ERROR_TIMEOUT) {
-            break;
-        }
-        
+    for (; result != PICO_ERROR_TIMEOUT; result = getchar_timeout_us(1000)) {
         char c = (char)result;
-        printf("[DEBUG] Char received: %c (0x%02x), buffer_len=%d\n", c, c, buffer.length());
+
+        // Канал взгляда: строки "G x y [seq]" обрабатываются сразу, без JSON и отладочного вывода
+        if (gaze_length < 0 && c == 'G' && length == 0 && !in_json) {
+            gaze_length = 0;
+        }
+        if (gaze_length >= 0) {
+            if (c == '\n') {
+                gaze_line[gaze_length] = '\0';
+                gaze_stream_line(gaze_line, time_us_32());
+                gaze_length = -1;
+            } else if (c != '\r' && gaze_length < (int)sizeof(gaze_line) - 1) {
+                gaze_line[gaze_length++] = c;
+            }
+            continue;
+        }
+        printf("[DEBUG] Char received: %c (0x%02x), buffer_len=%d\n", c, c, length);
         
         // Skip carriage return
         if (c == '\r') {
@@ -183,16 +255,17 @@ std::string read_command() {
         
         // Handle newline
         if (c == '\n') {
-            if (in_json && brace_count == 0 && !buffer.empty()) {
-                printf("[DEBUG] Complete JSON command detected: %s\n", buffer.c_str());
-                std::string cmd = buffer;
-                buffer.clear();
+            if (in_json && brace_count == 0 && length) {
+                buffer[length] = '\0';
+                printf("[DEBUG] Complete JSON command detected: %s\n", buffer);
+                length = 0;
                 in_json = false;
                 brace_count = 0;
-                return cmd;
-            } else if (!buffer.empty()) {
-                printf("[DEBUG] Non-JSON or incomplete command: %s\n", buffer.c_str());
-                buffer.clear();
+                return buffer;
+            } else if (length) {
+                buffer[length] = '\0';
+                printf("[DEBUG] Non-JSON or incomplete command: %s\n", buffer);
+                length = 0;
                 in_json = false;
                 brace_count = 0;
             }
@@ -200,7 +273,7 @@ std::string read_command() {
         }
         
         // Add character to buffer
-        buffer += c;
+        buffer[length++] = c;
         
         // JSON detection logic
         if (c == '{') {
@@ -214,148 +287,409 @@ std::string read_command() {
         } else if (c == '}' && in_json) {
             brace_count--;
             if (brace_count == 0) {
-                printf("[DEBUG] JSON end detected, buffer: %s\n", buffer.c_str());
+                buffer[length] = '\0';
+                printf("[DEBUG] JSON end detected, buffer: %s\n", buffer);
                 // Don't return yet, wait for newline or check if complete
             }
         }
         
         // Safety check - if buffer gets too large, reset
-        if (buffer.length() > 2048) {
+        if (length > COMMAND_MAX) {
             printf("[ERROR] Buffer overflow, resetting\n");
-            buffer.clear();
+            length = 0;
             in_json = false;
             brace_count = 0;
         }
     }
     
     // If we have a complete JSON (braces balanced) and no more chars, return it
-    if (in_json && brace_count == 0 && !buffer.empty()) {
-        printf("[DEBUG] Complete JSON ready: %s\n", buffer.c_str());
-        std::string cmd = buffer;
-        buffer.clear();
+    if (in_json && brace_count == 0 && length) {
+        buffer[length] = '\0';
+        printf("[DEBUG] Complete JSON ready: %s\n", buffer);
+        length = 0;
         in_json = false;
         brace_count = 0;
-        return cmd;
+        return buffer;
     }
     
-    return "";
+    return nullptr;
+}
+
+static int command_int(const JsonFields& command, const char* key,
+                       int fallback, int min_value, int max_value) {
+    const JsonField* field = command.find(key);
+    int value = field ? atoi(field->value.data()) : fallback;
+    return std::max(min_value, std::min(max_value, value));
+}
+
+// Десятичное число без strtod: strtod из newlib выделяет память в куче
+static double parse_decimal(const char* text) {
+    double sign = 1.0;
+    if (*text == '-' || *text == '+') {
+        sign = *text == '-' ? -1.0 : 1.0;
+        text++;
+    }
+    double value = 0.0;
+    while (*text >= '0' && *text <= '9') {
+        value = value * 10.0 + (*text++ - '0');
+    }
+    if (*text == '.') {
+        text++;
+        double scale = 0.1;
+        while (*text >= '0' && *text <= '9') {
+            value += (*text++ - '0') * scale;
+            scale *= 0.1;
+        }
+    }
+    return sign * value;
+}
+
+// Числовое поле команды: true и значение в `value`, если поле есть
+static bool command_double(const JsonFields& command, const char* key, double& value) {
+    const JsonField* field = command.find(key);
+    if (!field) {
+        return false;
+    }
+    value = parse_decimal(field->value.data());
+    return true;
+}
+
+// {"cmd":"gaze","x":-100..100,"y":-100..100,"open":0..100,"size":50..100}, missing fields keep their value
+void handle_gaze_command(const JsonFields& command) {
+    EyeParams params = eyes_get_params();
+    params.gaze_x = command_int(command, "x", params.gaze_x, -100, 100);
+    params.gaze_y = command_int(command, "y", params.gaze_y, -100, 100);
+    params.openness = command_int(command, "open", params.openness, 0, 100);
+    params.size = command_int(command, "size", params.size, 50, 100);
+    eyes_set_params(params);
+
+    procedural_eyes = true;
+    update_eye_layer(current_emotion);
+}
+
+// Service commands: {"cmd": "..."} instead of an emotion
+void handle_service_command(const JsonFields& command) {
+    std::string_view cmd = command.find("cmd")->value;
+    if (cmd == "gaze") {
+        handle_gaze_command(command);
+    } else if (cmd == "eyes_off") {
+        procedural_eyes = false;
+        update_eye_layer(current_emotion);
+    } else if (cmd == "gaze_stats") {
+        gaze_stream_report();
+    } else if (cmd == "gaze_stats_reset") {
+        gaze_stream_reset_stats();
+    } else if (cmd == "trace_dump") {
+        trace_dump();
+    } else if (cmd == "trace_start") {
+        trace_start();
+    } else if (cmd == "trace_stop") {
+        trace_stop();
+    } else if (cmd == "trace_clear") {
+        trace_clear();
+    } else if (cmd == "frame_stats") {
+        frame_stats_report();
+    } else if (cmd == "frame_stats_reset") {
+        frame_stats_reset();
+    } else if (cmd == "cell_style_flat") {
+        set_cell_style(CELL_STYLE_FLAT);
+    } else if (cmd == "cell_style_rounded") {
+        set_cell_style(CELL_STYLE_ROUNDED);
+    } else if (cmd == "bench_geometry") {
+        face_geometry_benchmark();
+    } else if (cmd == "bench_clip") {
+        face_clip_benchmark();
+    } else if (cmd == "subtitles_on") {
+        subtitles_set_enabled(true);
+    } else if (cmd == "subtitles_off") {
+        subtitles_set_enabled(false);
+    } else if (cmd == "transition_slide") {
+        emotion_transition = TRANSITION_SLIDE;
+    } else if (cmd == "transition_fade") {
+        emotion_transition = TRANSITION_FADE;
+    } else if (cmd == "transition_none") {
+        emotion_transition = TRANSITION_NONE;
+    } else if (cmd == "brightness") {
+        backlight_set_brightness(command_int(command, "level", BACKLIGHT_MAX, 0, BACKLIGHT_MAX),
+                                 command_int(command, "ms", 200, 0, 10000));
+    } else if (cmd == "shake") {
+        panel_shake(command_int(command, "px", 6, 0, PANEL_EFFECT_MAX_OFFSET), command_int(command, "ms", 400, 0, 5000));
+    } else if (cmd == "bounce") {
+        panel_bounce(command_int(command, "px", 12, 0, PANEL_EFFECT_MAX_OFFSET), command_int(command, "ms", 600, 0, 5000));
+    } else if (cmd == "invert_flash") {
+        panel_invert_flash(command_int(command, "count", 2, 1, 20), command_int(command, "ms", 160, 20, 2000));
+    } else if (cmd == "sleep") {
+        // Видно только лицо, 8 цветов
+        using Geometry = FaceRenderer<MATRIX_ROWS, MATRIX_COLS>::Geometry;
+        subtitles_clear();
+        panel_sleep(Geometry::Y_OFFSET, Geometry::HEIGHT);
+        backlight_fade_to(std::min(SLEEP_BRIGHTNESS, backlight_brightness()), SLEEP_FADE_MS);
+    } else if (cmd == "wake") {
+        panel_wake();
+        backlight_restore(WAKE_FADE_MS);
+    } else if (cmd == "tear_sync_off") {
+        tear_sync_set_mode(TEAR_SYNC_OFF);
+    } else if (cmd == "tear_sync_te") {
+        tear_sync_set_mode(TEAR_SYNC_TE);
+    } else if (cmd == "tear_sync_scan") {
+        tear_sync_set_mode(TEAR_SYNC_SCAN);
+    } else if (cmd == "tear_calibrate") {
+        tear_sync_calibrate(command_int(command, "shift_us", 0, -100000, 100000),
+                            command_int(command, "frame_us", 0, 0, 100000));
+    } else if (cmd == "tear_stats") {
+        tear_sync_report();
+    } else if (cmd == "tear_stats_reset") {
+        tear_sync_reset_stats();
+    } else if (cmd == "display_list_on") {
+        display_list_set_enabled(true);
+    } else if (cmd == "display_list_off") {
+        display_list_set_enabled(false);
+    } else if (cmd == "display_list_stats") {
+        display_list_report();
+    } else if (cmd == "display_list_stats_reset") {
+        display_list_reset_stats();
+    } else if (cmd == "boot_report") {
+        boot_report();
+    } else if (cmd == "xip_stats") {
+        xip_stats_report();
+    } else if (cmd == "xip_stats_reset") {
+        xip_stats_reset();
+    } else if (cmd == "footprint") {
+        footprint_report();
+    } else if (cmd == "stream_start") {
+        fb_stream_start();
+    } else if (cmd == "stream_stats") {
+        fb_stream_report();
+    } else if (cmd == "asset_face") {
+        if (!command.find("name") || !command.find("cells")
+            || !face_asset_add_face(command.find("name")->value, command.find("cells")->value)) {
+            printf("[ERROR] asset_face needs a name and packed cells in hex\n");
+            return;
+        }
+    } else if (cmd == "asset_anim") {
+        if (!command.find("name") || !command.find("frames")
+            || !face_asset_add_animation(command.find("name")->value, command.find("frames")->value)) {
+            printf("[ERROR] asset_anim needs a name and frames \"face:ms,...\"\n");
+            return;
+        }
+    } else if (cmd == "asset_clip") {
+        if (!command.find("name") || !command.find("data")
+            || !face_asset_add_clip_chunk(command.find("name")->value,
+                                          command_int(command, "offset", 0, 0, FACE_ASSETS_SIZE),
+                                          command_int(command, "size", 0, 0, FACE_ASSETS_SIZE),
+                                          command.find("data")->value)) {
+            printf("[ERROR] asset_clip needs a name, offset, size and clip bytes in hex\n");
+            return;
+        }
+    } else if (cmd == "asset_list") {
+        face_asset_report();
+    } else if (cmd == "asset_erase") {
+        // Показываемый ассет читается из флеша каждый кадр
+        if (current_asset) {
+            printf("[ERROR] Asset '%s' is selected, switch to another emotion first\n", current_asset->name);
+            return;
+        }
+        face_asset_erase();
+    } else if (cmd == "heap_stats") {
+        heap_prof_report();
+    } else if (cmd == "heap_stats_reset") {
+        heap_prof_reset();
+    } else if (cmd == "particle_stats") {
+        particles_report();
+    } else if (cmd == "particle_stats_reset") {
+        particles_reset_stats();
+    } else if (cmd == "bench_particles") {
+        particles_benchmark();
+    } else {
+        printf("[ERROR] Unknown service command '%.*s'\n", (int)cmd.size(), cmd.data());
+        return;
+    }
+    printf("{\"status\": \"ok\", \"cmd\": \"%.*s\"}\n", (int)cmd.size(), cmd.data());
 }
 
 // Main function
 int main() {
     stdio_init_all();
+    boot_phase("stdio");
     printf("[INFO] Starting Interactive Robot (C++ version)...\n");
 
     // Initialize display using structured config
-    init_display();
-    display_initialized = true;
-    printf("[INFO] TFT initialized successfully\n");
+    init_display_begin();
+#if !ROBOT_FAST_BOOT
+    init_display_finish();
+#endif
+    boot_phase("display_init");
+
+    // Быстрый старт: панель ~300 мс ждёт сброса и выхода из сна, а тем временем
+    // готовятся тайлы клеток и состояния эмоций
+    prepare_cell_tiles();
+    init_display_poll();
+    boot_phase("cell_tiles");
 
     // Initialize emotion states
-    std::vector<std::string> emotion_names = {
-        "neutral", "smile", "smile_love", "embarrassed",
-        "scary", "happy", "sad", "surprise", "talking"
-    };
-
-    for (const auto& name : emotion_names) {
-        emotion_states[name] = reset_state(name.c_str());
+    {
+        HEAP_TAG("init");
+        for (const EmotionEntry& entry : emotions) {
+            reset_state(entry.name, entry.state);
+        }
     }
+    subtitles_init();
+    init_display_poll();
+    boot_phase("emotions");
 
-    // Initialize emotions map
-    init_emotions();
+#if ROBOT_FAST_BOOT
+    init_display_finish();
+#endif
+    display_initialized = true;
+    printf("[INFO] TFT initialized successfully\n");
 
     // Set initial emotion
     reset_emotion_state(current_emotion);
     if (display_initialized) {
-        emotions[current_emotion](current_intensity);
+        run_emotion(current_emotion, current_intensity);
     }
+    display_list_fence();
+    boot_phase("first_frame");
+
+#if ROBOT_STATIC_ALLOC
+    // Всё выделено статически: любое обращение к куче дальше - ошибка
+    footprint_lock_heap();
+#endif
 
     printf("Pico started, waiting for JSON commands...\n");
 
     bool new_command_received = false;
+    bool gaze_streaming = false;
     last_emotion_time = get_time();
 
     while (true) {
-            std::string command_json = read_command();
-            if (!command_json.empty()) {
-                printf("[JSON] Raw input: '%s'\n", command_json.c_str());
-                printf("[JSON] Input length: %d\n", command_json.length());
+            // Поток кадров: порт занят пакетами, эмоции стоят до конца потока
+            if (fb_stream_active()) {
+                if (!fb_stream_poll()) {
+                    main_face_renderer().clear_border(get_active_palette().colors[PALETTE_BG]);
+                    main_face_renderer().refresh();
+                    last_emotion_time = get_time();
+                }
+                continue;
+            }
 
-                auto command = parse_json(command_json);
-                printf("[JSON] Parsed %d fields\n", command.size());
+            char* command_json = read_command();
+            if (command_json) {
+                printf("[JSON] Raw input: '%s'\n", command_json);
+                printf("[JSON] Input length: %d\n", (int)strlen(command_json));
 
-                if (command.find("emotion") == command.end()) {
+                JsonFields command = parse_json(command_json);
+                printf("[JSON] Parsed %d fields\n", command.count);
+
+                if (command.find("cmd")) {
+                    handle_service_command(command);
+                    continue;
+                }
+
+                const JsonField* emotion_field = command.find("emotion");
+                if (!emotion_field) {
                     printf("[ERROR] Invalid command structure - missing 'emotion' field\n");
                     printf("[ERROR] Available fields: ");
-                    for (const auto& pair : command) {
-                        printf("'%s'='%s' ", pair.first.c_str(), pair.second.c_str());
+                    for (int i = 0; i < command.count; i++) {
+                        const JsonField& field = command.fields[i];
+                        printf("'%.*s'='%.*s' ", (int)field.key.size(), field.key.data(),
+                               (int)field.value.size(), field.value.data());
                     }
                     printf("\n");
                     continue;
                 }
 
-                std::string new_emotion = command["emotion"];
-                printf("[PARSE] emotion=%s\n", new_emotion.c_str());
+                std::string_view new_emotion = emotion_field->value;
+                printf("[PARSE] emotion=%.*s\n", (int)new_emotion.size(), new_emotion.data());
                 
-                if (command.find("duration") != command.end()) {
-                    current_duration = std::stod(command["duration"]);
+                if (command_double(command, "duration", current_duration)) {
                     printf("[PARSE] duration=%.2f\n", current_duration);
                 }
-                if (command.find("intensity") != command.end()) {
-                    current_intensity = std::stod(command["intensity"]);
+                if (command_double(command, "intensity", current_intensity)) {
                     printf("[PARSE] intensity=%.2f\n", current_intensity);
                 }
-                if (command.find("mouth_speed") != command.end()) {
-                    current_mouth_speed = std::stod(command["mouth_speed"]);
+                if (command_double(command, "mouth_speed", current_mouth_speed)) {
                     printf("[PARSE] mouth_speed=%.2f\n", current_mouth_speed);
                 }
-                if (command.find("text") != command.end()) {
-                    current_text = command["text"];
+                if (const JsonField* text = command.find("text")) {
+                    current_text = text->value;
                     printf("[PARSE] text='%s'\n", current_text.c_str());
                 }
-                if (command.find("anim_duration") != command.end()) {
-                    anim_duration = std::stod(command["anim_duration"]);
+                if (command_double(command, "anim_duration", anim_duration)) {
                     printf("[PARSE] anim_duration=%.2f\n", anim_duration);
                 }
-                if (command.find("talking_emotion") != command.end()) {
-                    talking_emotion = command["talking_emotion"];
+                if (const JsonField* emotion = command.find("talking_emotion")) {
+                    talking_emotion = emotion->value;
                     printf("[PARSE] talking_emotion=%s\n", talking_emotion.c_str());
                 }
 
-                printf("[COMMAND] Complete parsed command: emotion=%s, talking_emotion=%s, duration=%.2f, intensity=%.2f, text='%s', mouth_speed=%.2f\n",
-                       new_emotion.c_str(), talking_emotion.c_str(), current_duration,
+                printf("[COMMAND] Complete parsed command: emotion=%.*s, talking_emotion=%s, duration=%.2f, intensity=%.2f, text='%s', mouth_speed=%.2f\n",
+                       (int)new_emotion.size(), new_emotion.data(), talking_emotion.c_str(), current_duration,
                        current_intensity, current_text.c_str(), current_mouth_speed);
 
-                if (emotions.find(new_emotion) == emotions.end()) {
-                    printf("[ERROR] Emotion '%s' not defined, using 'neutral'\n", new_emotion.c_str());
-                    new_emotion = "neutral";
+                // Сначала встроенные эмоции, затем загруженные лица и анимации
+                const FaceAssetEntry* asset = nullptr;
+                const EmotionEntry* entry = find_emotion(new_emotion);
+                if (!entry && (asset = face_asset_find(new_emotion))) {
+                    entry = &ASSET_EMOTION;
+                    // Кадры нового ассета считаются с начала ещё до переключения
+                    reset_state(ASSET_EMOTION.name, &asset_state);
+                }
+                current_asset = asset;
+                if (!entry) {
+                    printf("[ERROR] Emotion '%.*s' not defined, using 'neutral'\n",
+                           (int)new_emotion.size(), new_emotion.data());
+                    entry = find_emotion("neutral");
                 }
 
-                current_emotion = new_emotion;
+                // Имя из таблицы (или из индекса ассетов) переживает буфер команды
+                current_emotion = asset ? std::string_view(asset->name) : entry->name;
                 new_command_received = true;
                 printf("[SUCCESS] Command processed successfully\n");
             }
 
-            if (new_command_received && get_time() - last_emotion_time > 0.5) {
+            if (new_command_received && get_time() - last_emotion_time > 0.5 && transition_ready()) {
                 if (display_initialized) {
-                    printf("[EMOTION] Switching to emotion: %s\n", current_emotion.c_str());
+                    printf("[EMOTION] Switching to emotion: %.*s\n", (int)current_emotion.size(), current_emotion.data());
                     reset_emotion_state(current_emotion);
-                    emotions[current_emotion](current_intensity);
-                    printf("[EMOTION] Successfully switched to %s\n", current_emotion.c_str());
+                    run_emotion(current_emotion, current_intensity);
+                    printf("[EMOTION] Successfully switched to %.*s\n", (int)current_emotion.size(), current_emotion.data());
                 }
+                pending_reveal = fading_out;
+                fading_out = false;
                 last_emotion_time = get_time();
                 new_command_received = false;
                 
                 // Send confirmation response
-                printf("{\"status\": \"ok\", \"emotion\": \"%s\", \"timestamp\": %.2f}\n", 
-                       current_emotion.c_str(), get_time());
+                printf("{\"status\": \"ok\", \"emotion\": \"%.*s\", \"timestamp\": %.2f}\n", 
+                       (int)current_emotion.size(), current_emotion.data(), get_time());
             }
 
             if (display_initialized) {
-                emotions[current_emotion](current_intensity);
+                // Поток взгляда включает и выключает слой глаз для любой эмоции
+                gaze_stream_update(time_us_32());
+                if (gaze_stream_active() != gaze_streaming) {
+                    gaze_streaming = gaze_stream_active();
+                    update_eye_layer(current_emotion);
+                }
+
+                run_emotion(current_emotion, current_intensity);
+                color_anim_update();
+                panel_effects_update(time_us_32());
+                particles_update(time_us_32());
+                subtitles_update(time_us_32());
+                if (eyes_update()) {
+                    gaze_stream_presented(time_us_32());
+                }
+                // Полная перерисовка новой эмоции прошла в темноте
+                if (pending_reveal && main_face_renderer().is_initialized()) {
+                    // Кадр, нарисованный в темноте, должен быть на панели до появления
+                    display_list_fence();
+                    backlight_restore(FADE_IN_MS);
+                    pending_reveal = false;
+                }
 
-                TalkingState* talking_state = static_cast<TalkingState*>(emotion_states["talking"]);
-                if (!talking_state->talking && !current_text.empty()) {
+                if (!talking_state.talking && !current_text.empty()) {
                     current_text.clear();
                     talking_emotion.clear();
                 }
@@ -363,19 +697,21 @@ int main() {
 
             if (get_time() - emotion_timer >= current_duration) {
                 if (current_emotion != "neutral") {
-                    std::string finished_emotion = current_emotion;
-                    printf("[TIMEOUT] Emotion %s duration expired (%.2f >= %.2f)\n", 
-                           finished_emotion.c_str(), get_time() - emotion_timer, current_duration);
+                    std::string_view finished_emotion = current_emotion;
+                    printf("[TIMEOUT] Emotion %.*s duration expired (%.2f >= %.2f)\n", 
+                           (int)finished_emotion.size(), finished_emotion.data(), get_time() - emotion_timer, current_duration);
                     current_emotion = "neutral";
+                    current_asset = nullptr;
                     current_text.clear();
                     talking_emotion.clear();
                     if (display_initialized) {
                         reset_emotion_state(current_emotion);
-                        emotions[current_emotion](current_intensity);
+                        run_emotion(current_emotion, current_intensity);
                         printf("[TIMEOUT] Auto switched to neutral\n");
                     }
                     // Output finished event
-                    printf("{\"event\": \"emotion_finished\", \"emotion\": \"%s\"}\n", finished_emotion.c_str());
+                    printf("{\"event\": \"emotion_finished\", \"emotion\": \"%.*s\"}\n",
+                           (int)finished_emotion.size(), finished_emotion.data());
                 }
             }
 
@@ -1,7 +1,6 @@
 #include "states.h"
 #include <cstdlib>
 #include <ctime>
-#include <string>
 
 // Get neutral state
 NeutralState get_neutral_state() {
@@ -38,12 +37,12 @@ AnimState reset_anim_state() {
 }
 
 // Generic reset function
-void* reset_state(const std::string& emotion) {
+void reset_state(std::string_view emotion, void* state) {
     if (emotion == "neutral") {
-        return new NeutralState(get_neutral_state());
+        *static_cast<NeutralState*>(state) = get_neutral_state();
     } else if (emotion == "talking") {
-        return new TalkingState(get_talking_state());
+        *static_cast<TalkingState*>(state) = get_talking_state();
     } else {
-        return new AnimState(get_anim_state());
+        *static_cast<AnimState*>(state) = get_anim_state();
     }
-}
\ No newline at end of file
+}
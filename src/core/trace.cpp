@@ -0,0 +1,78 @@
+#include "trace.h"
+#include <stdio.h>
+#include "pico/stdlib.h"
+
+static_assert((TRACE_BUFFER_SIZE & (TRACE_BUFFER_SIZE - 1)) == 0,
+              "TRACE_BUFFER_SIZE must be a power of two");
+
+static const char* const TRACE_NAMES[TRACE_ID_COUNT] = {
+    "read_command",
+    "parse_json",
+    "emotion_neutral",
+    "emotion_smile",
+    "emotion_smile_love",
+    "emotion_embarrassed",
+    "emotion_scary",
+    "emotion_happy",
+    "emotion_sad",
+    "emotion_surprise",
+    "emotion_talking",
+    "draw_matrix_full",
+    "draw_matrix_incremental",
+    "border_clear",
+    "yawn_wait",
+    "draw_eyes",
+    "draw_particles",
+    "tear_wait",
+    "dlist_fence",
+};
+
+static TraceEvent trace_buffer[TRACE_BUFFER_SIZE];
+static uint32_t trace_head = 0;   // Total number of recorded events
+static bool trace_enabled = true;
+
+void trace_record(TraceId id, TracePhase phase) {
+    if (!trace_enabled) {
+        return;
+    }
+    TraceEvent& event = trace_buffer[trace_head & (TRACE_BUFFER_SIZE - 1)];
+    event.timestamp_us = time_us_32();
+    event.id = id;
+    event.phase = phase;
+    trace_head++;
+}
+
+void trace_start() {
+    trace_enabled = true;
+    printf("[TRACE] Recording started\n");
+}
+
+void trace_stop() {
+    trace_enabled = false;
+    printf("[TRACE] Recording stopped, %lu events in buffer\n",
+           trace_head < TRACE_BUFFER_SIZE ? trace_head : (uint32_t)TRACE_BUFFER_SIZE);
+}
+
+void trace_clear() {
+    trace_head = 0;
+    printf("[TRACE] Buffer cleared\n");
+}
+
+void trace_dump() {
+    // Запись приостанавливается, чтобы printf не попадал в дамп
+    bool was_enabled = trace_enabled;
+    trace_enabled = false;
+
+    uint32_t count = trace_head < TRACE_BUFFER_SIZE ? trace_head : TRACE_BUFFER_SIZE;
+    uint32_t first = trace_head - count;
+
+    printf("[TRACE] Dump begin: events=%lu dropped=%lu\n", count, first);
+    for (uint32_t i = first; i != trace_head; i++) {
+        const TraceEvent& event = trace_buffer[i & (TRACE_BUFFER_SIZE - 1)];
+        const char* name = event.id < TRACE_ID_COUNT ? TRACE_NAMES[event.id] : "unknown";
+        printf("T %lu %c %s\n", event.timestamp_us, event.phase, name);
+    }
+    printf("[TRACE] Dump end\n");
+
+    trace_enabled = was_enabled;
+}
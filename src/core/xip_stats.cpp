@@ -0,0 +1,35 @@
+#include "xip_stats.h"
+#include "hot_path.h"
+#include "pico/stdlib.h"
+#include "hardware/structs/xip_ctrl.h"
+#include "hardware/regs/addressmap.h"
+#include <stdio.h>
+
+// Конец .bss из компоновщика: всё статическое в SRAM, включая код и таблицы HOT_FUNC/HOT_ASSET
+extern char end;
+
+#if PICO_COPY_TO_RAM
+static const char* const HOT_PATH_MODE = "copy_to_ram";
+#elif ROBOT_RAM_HOT_PATH
+static const char* const HOT_PATH_MODE = "ram";
+#else
+static const char* const HOT_PATH_MODE = "flash";
+#endif
+
+void xip_stats_report() {
+    // Счётчики кэша: обращения к XIP и попадания, запись обнуляет
+    uint32_t accesses = xip_ctrl_hw->ctr_acc;
+    uint32_t hits = xip_ctrl_hw->ctr_hit;
+    uint32_t misses = accesses - hits;
+    printf("{\"xip\": \"%s\", \"accesses\": %lu, \"hits\": %lu, \"misses\": %lu, \"hit_permille\": %lu, "
+           "\"static_ram\": %lu}\n",
+           HOT_PATH_MODE, (unsigned long)accesses, (unsigned long)hits, (unsigned long)misses,
+           accesses ? (unsigned long)((uint64_t)hits * 1000 / accesses) : 0,
+           (unsigned long)((uintptr_t)&end - SRAM_BASE));
+}
+
+void xip_stats_reset() {
+    xip_ctrl_hw->ctr_acc = 0;
+    xip_ctrl_hw->ctr_hit = 0;
+    printf("[XIP] Counters reset\n");
+}
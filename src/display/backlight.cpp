@@ -0,0 +1,113 @@
+#include "backlight.h"
+#include "display_config.h"
+#include "pico/stdlib.h"
+#include "hardware/gpio.h"
+#include "hardware/pwm.h"
+#include "hardware/irq.h"
+#include "hardware/clocks.h"
+#include <stdio.h>
+
+// Скважность для каждого уровня яркости: гамма 2, ненулевой уровень не гасит подсветку.
+// Таблицу считает компилятор, при старте она только копируется в RAM для прерывания
+struct BacklightDuty {
+    uint16_t level[BACKLIGHT_MAX + 1];
+};
+
+static constexpr BacklightDuty make_duty_table() {
+    BacklightDuty table{};
+    for (int level = 0; level <= BACKLIGHT_MAX; level++) {
+        uint32_t squared = (uint32_t)level * level * BACKLIGHT_PWM_WRAP;
+        table.level[level] = (squared + BACKLIGHT_MAX * BACKLIGHT_MAX - 1) / (BACKLIGHT_MAX * BACKLIGHT_MAX);
+    }
+    return table;
+}
+
+static BacklightDuty duty = make_duty_table();
+
+static uint slice = 0;
+static uint8_t brightness = BACKLIGHT_MAX;
+
+// Состояние затухания меняет только прерывание, пока оно включено
+static volatile int32_t level_q16 = BACKLIGHT_MAX << 16;
+static volatile int32_t step_q16 = 0;
+static volatile uint32_t steps_left = 0;
+static volatile uint8_t target_level = BACKLIGHT_MAX;
+
+static void __not_in_flash_func(backlight_wrap_irq)() {
+    if (!(pwm_get_irq_status_mask() & (1u << slice))) {
+        return;
+    }
+    pwm_clear_irq(slice);
+    if (steps_left == 0) {
+        pwm_set_irq_enabled(slice, false);
+        return;
+    }
+    if (--steps_left == 0) {
+        level_q16 = target_level << 16;
+        pwm_set_irq_enabled(slice, false);
+    } else {
+        level_q16 += step_q16;
+    }
+    pwm_set_gpio_level(DISPLAY_BACKLIGHT_PIN, duty.level[level_q16 >> 16]);
+}
+
+void backlight_init() {
+    slice = pwm_gpio_to_slice_num(DISPLAY_BACKLIGHT_PIN);
+    pwm_config config = pwm_get_default_config();
+    pwm_config_set_wrap(&config, BACKLIGHT_PWM_WRAP);
+    pwm_config_set_clkdiv(&config, (float)clock_get_hz(clk_sys) / ((BACKLIGHT_PWM_WRAP + 1) * BACKLIGHT_PWM_HZ));
+    pwm_init(slice, &config, true);
+    pwm_set_gpio_level(DISPLAY_BACKLIGHT_PIN, duty.level[brightness]);
+    gpio_set_function(DISPLAY_BACKLIGHT_PIN, GPIO_FUNC_PWM);
+
+    // Прерывание переполнения общее для всех слайсов ШИМ
+    pwm_clear_irq(slice);
+    irq_add_shared_handler(PWM_IRQ_WRAP, backlight_wrap_irq, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(PWM_IRQ_WRAP, true);
+    printf("[BACKLIGHT] PWM slice %u, %d Hz\n", slice, BACKLIGHT_PWM_HZ);
+}
+
+void backlight_fade_to(uint8_t level, uint32_t duration_ms) {
+    uint32_t steps = duration_ms * BACKLIGHT_PWM_HZ / 1000;
+
+    // Прерывание выключено, пока меняются параметры затухания
+    pwm_set_irq_enabled(slice, false);
+    int32_t from_q16 = level_q16;
+    target_level = level;
+    if (steps == 0) {
+        steps_left = 0;
+        level_q16 = level << 16;
+        pwm_set_gpio_level(DISPLAY_BACKLIGHT_PIN, duty.level[level]);
+        return;
+    }
+    step_q16 = (((int32_t)level << 16) - from_q16) / (int32_t)steps;
+    steps_left = steps;
+    pwm_clear_irq(slice);
+    pwm_set_irq_enabled(slice, true);
+}
+
+void backlight_set_brightness(uint8_t level, uint32_t fade_ms) {
+    brightness = level;
+    backlight_fade_to(level, fade_ms);
+    printf("[BACKLIGHT] Brightness %u\n", level);
+}
+
+uint8_t backlight_brightness() {
+    return brightness;
+}
+
+void backlight_restore(uint32_t duration_ms) {
+    backlight_fade_to(brightness, duration_ms);
+}
+
+uint8_t backlight_level() {
+    return level_q16 >> 16;
+}
+
+bool backlight_fading() {
+    return steps_left != 0;
+}
+
+bool backlight_dark() {
+    return !backlight_fading() && backlight_level() == 0;
+}
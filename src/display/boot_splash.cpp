@@ -0,0 +1,32 @@
+#include "boot_splash.h"
+#include "display_list.h"
+#include "palette.h"
+
+void boot_splash_show() {
+    using G = SplashGeometry;
+    uint16_t bg = PALETTE_DEFAULT.colors[PALETTE_BG];
+
+    // Фон над и под лицом, по бокам - только если лицо уже экрана
+    display_list_window(0, 0, DISPLAY_WIDTH - 1, DISPLAY_HEIGHT - 1);
+    display_list_fill(bg, G::Y_OFFSET);
+    if (G::X_OFFSET > 0) {
+        display_list_window(0, G::Y_OFFSET, G::X_OFFSET - 1, G::Y_OFFSET + G::HEIGHT - 1);
+        display_list_fill(bg, G::HEIGHT);
+        display_list_window(G::X_OFFSET + G::WIDTH, G::Y_OFFSET, DISPLAY_WIDTH - 1, G::Y_OFFSET + G::HEIGHT - 1);
+        display_list_fill(bg, G::HEIGHT);
+    }
+
+    // Строка клеток - одна строка пикселей из флеша, повторённая CELL_SIZE раз
+    display_list_window(G::X_OFFSET, G::Y_OFFSET, G::X_OFFSET + G::WIDTH - 1, G::Y_OFFSET + G::HEIGHT - 1);
+    for (int row = 0; row < G::ROWS; row++) {
+        display_list_blit(NEUTRAL_SPLASH.pixels[row], G::CELL_SIZE);
+    }
+
+    display_list_window(0, G::Y_OFFSET + G::HEIGHT, DISPLAY_WIDTH - 1, DISPLAY_HEIGHT - 1);
+    display_list_fill(bg, DISPLAY_HEIGHT - G::Y_OFFSET - G::HEIGHT);
+    display_list_submit();
+}
+
+void boot_splash_wait() {
+    display_list_fence();
+}
@@ -1,4 +1,9 @@
 #include "display_config.h"
+#include "backlight.h"
+#include "tear_sync.h"
+#include "boot_splash.h"
+#include "boot_time.h"
+#include <stdio.h>
 
 // LCD configuration for TENSTAR ROBOT 2.4" TFT ST7789V - matching working test
 const struct st7789_config lcd_config = {
@@ -11,11 +16,76 @@ const struct st7789_config lcd_config = {
     .gpio_bl  = DISPLAY_BACKLIGHT_PIN, // BL (Pin 13)
 };
 
+#if DISPLAY_DUAL_PANEL
+const struct st7789_config lcd2_config = {
+    .spi      = DISPLAY2_SPI_PORT,     // SPI0
+    .gpio_din = DISPLAY2_SPI_MOSI,     // MOSI (Pin 3)
+    .gpio_clk = DISPLAY2_SPI_SCK,      // SCK (Pin 2)
+    .gpio_cs  = DISPLAY2_CS_PIN,       // CS (Pin 5)
+    .gpio_dc  = DISPLAY2_DC_PIN,       // DC (Pin 4)
+    .gpio_rst = DISPLAY2_RESET_PIN,    // RST (Pin 7)
+    .gpio_bl  = DISPLAY_BACKLIGHT_PIN, // BL shared (Pin 13)
+};
+
+static struct st7789_display left_panel;
+
+// Обе панели: левая половина экрана на второй, правая на первой, по центру каждой
+static void init_dual_panel() {
+    struct st7789_display* right_panel = st7789_default_display();
+    uint16_t half = lcd_width / 2;
+    uint16_t margin = (lcd_width - half) / 2;
+
+    // Поля вне половины экрана больше никто не пишет: чистим обе панели разом
+    st7789_display_set_window(&left_panel, 0, 0, lcd_width - 1, lcd_height - 1);
+    st7789_display_set_window(right_panel, 0, 0, lcd_width - 1, lcd_height - 1);
+    st7789_display_fill_async(&left_panel, 0x0000, (size_t)lcd_width * lcd_height);
+    st7789_display_fill_async(right_panel, 0x0000, (size_t)lcd_width * lcd_height);
+    st7789_display_wait(&left_panel);
+    st7789_display_wait(right_panel);
+
+    st7789_split_screen(&left_panel, margin, right_panel, margin, half);
+    printf("[DISPLAY] Dual panel: DMA %d + %d\n", left_panel.dma_channel, right_panel->dma_channel);
+}
+#endif
+
 // Dimensions matching working test
 const int lcd_width = DISPLAY_WIDTH;
 const int lcd_height = DISPLAY_HEIGHT;
 
+void init_display_begin() {
+    st7789_init_begin(&lcd_config, lcd_width, lcd_height);
+#if DISPLAY_DUAL_PANEL
+    st7789_display_init_begin(&left_panel, &lcd2_config, lcd_width, lcd_height);
+#endif
+}
+
+bool init_display_poll() {
+    bool ready = st7789_init_poll();
+#if DISPLAY_DUAL_PANEL
+    ready = st7789_display_init_poll(&left_panel) && ready;
+#endif
+    return ready;
+}
+
+void init_display_finish() {
+    while (!init_display_poll()) {
+        sleep_us(100);
+    }
+    boot_phase("panel_ready");
+#if DISPLAY_DUAL_PANEL
+    init_dual_panel();
+#endif
+
+    // Подсветка включается, когда заставка уже в памяти панели: без мусора после сброса
+    boot_splash_show();
+    tear_sync_init();
+    boot_splash_wait();
+    backlight_init();
+    boot_phase("splash");
+}
+
 // Initialize display function
 void init_display() {
-    st7789_init(&lcd_config, lcd_width, lcd_height);
+    init_display_begin();
+    init_display_finish();
 }
\ No newline at end of file
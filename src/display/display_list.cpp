@@ -0,0 +1,156 @@
+#include "display_list.h"
+#include "trace.h"
+#include "hot_path.h"
+#include "pico/stdlib.h"
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+
+// Use C driver directly
+extern "C" {
+#include "pico/st7789.h"
+}
+
+static st7789_draw_list lists[2];
+static int current = 0;
+static bool recording = false;
+static bool enabled = true;
+
+static uint32_t stat_lists = 0;
+static uint32_t stat_ops = 0;
+static uint32_t stat_pixels = 0;
+static uint32_t stat_fences = 0;
+static uint64_t stat_fence_us = 0;
+static uint32_t stat_max_fence_us = 0;
+
+void display_list_set_enabled(bool on) {
+    display_list_submit();
+    display_list_fence();
+    enabled = on;
+    printf("[DLIST] %s\n", on ? "Enabled" : "Disabled");
+}
+
+bool display_list_enabled() {
+    return enabled;
+}
+
+// Буфер свободен только когда DMA его дописал; ждём лишь если он ещё уходит
+static st7789_draw_list& HOT_FUNC(record_list)() {
+    st7789_draw_list& list = lists[current];
+    if (!recording) {
+        if (st7789_draw_list_busy(&list)) {
+            uint32_t start = time_us_32();
+            TRACE_BEGIN(TRACE_DLIST_FENCE);
+            st7789_draw_list_fence(&list);
+            TRACE_END(TRACE_DLIST_FENCE);
+            uint32_t waited = time_us_32() - start;
+            stat_fences++;
+            stat_fence_us += waited;
+            stat_max_fence_us = std::max(stat_max_fence_us, waited);
+        }
+        st7789_draw_list_reset(&list);
+        recording = true;
+    }
+    return list;
+}
+
+// Окно записи и число уже записанных в него строк
+static int win_x0, win_y0, win_x1, win_y1;
+static int win_lines = 0;
+
+// Список заполнен: отправляем его и продолжаем в другом буфере с первой незаписанной строки окна
+static st7789_draw_list& HOT_FUNC(next_list)() {
+    display_list_submit();
+    st7789_draw_list& list = record_list();
+    st7789_draw_list_window(&list, win_x0, win_y0 + win_lines, win_x1, win_y1);
+    return list;
+}
+
+void HOT_FUNC(display_list_window)(int x0, int y0, int x1, int y1) {
+    win_x0 = x0;
+    win_y0 = y0;
+    win_x1 = x1;
+    win_y1 = y1;
+    win_lines = 0;
+    st7789_draw_list* list = &record_list();
+    if (!st7789_draw_list_window(list, x0, y0, x1, y1)) {
+        next_list();
+    }
+}
+
+void HOT_FUNC(display_list_fill)(uint16_t color, int lines) {
+    st7789_draw_list* list = &record_list();
+    while (lines > 0) {
+        int chunk = std::min(lines, 0xffff);
+        if (!st7789_draw_list_fill(list, color, chunk)) {
+            list = &next_list();
+            continue;
+        }
+        lines -= chunk;
+        win_lines += chunk;
+    }
+}
+
+void HOT_FUNC(display_list_line)(const uint16_t* pixels, int width, int repeat) {
+    st7789_draw_list* list = &record_list();
+    while (repeat > 0) {
+        int chunk = std::min(repeat, ST7789_DRAW_LIST_MAX_LINES);
+        uint16_t* line = st7789_draw_list_line(list, chunk);
+        if (!line) {
+            list = &next_list();
+            continue;
+        }
+        memcpy(line, pixels, width * sizeof(uint16_t));
+        repeat -= chunk;
+        win_lines += chunk;
+    }
+}
+
+void HOT_FUNC(display_list_blit)(const uint16_t* pixels, int repeat) {
+    st7789_draw_list* list = &record_list();
+    while (repeat > 0) {
+        int chunk = std::min(repeat, ST7789_DRAW_LIST_MAX_LINES);
+        if (!st7789_draw_list_blit(list, pixels, chunk, 0)) {
+            list = &next_list();
+            continue;
+        }
+        repeat -= chunk;
+        win_lines += chunk;
+    }
+}
+
+void HOT_FUNC(display_list_submit)() {
+    if (!recording) {
+        return;
+    }
+    st7789_draw_list& list = lists[current];
+    recording = false;
+    if (list.op_count == 0) {
+        return;
+    }
+    stat_lists++;
+    stat_ops += list.op_count;
+    stat_pixels += list.pixel_count;
+    st7789_draw_list_submit(&list);
+    current ^= 1;
+}
+
+void display_list_fence() {
+    st7789_draw_list_sync();
+}
+
+void display_list_report() {
+    printf("{\"display_list\": \"%s\", \"lists\": %lu, \"ops\": %lu, \"pixels\": %lu, "
+           "\"fences\": %lu, \"fence_avg_us\": %lu, \"fence_max_us\": %lu}\n",
+           enabled ? "on" : "off", stat_lists, stat_ops, stat_pixels, stat_fences,
+           stat_fences ? (uint32_t)(stat_fence_us / stat_fences) : 0, stat_max_fence_us);
+}
+
+void display_list_reset_stats() {
+    stat_lists = 0;
+    stat_ops = 0;
+    stat_pixels = 0;
+    stat_fences = 0;
+    stat_fence_us = 0;
+    stat_max_fence_us = 0;
+}
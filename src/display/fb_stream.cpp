@@ -0,0 +1,243 @@
+#include "fb_stream.h"
+#include "display_config.h"
+#include "display_list.h"
+#include "pico/stdlib.h"
+#include "pico/stdio_usb.h"
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+
+// Пакеты читаются из FIFO CDC порциями: getchar по байту не успевает за USB.
+// Чтение идёт через драйвер stdio_usb под его мьютексом, как и tud_task в его
+// фоновом прерывании, поэтому TinyUSB не трогают с двух сторон сразу
+static const int RX_CHUNK = 512;
+
+static bool active = false;
+
+// Разбор пакета: заголовок по байту, затем полезная нагрузка порциями
+static FbStreamHeader header;
+static uint32_t header_fill = 0;
+static uint8_t payload_type = 0;   // 0: нагрузка пропускается
+static uint32_t remaining = 0;
+
+// Строка прямоугольника собирается здесь и копируется в список отрисовки;
+// пока DMA отправляет один список, второй заполняется из USB
+static uint16_t line[DISPLAY_WIDTH];
+static uint32_t line_bytes = 0;
+static int line_pixels = 0;
+static uint32_t rect_pixels_left = 0;
+static int rle_count = -1;         // RLE: длина серии, ждущая индекса
+static uint16_t palette[256];
+
+static uint32_t last_rx_ms = 0;
+static uint32_t start_us = 0;
+static uint32_t end_us = 0;
+static uint32_t stat_frames = 0;
+static uint32_t stat_rects = 0;
+static uint32_t stat_bytes = 0;
+static uint32_t stat_pixels = 0;
+static uint32_t stat_errors = 0;
+static uint32_t stat_dropped = 0;
+
+void fb_stream_start() {
+    display_list_submit();
+    memset(&header, 0, sizeof(header));
+    header_fill = 0;
+    payload_type = 0;
+    remaining = 0;
+    stat_frames = stat_rects = stat_bytes = stat_pixels = stat_errors = stat_dropped = 0;
+    start_us = end_us = 0;
+    last_rx_ms = to_ms_since_boot(get_absolute_time());
+    active = true;
+    printf("[STREAM] Waiting for packets, %dx%d screen\n", DISPLAY_WIDTH, DISPLAY_HEIGHT);
+}
+
+bool fb_stream_active() {
+    return active;
+}
+
+static void stop() {
+    display_list_submit();
+    display_list_fence();
+    active = false;
+    printf("[STREAM] Stopped\n");
+    fb_stream_report();
+}
+
+static bool rect_valid() {
+    if (header.w == 0 || header.h == 0 || header.x + header.w > DISPLAY_WIDTH || header.y + header.h > DISPLAY_HEIGHT) {
+        return false;
+    }
+    if (header.type == FB_STREAM_RECT_RGB565) {
+        return header.length == (uint32_t)header.w * header.h * 2;
+    }
+    return header.length % 2 == 0;
+}
+
+static void begin_packet() {
+    payload_type = 0;
+    remaining = header.length;
+    switch (header.type) {
+    case FB_STREAM_RECT_RGB565:
+    case FB_STREAM_RECT_RLE:
+        if (!rect_valid()) {
+            stat_errors++;
+            break;
+        }
+        display_list_window(header.x, header.y, header.x + header.w - 1, header.y + header.h - 1);
+        rect_pixels_left = (uint32_t)header.w * header.h;
+        line_bytes = 0;
+        line_pixels = 0;
+        rle_count = -1;
+        payload_type = header.type;
+        stat_rects++;
+        break;
+    case FB_STREAM_PALETTE:
+        if (header.x + header.w > 256 || header.length != header.w * 2u) {
+            stat_errors++;
+            break;
+        }
+        payload_type = header.type;
+        break;
+    case FB_STREAM_FRAME:
+        display_list_submit();
+        stat_frames++;
+        break;
+    case FB_STREAM_STOP:
+        stop();
+        break;
+    default:
+        stat_errors++;
+        break;
+    }
+}
+
+static void rgb565_payload(const uint8_t* data, uint32_t size) {
+    uint8_t* bytes = (uint8_t*)line;
+    uint32_t line_size = header.w * 2u;
+    while (size) {
+        uint32_t take = std::min(size, line_size - line_bytes);
+        memcpy(bytes + line_bytes, data, take);
+        line_bytes += take;
+        data += take;
+        size -= take;
+        if (line_bytes == line_size) {
+            display_list_line(line, header.w, 1);
+            line_bytes = 0;
+        }
+    }
+}
+
+static void rle_payload(const uint8_t* data, uint32_t size) {
+    for (uint32_t i = 0; i < size; i++) {
+        if (rle_count < 0) {
+            rle_count = data[i] + 1;
+            continue;
+        }
+        uint16_t color = palette[data[i]];
+        uint32_t run = std::min<uint32_t>(rle_count, rect_pixels_left);
+        rle_count = -1;
+        rect_pixels_left -= run;
+        while (run) {
+            // Целые строки одного цвета - заливкой, без пикселей в списке
+            if (line_pixels == 0 && run >= header.w) {
+                uint32_t lines = run / header.w;
+                display_list_fill(color, lines);
+                run -= lines * header.w;
+                continue;
+            }
+            uint32_t take = std::min<uint32_t>(run, header.w - line_pixels);
+            std::fill(line + line_pixels, line + line_pixels + take, color);
+            line_pixels += take;
+            run -= take;
+            if (line_pixels == header.w) {
+                display_list_line(line, header.w, 1);
+                line_pixels = 0;
+            }
+        }
+    }
+}
+
+static void end_packet() {
+    if (payload_type == FB_STREAM_RECT_RLE && rect_pixels_left) {
+        stat_errors++;
+    }
+    if (payload_type == FB_STREAM_RECT_RGB565 || payload_type == FB_STREAM_RECT_RLE) {
+        stat_pixels += (uint32_t)header.w * header.h - rect_pixels_left;
+    }
+}
+
+static void feed(const uint8_t* data, uint32_t size) {
+    while (size && active) {
+        if (header_fill < sizeof(header)) {
+            uint8_t c = *data++;
+            size--;
+            // Сигнатура "FS": всё до неё отбрасывается
+            if ((header_fill == 0 && c != 'F') || (header_fill == 1 && c != 'S')) {
+                stat_dropped++;
+                header_fill = (c == 'F') ? 1 : 0;
+                continue;
+            }
+            ((uint8_t*)&header)[header_fill++] = c;
+            if (header_fill == sizeof(header)) {
+                begin_packet();
+                if (remaining == 0) {
+                    header_fill = 0;
+                }
+            }
+            continue;
+        }
+
+        uint32_t take = std::min(size, remaining);
+        if (payload_type == FB_STREAM_RECT_RGB565) {
+            rgb565_payload(data, take);
+        } else if (payload_type == FB_STREAM_RECT_RLE) {
+            rle_payload(data, take);
+        } else if (payload_type == FB_STREAM_PALETTE) {
+            memcpy((uint8_t*)palette + header.x * 2 + (header.length - remaining), data, take);
+        }
+        data += take;
+        size -= take;
+        remaining -= take;
+        if (remaining == 0) {
+            if (payload_type == FB_STREAM_RECT_RGB565) {
+                rect_pixels_left = 0;
+            }
+            end_packet();
+            header_fill = 0;
+        }
+    }
+}
+
+bool fb_stream_poll() {
+    static uint8_t rx[RX_CHUNK];
+    if (!active) {
+        return false;
+    }
+    uint32_t now_ms = to_ms_since_boot(get_absolute_time());
+    int count;
+    while (active && (count = stdio_usb.in_chars((char*)rx, RX_CHUNK)) > 0) {
+        if (!start_us) {
+            start_us = time_us_32();
+        }
+        end_us = time_us_32();
+        stat_bytes += count;
+        last_rx_ms = now_ms;
+        feed(rx, count);
+    }
+    if (active && now_ms - last_rx_ms > FB_STREAM_TIMEOUT_MS) {
+        printf("[STREAM] No data for %d ms\n", FB_STREAM_TIMEOUT_MS);
+        stop();
+    }
+    return active;
+}
+
+void fb_stream_report() {
+    uint32_t elapsed_us = end_us - start_us;
+    float seconds = elapsed_us / 1e6f;
+    printf("{\"stream\": \"%s\", \"frames\": %lu, \"rects\": %lu, \"bytes\": %lu, \"pixels\": %lu, "
+           "\"errors\": %lu, \"dropped\": %lu, \"ms\": %lu, \"fps\": %.1f, \"bytes_per_s\": %lu, \"pixels_per_s\": %lu}\n",
+           active ? "on" : "off", stat_frames, stat_rects, stat_bytes, stat_pixels, stat_errors, stat_dropped,
+           elapsed_us / 1000, elapsed_us ? stat_frames / seconds : 0.0f,
+           elapsed_us ? (uint32_t)(stat_bytes / seconds) : 0, elapsed_us ? (uint32_t)(stat_pixels / seconds) : 0);
+}
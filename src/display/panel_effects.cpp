@@ -0,0 +1,329 @@
+#include "panel_effects.h"
+#include "display_config.h"
+#include "pico/stdlib.h"
+#include <stdio.h>
+#include <cmath>
+#include <algorithm>
+
+// Use C driver directly
+extern "C" {
+#include "pico/st7789.h"
+}
+
+// MADCTL ML: порядок обновления строк панели
+static const uint8_t MADCTL_ML = 0x10;
+static const float PI_F = 3.14159265f;
+
+enum PanelEffectKind : uint8_t {
+    PANEL_EFFECT_SHAKE,
+    PANEL_EFFECT_BOUNCE,
+    PANEL_EFFECT_INVERT_FLASH,
+};
+
+// size: амплитуда в пикселях для сдвигов, число вспышек для инверсии
+struct EmotionPanelEffect {
+    const char* emotion;
+    PanelEffectKind kind;
+    uint8_t size;
+    uint16_t duration_ms;  // для вспышки - период одной вспышки
+};
+
+static const EmotionPanelEffect EMOTION_EFFECTS[] = {
+    {"scary",    PANEL_EFFECT_INVERT_FLASH, 2, 160},
+    {"scary",    PANEL_EFFECT_SHAKE,        6, 400},
+    {"surprise", PANEL_EFFECT_BOUNCE,      14, 600},
+    {"happy",    PANEL_EFFECT_BOUNCE,       8, 500},
+};
+
+enum ScrollEffectKind : uint8_t {
+    SCROLL_NONE,
+    SCROLL_SHAKE,
+    SCROLL_BOUNCE,
+    SCROLL_SLIDE,
+};
+
+// Текущая область прокрутки в строках экрана
+static int area_first = -1;
+static int area_rows = 0;
+static int area_top = 0;
+static uint32_t generation = 1;
+
+static ScrollEffectKind scroll_effect = SCROLL_NONE;
+static uint32_t effect_start_us = 0;
+static uint32_t effect_duration_us = 0;
+static uint32_t last_frame_us = 0;
+static int effect_size = 0;
+
+static PanelRowSource slide_source = nullptr;
+static int slide_rows_done = 0;
+static uint16_t slide_line[DISPLAY_WIDTH];
+
+static bool flash_active = false;
+static bool inverted = false;
+static uint32_t flash_start_us = 0;
+static uint32_t flash_period_us = 0;
+static int flash_count = 0;
+
+static bool sleeping = false;
+
+// Прокрутка и частичный режим выходят из режима прокрутки друг друга:
+// все пользователи области должны занять её заново
+static void lose_scroll_area() {
+    area_first = -1;
+    area_rows = 0;
+    area_top = 0;
+    generation++;
+}
+
+void panel_scroll_area(int first_row, int rows) {
+    if (first_row == area_first && rows == area_rows) {
+        return;
+    }
+    int bottom_rows = DISPLAY_HEIGHT - first_row - rows;
+    // Строки памяти идут снизу вверх: фиксированные области меняются местами
+#if DISPLAY_ROWS_REVERSED
+    st7789_vertical_scroll_area(bottom_rows, rows, first_row);
+#else
+    st7789_vertical_scroll_area(first_row, rows, bottom_rows);
+#endif
+    area_first = first_row;
+    area_rows = rows;
+    area_top = -1;
+    generation++;
+    // Старый VSCSAD в новой области означал бы случайный сдвиг
+    panel_scroll_to(0);
+}
+
+void panel_scroll_to(int top) {
+    if (area_rows <= 0 || top == area_top) {
+        return;
+    }
+    area_top = top;
+#if DISPLAY_ROWS_REVERSED
+    // Кольцо в памяти прокручивается в обратную сторону
+    st7789_vertical_scroll(DISPLAY_HEIGHT - area_first - area_rows + (area_rows - top) % area_rows);
+#else
+    st7789_vertical_scroll(area_first + top);
+#endif
+}
+
+uint32_t panel_scroll_generation() {
+    return generation;
+}
+
+bool panel_scroll_busy() {
+    return scroll_effect != SCROLL_NONE;
+}
+
+// Содержимое сдвинуто вниз на `offset` пикселей (минус - вверх)
+static void scroll_content_down(int offset) {
+    panel_scroll_to(((-offset % area_rows) + area_rows) % area_rows);
+}
+
+static void finish_slide();
+
+static bool start_scroll_effect(ScrollEffectKind kind, int size, uint32_t duration_ms) {
+    if (sleeping || duration_ms == 0) {
+        return false;
+    }
+    if (scroll_effect == SCROLL_SLIDE) {
+        finish_slide();
+    }
+    panel_scroll_area(0, DISPLAY_HEIGHT);
+    scroll_effect = kind;
+    effect_size = std::max(0, std::min(PANEL_EFFECT_MAX_OFFSET, size));
+    effect_start_us = time_us_32();
+    effect_duration_us = duration_ms * 1000;
+    last_frame_us = effect_start_us - PANEL_EFFECT_FRAME_US;
+    return true;
+}
+
+void panel_shake(int amplitude, uint32_t duration_ms) {
+    if (start_scroll_effect(SCROLL_SHAKE, amplitude, duration_ms)) {
+        printf("[PANEL] Shake %d px, %lu ms\n", effect_size, duration_ms);
+    }
+}
+
+void panel_bounce(int height, uint32_t duration_ms) {
+    if (start_scroll_effect(SCROLL_BOUNCE, height, duration_ms)) {
+        printf("[PANEL] Bounce %d px, %lu ms\n", effect_size, duration_ms);
+    }
+}
+
+static void write_rows(PanelRowSource source, int first_y, int last_y) {
+    st7789_set_window(0, first_y, DISPLAY_WIDTH - 1, last_y);
+    for (int y = first_y; y <= last_y; y++) {
+        source(y, slide_line);
+        st7789_write(slide_line, sizeof(slide_line));
+    }
+}
+
+// Новые строки [area_rows - target, area_rows - slide_rows_done) области, одним окном;
+// затем сдвиг на столько же: они появляются сверху, старое лицо уходит вниз
+static void slide_to(int target) {
+    if (target <= slide_rows_done) {
+        return;
+    }
+    write_rows(slide_source, area_first + area_rows - target, area_first + area_rows - slide_rows_done - 1);
+    slide_rows_done = target;
+    scroll_content_down(target);
+}
+
+static void finish_slide() {
+    slide_to(area_rows);
+    scroll_effect = SCROLL_NONE;
+}
+
+void panel_slide_in(PanelRowSource source, int first_row, int rows, uint32_t duration_ms) {
+    if (scroll_effect == SCROLL_SLIDE) {
+        finish_slide();
+    } else if (scroll_effect != SCROLL_NONE) {
+        scroll_content_down(0);
+        scroll_effect = SCROLL_NONE;
+    }
+    // Во сне прокрутка выключена частичным режимом - просто записываем строки
+    if (sleeping || duration_ms == 0) {
+        write_rows(source, first_row, first_row + rows - 1);
+        return;
+    }
+    panel_scroll_area(first_row, rows);
+    slide_source = source;
+    slide_rows_done = 0;
+    scroll_effect = SCROLL_SLIDE;
+    effect_start_us = time_us_32();
+    effect_duration_us = duration_ms * 1000;
+    last_frame_us = effect_start_us - PANEL_EFFECT_FRAME_US;
+}
+
+bool panel_slide_active() {
+    return scroll_effect == SCROLL_SLIDE;
+}
+
+static void set_inverted(bool on) {
+    if (on != inverted) {
+        st7789_invert(on);
+        inverted = on;
+    }
+}
+
+void panel_invert_flash(int flashes, uint32_t period_ms) {
+    if (flashes <= 0 || period_ms == 0) {
+        return;
+    }
+    flash_active = true;
+    flash_count = flashes;
+    flash_period_us = period_ms * 1000;
+    flash_start_us = time_us_32();
+    set_inverted(true);
+    printf("[PANEL] Invert flash x%d, %lu ms\n", flashes, period_ms);
+}
+
+void panel_sleep(int first_row, int rows) {
+    panel_effects_stop();
+    // PTLAR в строках памяти
+#if DISPLAY_ROWS_REVERSED
+    st7789_partial_area(DISPLAY_HEIGHT - first_row - rows, DISPLAY_HEIGHT - first_row - 1);
+#else
+    st7789_partial_area(first_row, first_row + rows - 1);
+#endif
+    st7789_partial_mode(true);
+    st7789_idle_mode(true);
+    lose_scroll_area();
+    sleeping = true;
+    printf("[PANEL] Sleep: rows %d..%d, idle mode\n", first_row, first_row + rows - 1);
+}
+
+void panel_wake() {
+    if (!sleeping) {
+        return;
+    }
+    st7789_idle_mode(false);
+    st7789_partial_mode(false);
+    lose_scroll_area();
+    sleeping = false;
+    printf("[PANEL] Wake\n");
+}
+
+bool panel_sleeping() {
+    return sleeping;
+}
+
+void panel_refresh_bottom_up(bool bottom_up) {
+    st7789_madctl(DISPLAY_MADCTL | (bottom_up ? MADCTL_ML : 0));
+}
+
+void panel_effects_start_for_emotion(std::string_view emotion) {
+    for (const EmotionPanelEffect& effect : EMOTION_EFFECTS) {
+        if (emotion != effect.emotion) {
+            continue;
+        }
+        switch (effect.kind) {
+            case PANEL_EFFECT_SHAKE:
+                panel_shake(effect.size, effect.duration_ms);
+                break;
+            case PANEL_EFFECT_BOUNCE:
+                panel_bounce(effect.size, effect.duration_ms);
+                break;
+            case PANEL_EFFECT_INVERT_FLASH:
+                panel_invert_flash(effect.size, effect.duration_ms);
+                break;
+        }
+    }
+}
+
+void panel_effects_stop() {
+    if (scroll_effect == SCROLL_SLIDE) {
+        finish_slide();
+    } else if (scroll_effect != SCROLL_NONE) {
+        scroll_content_down(0);
+        scroll_effect = SCROLL_NONE;
+    }
+    flash_active = false;
+    set_inverted(false);
+}
+
+// Смещение содержимого вниз для кадра shake / bounce, затухает к концу эффекта
+static int scroll_effect_offset(uint32_t elapsed) {
+    float t = (float)elapsed / effect_duration_us;
+    float decay = 1.0f - t;
+    if (scroll_effect == SCROLL_SHAKE) {
+        // ~15 колебаний в секунду
+        return (int)lroundf(effect_size * decay * sinf(2.0f * PI_F * 15.0f * elapsed / 1000000.0f));
+    }
+    // Три прыжка вверх с затуханием
+    return -(int)lroundf(effect_size * decay * fabsf(sinf(3.0f * PI_F * t)));
+}
+
+void panel_effects_update(uint32_t now_us) {
+    if (flash_active) {
+        uint32_t elapsed = now_us - flash_start_us;
+        if (elapsed >= flash_count * flash_period_us) {
+            flash_active = false;
+            set_inverted(false);
+        } else {
+            set_inverted(elapsed % flash_period_us < flash_period_us / 2);
+        }
+    }
+
+    if (scroll_effect == SCROLL_NONE || now_us - last_frame_us < PANEL_EFFECT_FRAME_US) {
+        return;
+    }
+    last_frame_us = now_us;
+    uint32_t elapsed = now_us - effect_start_us;
+
+    if (scroll_effect == SCROLL_SLIDE) {
+        if (elapsed >= effect_duration_us) {
+            finish_slide();
+        } else {
+            slide_to((int)((uint64_t)elapsed * area_rows / effect_duration_us));
+        }
+        return;
+    }
+
+    if (elapsed >= effect_duration_us) {
+        scroll_content_down(0);
+        scroll_effect = SCROLL_NONE;
+        return;
+    }
+    scroll_content_down(scroll_effect_offset(elapsed));
+}
@@ -0,0 +1,108 @@
+#include "scanline_model.h"
+
+uint32_t ScanlineModel::write_us(uint32_t pixels) const {
+    return window_us + (uint32_t)((uint64_t)pixels * 16 * 1000000 / spi_hz);
+}
+
+uint32_t ScanlineModel::beam_us(uint32_t t) const {
+    return (t - vsync_us) % frame_us;
+}
+
+int ScanlineModel::beam_line(uint32_t t) const {
+    return (int)((uint64_t)beam_us(t) * total_lines() / frame_us);
+}
+
+void ScanlineModel::band_time(int y0, int y1, uint32_t& start, uint32_t& length) const {
+    // Строка экрана -> строка развёртки после гашения
+    int first = top_down ? y0 : active_lines - 1 - y1;
+    start = line_start_us(porch_lines + first);
+    length = line_start_us(y1 - y0 + 1);
+}
+
+// Луч прошёл `distance` мкс от начала полосы (по кругу кадра). Разрыв - когда
+// один проход луча по полосе видит и старые, и новые строки.
+bool ScanlineModel::safe_at(uint32_t distance, uint32_t band, uint32_t duration) const {
+    uint32_t line = line_start_us(1);
+    if (!top_down) {
+        // Запись идёт навстречу лучу: луч не должен попасть в полосу за время записи
+        return distance >= band && distance + duration <= frame_us;
+    }
+    if (duration >= band) {
+        // Запись медленнее луча: луч впереди записи и не догонит её на следующем круге
+        return distance + duration <= band - line + frame_us;
+    }
+    // Запись быстрее луча: она не должна догнать луч, пока тот внутри полосы;
+    // луч строкой раньше полосы застанет первую строку недописанной
+    uint64_t caught = (uint64_t)(band - line) * (band - duration) / band;
+    return distance > caught && distance + line < frame_us;
+}
+
+uint32_t ScanlineModel::safe_delay(int y0, int y1, uint32_t duration_us, uint32_t now) const {
+    uint32_t band_start, band;
+    band_time(y0, y1, band_start, band);
+    uint32_t distance = (beam_us(now) + frame_us - band_start) % frame_us;
+    if (safe_at(distance, band, duration_us)) {
+        return 0;
+    }
+
+    uint32_t line = line_start_us(1);
+    if (!top_down) {
+        if (band + duration_us > frame_us) {
+            return 0;
+        }
+        return distance < band ? band - distance : frame_us - distance + band;
+    }
+    if (duration_us >= band) {
+        // Ждём, пока луч войдёт в полосу
+        return duration_us > band - line + frame_us ? 0 : frame_us - distance;
+    }
+    uint32_t caught = (uint32_t)((uint64_t)(band - line) * (band - duration_us) / band);
+    if (distance > caught) {
+        distance -= frame_us;
+    }
+    return caught - distance + line;
+}
+
+bool ScanlineModel::tears(int y0, int y1, uint32_t start, uint32_t end) const {
+    uint32_t band_start, band;
+    band_time(y0, y1, band_start, band);
+    uint32_t distance = (beam_us(start) + frame_us - band_start) % frame_us;
+    return !safe_at(distance, band, end - start);
+}
+
+uint32_t scanline_order(const ScanlineModel& model, const ScanRect* rects, int count,
+                        uint32_t now, uint8_t* order) {
+    uint32_t used = 0;  // уже поставленные полосы
+    uint32_t t = now;
+    uint32_t total_wait = 0;
+    for (int i = 0; i < count; i++) {
+        order[i] = i;
+    }
+    // Больше полос, чем бит в маске - пишем по порядку
+    if (count > 32) {
+        return 0;
+    }
+    // Жадно: следующей пишется полоса, которую можно начать раньше всех
+    for (int n = 0; n < count; n++) {
+        int best = -1;
+        uint32_t best_delay = 0;
+        for (int i = 0; i < count; i++) {
+            if (used & (1u << i)) {
+                continue;
+            }
+            uint32_t delay = model.safe_delay(rects[i].y0, rects[i].y1, model.write_us(rects[i].pixels), t);
+            if (best < 0 || delay < best_delay) {
+                best = i;
+                best_delay = delay;
+                if (delay == 0) {
+                    break;
+                }
+            }
+        }
+        used |= 1u << best;
+        order[n] = best;
+        total_wait += best_delay;
+        t += best_delay + model.write_us(rects[best].pixels);
+    }
+    return total_wait;
+}
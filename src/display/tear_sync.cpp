@@ -0,0 +1,143 @@
+#include "tear_sync.h"
+#include "display_config.h"
+#include "panel_effects.h"
+#include "trace.h"
+#include "pico/stdlib.h"
+#include "hardware/gpio.h"
+#include <stdio.h>
+#include <algorithm>
+
+// Use C driver directly
+extern "C" {
+#include "pico/st7789.h"
+}
+
+static ScanlineModel model;
+static TearSyncMode mode = TEAR_SYNC_OFF;
+
+// Период TE усредняется; фронты дальше 10% от номинала - помехи
+static const uint32_t NOMINAL_FRAME_US = 1000000 / DISPLAY_FRAME_RATE_HZ;
+static volatile uint32_t te_edges = 0;
+static volatile uint32_t last_te_us = 0;
+
+static uint32_t stat_writes = 0;
+static uint32_t stat_waits = 0;
+static uint64_t stat_wait_us = 0;
+static uint32_t stat_max_wait_us = 0;
+static uint32_t stat_tears = 0;
+
+#if DISPLAY_TE_PIN >= 0
+static void te_irq(uint gpio, uint32_t events) {
+    uint32_t now = time_us_32();
+    uint32_t period = now - last_te_us;
+    if (te_edges > 0 && period > NOMINAL_FRAME_US * 9 / 10 && period < NOMINAL_FRAME_US * 11 / 10) {
+        model.frame_us = (model.frame_us * 7 + period) / 8;
+    }
+    last_te_us = now;
+    model.vsync_us = now;
+    te_edges++;
+}
+#endif
+
+void tear_sync_init() {
+    model.frame_us = NOMINAL_FRAME_US;
+    model.active_lines = DISPLAY_HEIGHT;
+    model.porch_lines = DISPLAY_PORCH_LINES;
+    model.spi_hz = DISPLAY_SPI_BAUD;
+    // Строки памяти перевёрнуты - развёртку тоже, чтобы луч шёл сверху вниз, как запись окна
+    panel_refresh_bottom_up(DISPLAY_ROWS_REVERSED);
+    model.top_down = true;
+    // Без TE фаза неизвестна: считаем от включения дисплея, дальше её подстраивают командой
+    model.vsync_us = time_us_32();
+
+#if DISPLAY_TE_PIN >= 0
+    st7789_tearing_effect(true);
+    gpio_init(DISPLAY_TE_PIN);
+    gpio_set_dir(DISPLAY_TE_PIN, GPIO_IN);
+    gpio_set_irq_enabled_with_callback(DISPLAY_TE_PIN, GPIO_IRQ_EDGE_RISE, true, te_irq);
+    mode = TEAR_SYNC_TE;
+    printf("[TEAR] TE on GPIO %d\n", DISPLAY_TE_PIN);
+#else
+    printf("[TEAR] No TE pin, scan-chasing available after calibration\n");
+#endif
+}
+
+void tear_sync_set_mode(TearSyncMode new_mode) {
+#if DISPLAY_TE_PIN < 0
+    if (new_mode == TEAR_SYNC_TE) {
+        printf("[TEAR] No TE pin, using scan mode\n");
+        new_mode = TEAR_SYNC_SCAN;
+    }
+#endif
+    mode = new_mode;
+    printf("[TEAR] Mode %s\n", mode == TEAR_SYNC_TE ? "te" : mode == TEAR_SYNC_SCAN ? "scan" : "off");
+}
+
+TearSyncMode tear_sync_mode() {
+    return mode;
+}
+
+void tear_sync_calibrate(int32_t shift_us, uint32_t frame_us) {
+    if (frame_us > 0) {
+        model.frame_us = frame_us;
+    }
+    model.vsync_us += shift_us;
+    printf("[TEAR] Scan phase %lu us, frame %lu us\n", model.vsync_us % model.frame_us, model.frame_us);
+}
+
+// Положение луча известно: по TE или по ручной подстройке
+static bool scanline_known() {
+    return te_edges > 0 || mode == TEAR_SYNC_SCAN;
+}
+
+void tear_sync_order(const ScanRect* rects, int count, uint8_t* order) {
+    if (mode == TEAR_SYNC_OFF || !scanline_known()) {
+        for (int i = 0; i < count; i++) {
+            order[i] = i;
+        }
+        return;
+    }
+    scanline_order(model, rects, count, time_us_32(), order);
+}
+
+void tear_sync_wait(const ScanRect& rect) {
+    if (mode == TEAR_SYNC_OFF || !scanline_known()) {
+        return;
+    }
+    uint32_t delay = model.safe_delay(rect.y0, rect.y1, model.write_us(rect.pixels), time_us_32());
+    if (delay == 0) {
+        return;
+    }
+    // Не дольше кадра: модель могла ошибиться
+    delay = std::min(delay, model.frame_us);
+    TRACE_BEGIN(TRACE_TEAR_WAIT);
+    busy_wait_us_32(delay);
+    TRACE_END(TRACE_TEAR_WAIT);
+    stat_waits++;
+    stat_wait_us += delay;
+    stat_max_wait_us = std::max(stat_max_wait_us, delay);
+}
+
+void tear_sync_written(const ScanRect& rect, uint32_t start_us, uint32_t end_us) {
+    stat_writes++;
+    if (scanline_known() && model.tears(rect.y0, rect.y1, start_us, end_us)) {
+        stat_tears++;
+    }
+}
+
+void tear_sync_report() {
+    printf("{\"tear_stats\": \"%s\", \"writes\": %lu, \"tears\": %lu, \"waits\": %lu, "
+           "\"wait_avg_us\": %lu, \"wait_max_us\": %lu, \"te_edges\": %lu, \"frame_us\": %lu}\n",
+           mode == TEAR_SYNC_TE ? "te" : mode == TEAR_SYNC_SCAN ? "scan" : "off",
+           stat_writes, stat_tears, stat_waits,
+           stat_waits ? (uint32_t)(stat_wait_us / stat_waits) : 0, stat_max_wait_us,
+           (uint32_t)te_edges, model.frame_us);
+}
+
+void tear_sync_reset_stats() {
+    stat_writes = 0;
+    stat_waits = 0;
+    stat_wait_us = 0;
+    stat_max_wait_us = 0;
+    stat_tears = 0;
+}
@@ -0,0 +1,154 @@
+#include "color_anim.h"
+#include "emotions.h"
+#include "palette.h"
+#include "colors.h"
+#include "pico/stdlib.h"
+
+enum ColorAnimMode : uint8_t {
+    COLOR_ANIM_OFF = 0,
+    COLOR_ANIM_FADE,
+    COLOR_ANIM_PULSE
+};
+
+struct ColorAnim {
+    ColorAnimMode mode;
+    uint16_t from;
+    uint16_t to;
+    uint32_t start_ms;
+    uint32_t duration_ms;   // Длительность fade или период pulse
+    uint32_t last_update_ms;
+    int repaint_row;        // Незавершённая перерисовка, PALETTE_REPAINT_DONE если нет
+};
+
+static ColorAnim color_anims[FACE_PALETTE_SIZE];
+static uint32_t pixel_tokens = COLOR_ANIM_PIXEL_BUDGET;
+static uint32_t last_refill_us = 0;
+
+// Цветовые эффекты эмоций
+static const struct {
+    const char* emotion;
+    uint8_t index;
+    ColorAnimMode mode;
+    uint16_t to;
+    uint32_t duration_ms;
+} EMOTION_COLOR_EFFECTS[] = {
+    {"angry", PALETTE_FACE, COLOR_ANIM_PULSE, color565(110, 0, 0), 900},
+    {"embarrassed", PALETTE_BLUSH, COLOR_ANIM_FADE, color565(255, 40, 60), 2500},
+};
+
+uint16_t lerp_color565(uint16_t from, uint16_t to, uint32_t t) {
+    int32_t r0 = from >> 11, g0 = (from >> 5) & 0x3F, b0 = from & 0x1F;
+    int32_t r1 = to >> 11, g1 = (to >> 5) & 0x3F, b1 = to & 0x1F;
+    int32_t r = r0 + (((r1 - r0) * (int32_t)t) >> 8);
+    int32_t g = g0 + (((g1 - g0) * (int32_t)t) >> 8);
+    int32_t b = b0 + (((b1 - b0) * (int32_t)t) >> 8);
+    return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+static void start_anim(uint8_t index, ColorAnimMode mode, uint16_t from, uint16_t to, uint32_t duration_ms) {
+    if (index >= FACE_PALETTE_SIZE) {
+        return;
+    }
+    ColorAnim& anim = color_anims[index];
+    anim.mode = mode;
+    anim.from = from;
+    anim.to = to;
+    anim.start_ms = to_ms_since_boot(get_absolute_time());
+    anim.duration_ms = duration_ms > 0 ? duration_ms : 1;
+    anim.last_update_ms = 0;
+    anim.repaint_row = PALETTE_REPAINT_DONE;
+}
+
+void color_anim_fade(uint8_t index, uint16_t target, uint32_t duration_ms) {
+    if (index >= FACE_PALETTE_SIZE) {
+        return;
+    }
+    start_anim(index, COLOR_ANIM_FADE, get_active_palette().colors[index], target, duration_ms);
+}
+
+void color_anim_pulse(uint8_t index, uint16_t from, uint16_t to, uint32_t period_ms) {
+    start_anim(index, COLOR_ANIM_PULSE, from, to, period_ms);
+}
+
+void color_anim_stop(uint8_t index) {
+    if (index < FACE_PALETTE_SIZE) {
+        color_anims[index].mode = COLOR_ANIM_OFF;
+    }
+}
+
+void color_anim_stop_all() {
+    for (int i = 0; i < FACE_PALETTE_SIZE; i++) {
+        color_anims[i].mode = COLOR_ANIM_OFF;
+    }
+}
+
+void color_anim_start_for_emotion(std::string_view emotion) {
+    for (const auto& effect : EMOTION_COLOR_EFFECTS) {
+        if (emotion != effect.emotion) {
+            continue;
+        }
+        uint16_t base = get_active_palette().colors[effect.index];
+        if (effect.mode == COLOR_ANIM_PULSE) {
+            color_anim_pulse(effect.index, base, effect.to, effect.duration_ms);
+        } else {
+            color_anim_fade(effect.index, effect.to, effect.duration_ms);
+        }
+        printf("[COLOR_ANIM] Started %.*s effect on palette index %d\n", (int)emotion.size(), emotion.data(),
+               effect.index);
+    }
+}
+
+static uint16_t anim_color(const ColorAnim& anim, uint32_t now_ms) {
+    uint32_t elapsed = now_ms - anim.start_ms;
+    if (anim.mode == COLOR_ANIM_FADE) {
+        if (elapsed >= anim.duration_ms) {
+            return anim.to;
+        }
+        return lerp_color565(anim.from, anim.to, (elapsed * 256) / anim.duration_ms);
+    }
+    // Треугольная волна: from -> to -> from за период
+    uint32_t phase = ((elapsed % anim.duration_ms) * 512) / anim.duration_ms;
+    uint32_t t = phase < 256 ? phase : 512 - phase;
+    return lerp_color565(anim.from, anim.to, t);
+}
+
+void color_anim_update() {
+    // Бюджет пикселей пополняется со скоростью COLOR_ANIM_PIXEL_BUDGET за кадр 60 FPS
+    uint32_t now_us = time_us_32();
+    uint32_t refill = (uint32_t)(((uint64_t)(now_us - last_refill_us) * COLOR_ANIM_PIXEL_BUDGET * 60) / 1000000);
+    if (refill > 0) {
+        pixel_tokens = pixel_tokens + refill < COLOR_ANIM_PIXEL_BUDGET
+            ? pixel_tokens + refill : COLOR_ANIM_PIXEL_BUDGET;
+        last_refill_us = now_us;
+    }
+
+    uint32_t now_ms = to_ms_since_boot(get_absolute_time());
+    for (int i = 0; i < FACE_PALETTE_SIZE; i++) {
+        ColorAnim& anim = color_anims[i];
+        if (anim.mode == COLOR_ANIM_OFF && anim.repaint_row == PALETTE_REPAINT_DONE) {
+            continue;
+        }
+
+        // Новый цвет берётся только после того, как предыдущий целиком на экране
+        if (anim.repaint_row == PALETTE_REPAINT_DONE) {
+            if (anim.mode == COLOR_ANIM_OFF || now_ms - anim.last_update_ms < COLOR_ANIM_INTERVAL_MS) {
+                continue;
+            }
+            anim.last_update_ms = now_ms;
+            uint16_t color = anim_color(anim, now_ms);
+            if (anim.mode == COLOR_ANIM_FADE && now_ms - anim.start_ms >= anim.duration_ms) {
+                anim.mode = COLOR_ANIM_OFF;
+            }
+            if (color == get_active_palette().colors[i]) {
+                continue;
+            }
+            set_palette_entry(i, color, false);
+            anim.repaint_row = 0;
+        }
+
+        if (pixel_tokens == 0) {
+            break;
+        }
+        anim.repaint_row = repaint_palette_rows(i, anim.repaint_row, pixel_tokens);
+    }
+}
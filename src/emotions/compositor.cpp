@@ -0,0 +1,144 @@
+#include "compositor.h"
+#include "face_renderer.h"
+#include "palette.h"
+#include <algorithm>
+
+struct Overlay {
+    const CellSprite* sprite;
+    int row;
+    int col;
+};
+
+static const uint8_t (*eyes_source)[MATRIX_ROWS][MATRIX_COLS] = nullptr;
+static const uint8_t (*mouth_source)[MATRIX_ROWS][MATRIX_COLS] = nullptr;
+static FaceRegion eyes_region = {0, MATRIX_ROWS / 2 - 1, 0, MATRIX_COLS - 1};
+static FaceRegion mouth_region = {MATRIX_ROWS / 2, MATRIX_ROWS - 1, 0, MATRIX_COLS - 1};
+static Overlay overlays[COMPOSITOR_MAX_OVERLAYS];
+static uint8_t grid[MATRIX_ROWS][MATRIX_COLS];
+
+// Грязная область - один прямоугольник, объединение регионов изменённых слоёв
+static bool dirty = true;
+static FaceRegion dirty_region = {0, MATRIX_ROWS - 1, 0, MATRIX_COLS - 1};
+// Сетка собрана, но рендерер пропустил кадр
+static bool unpresented = false;
+
+static void mark_dirty(const FaceRegion& region) {
+    if (!dirty) {
+        dirty_region = region;
+        dirty = true;
+        return;
+    }
+    dirty_region.first_row = std::min(dirty_region.first_row, region.first_row);
+    dirty_region.last_row = std::max(dirty_region.last_row, region.last_row);
+    dirty_region.first_col = std::min(dirty_region.first_col, region.first_col);
+    dirty_region.last_col = std::max(dirty_region.last_col, region.last_col);
+}
+
+// Область спрайта, обрезанная по лицу; false если спрайт целиком за краем
+static bool overlay_region(const Overlay& overlay, FaceRegion& region) {
+    int first_row = std::max(overlay.row, 0);
+    int first_col = std::max(overlay.col, 0);
+    int last_row = std::min(overlay.row + overlay.sprite->rows - 1, MATRIX_ROWS - 1);
+    int last_col = std::min(overlay.col + overlay.sprite->cols - 1, MATRIX_COLS - 1);
+    if (first_row > last_row || first_col > last_col) {
+        return false;
+    }
+    region = {(uint8_t)first_row, (uint8_t)last_row, (uint8_t)first_col, (uint8_t)last_col};
+    return true;
+}
+
+static bool in_region(const FaceRegion& region, int row, int col) {
+    return row >= region.first_row && row <= region.last_row
+        && col >= region.first_col && col <= region.last_col;
+}
+
+// Старая и новая область слоя: граница глаз и рта у разных лиц разная
+void compositor_set_eyes(Matrix12x12& source) {
+    if (eyes_source != &source) {
+        eyes_source = &source;
+        mark_dirty(eyes_region);
+        eyes_region.last_row = find_face_eyes_last_row(source);
+        mark_dirty(eyes_region);
+    }
+}
+
+void compositor_set_mouth(Matrix12x12& source) {
+    if (mouth_source != &source) {
+        mouth_source = &source;
+        mark_dirty(mouth_region);
+        mouth_region.first_row = std::min(find_face_eyes_last_row(source) + 1, MATRIX_ROWS - 1);
+        mark_dirty(mouth_region);
+    }
+}
+
+void compositor_set_overlay(int slot, const CellSprite* sprite, int row, int col) {
+    if (slot < 0 || slot >= COMPOSITOR_MAX_OVERLAYS) {
+        return;
+    }
+    Overlay& overlay = overlays[slot];
+    if (overlay.sprite == sprite && (!sprite || (overlay.row == row && overlay.col == col))) {
+        return;
+    }
+
+    // Старое и новое место спрайта
+    FaceRegion region;
+    if (overlay.sprite && overlay_region(overlay, region)) {
+        mark_dirty(region);
+    }
+    overlay = {sprite, row, col};
+    if (overlay.sprite && overlay_region(overlay, region)) {
+        mark_dirty(region);
+    }
+}
+
+void compositor_clear_overlays() {
+    for (int slot = 0; slot < COMPOSITOR_MAX_OVERLAYS; slot++) {
+        compositor_set_overlay(slot, nullptr, 0, 0);
+    }
+}
+
+void compositor_invalidate() {
+    mark_dirty({0, MATRIX_ROWS - 1, 0, MATRIX_COLS - 1});
+}
+
+bool compositor_present(bool force_redraw) {
+    if (!dirty && !unpresented && !force_redraw) {
+        return false;
+    }
+
+    if (dirty) {
+        const FaceRegion& region = dirty_region;
+        for (int row = region.first_row; row <= region.last_row; row++) {
+            for (int col = region.first_col; col <= region.last_col; col++) {
+                uint8_t value = PALETTE_BG;
+                if (eyes_source && in_region(eyes_region, row, col)) {
+                    value = (*eyes_source)[row][col];
+                } else if (mouth_source && in_region(mouth_region, row, col)) {
+                    value = (*mouth_source)[row][col];
+                }
+                // Наложения поверх слоёв, по порядку слотов
+                for (const Overlay& overlay : overlays) {
+                    if (!overlay.sprite) {
+                        continue;
+                    }
+                    int sprite_row = row - overlay.row;
+                    int sprite_col = col - overlay.col;
+                    if (sprite_row < 0 || sprite_row >= overlay.sprite->rows
+                        || sprite_col < 0 || sprite_col >= overlay.sprite->cols) {
+                        continue;
+                    }
+                    uint8_t cell = overlay.sprite->cells[sprite_row * overlay.sprite->cols + sprite_col];
+                    if (cell != PALETTE_BG) {
+                        value = cell;
+                    }
+                }
+                grid[row][col] = value;
+            }
+        }
+        dirty = false;
+    }
+
+    // Кадр пропущен ограничением частоты - сетка уже собрана, нарисуем в следующий раз
+    unpresented = !main_face_renderer().draw(grid, force_redraw);
+    return !unpresented;
+}
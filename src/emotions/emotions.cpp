@@ -1,116 +1,130 @@
 #include "emotions.h"
 #include "colors.h"
+#include "trace.h"
+#include "frame_stats.h"
+#include "face_renderer.h"
+#include "compositor.h"
+#include "subtitles.h"
+#include "eyes.h"
+#include "gaze_stream.h"
+#include "heap_prof.h"
+#include "face_clip.h"
 #include <cstring>
 #include <cstdlib>
+#include <cctype>
 #include "pico/stdlib.h"
 #include <algorithm>
-#include <vector>
-
-// Use C driver directly
-extern "C" {
-#include "pico/st7789.h"
-}
 
 // Animation system constants
 static const uint32_t ANIMATION_FPS = 60;  // 60 FPS для плавности
 static const uint32_t FRAME_TIME_US = 1000000 / ANIMATION_FPS;  // 16.67ms в микросекундах
 static const uint32_t MIN_FRAME_DURATION_MS = 50;   // Минимальная длительность кадра
 static const uint32_t MAX_FRAME_DURATION_MS = 500;  // Максимальная длительность кадра
+static const uint32_t NEUTRAL_IDLE_GAZE_MS = 5000;  // Пауза после команды gaze до взгляда по pupil_direction
 
 // Global variables
-static uint8_t prev_matrix[MATRIX_ROWS][MATRIX_COLS];
 static uint8_t current_matrix[MATRIX_ROWS][MATRIX_COLS];
-static bool matrix_initialized = false;
-static uint32_t last_draw_time = 0;
 static bool animation_dirty = false;
 
 // Animation interpolation system
 struct AnimationFrame {
-    const uint8_t (*matrix)[MATRIX_COLS];
+    const uint8_t (*matrix)[MATRIX_ROWS][MATRIX_COLS];
     uint32_t duration_ms;
     const char* name;
 };
 
-static std::vector<AnimationFrame> current_animation_sequence;
+// Последовательность кадров рта строится на ходу, по циклу открыт-закрыт (и паузе),
+// так что её длина не ограничена буфером
+struct TalkingSequence {
+    Matrix12x12* open_matrix;
+    Matrix12x12* closed_matrix;
+    uint32_t open_duration;
+    uint32_t closed_duration;
+    uint32_t total_ms;
+    uint32_t accumulated_ms;    // длительность уже построенных кадров
+    int cycle_count;
+    bool finished;              // кадров больше не будет
+    AnimationFrame pending[3];  // кадры последнего цикла
+    int pending_count;
+    int pending_index;
+};
+
+static TalkingSequence talking_sequence = {};
+static bool sequence_active = false;
 static size_t current_frame_index = 0;
 static uint32_t frame_start_time = 0;
 
+static void stop_talking_sequence() {
+    sequence_active = false;
+    talking_sequence.pending_count = 0;
+    talking_sequence.pending_index = 0;
+}
+
 void reset_matrix() {
-    matrix_initialized = false;
+    main_face_renderer().invalidate();
+    compositor_invalidate();
     animation_dirty = true;
-    current_animation_sequence.clear();
+    stop_talking_sequence();
     current_frame_index = 0;
     memset(current_matrix, 0, sizeof(current_matrix));
     printf("[ANIM_SYS] Matrix reset\n");
 }
 
-// Продвинутая функция отрисовки с минимальным мерцанием
-void st7789_fill_rect_optimized(int x, int y, int width, int height, uint16_t color) {
-    // Оптимизированная заливка прямоугольника
-    for (int py = 0; py < height; py++) {
-        st7789_set_cursor(x, y + py);
-        for (int px = 0; px < width; px++) {
-            st7789_put(color);
+// Следующий цикл последовательности; false, когда кадров больше нет
+static bool build_next_cycle(TalkingSequence& seq) {
+    seq.pending_count = 0;
+    seq.pending_index = 0;
+    if (seq.finished || seq.accumulated_ms >= seq.total_ms) {
+        seq.finished = true;
+        return false;
+    }
+
+    // Добавляем естественные вариации (±20%)
+    uint32_t var_open = seq.open_duration + (rand() % (seq.open_duration / 5)) - (seq.open_duration / 10);
+    uint32_t var_closed = seq.closed_duration + (rand() % (seq.closed_duration / 5)) - (seq.closed_duration / 10);
+
+    // Проверяем, помещается ли полный цикл
+    if (seq.accumulated_ms + var_open + var_closed <= seq.total_ms) {
+        seq.pending[seq.pending_count++] = {seq.open_matrix, var_open, "OPEN"};
+        seq.pending[seq.pending_count++] = {seq.closed_matrix, var_closed, "CLOSED"};
+        seq.accumulated_ms += var_open + var_closed;
+        seq.cycle_count++;
+    } else {
+        // Последний неполный цикл
+        uint32_t remaining = seq.total_ms - seq.accumulated_ms;
+        if (remaining > 50) { // Минимум 50ms для показа
+            seq.pending[seq.pending_count++] = {seq.open_matrix, remaining, "FINAL"};
+            seq.accumulated_ms = seq.total_ms;
         }
+        seq.finished = true;
+        return seq.pending_count > 0;
     }
+
+    // Иногда добавляем паузы для естественности (каждые 3-4 цикла)
+    if (seq.cycle_count % 4 == 0 && seq.accumulated_ms + 100 < seq.total_ms) {
+        seq.pending[seq.pending_count++] = {seq.closed_matrix, 100, "PAUSE"};
+        seq.accumulated_ms += 100;
+    }
+    return true;
 }
 
-void draw_matrix(const uint8_t matrix[MATRIX_ROWS][MATRIX_COLS], int pixel_size, bool force_redraw) {
-    uint32_t current_time = to_ms_since_boot(get_absolute_time());
-    
-    // Ограничиваем частоту обновления для плавности
-    if (!force_redraw && (current_time - last_draw_time) < (1000 / ANIMATION_FPS)) {
-        return; // Пропускаем слишком частые обновления
+// Текущий кадр последовательности, nullptr после последнего
+static const AnimationFrame* sequence_frame() {
+    if (!sequence_active) {
+        return nullptr;
     }
-    
-    last_draw_time = current_time;
-    
-    if (!matrix_initialized || force_redraw) {
-        // Полная перерисовка с оптимизацией
-        st7789_fill(STYLE_BG);
-        
-        // Отрисовываем все видимые пиксели
-        for (int row = 0; row < MATRIX_ROWS; row++) {
-            for (int col = 0; col < MATRIX_COLS; col++) {
-                if (matrix[row][col] == 1) {
-                    int x = X_OFFSET + col * pixel_size;
-                    int y = Y_OFFSET + row * pixel_size;
-                    st7789_fill_rect_optimized(x, y, pixel_size, pixel_size, STYLE_FACE);
-                }
-            }
-        }
-        matrix_initialized = true;
-    } else {
-        // Инкрементальное обновление - только изменённые пиксели
-        bool has_changes = false;
-        
-        for (int row = 0; row < MATRIX_ROWS; row++) {
-            for (int col = 0; col < MATRIX_COLS; col++) {
-                if (matrix[row][col] != prev_matrix[row][col]) {
-                    has_changes = true;
-                    int x = X_OFFSET + col * pixel_size;
-                    int y = Y_OFFSET + row * pixel_size;
-                    uint16_t color = (matrix[row][col] == 1) ? STYLE_FACE : STYLE_BG;
-                    st7789_fill_rect_optimized(x, y, pixel_size, pixel_size, color);
-                }
-            }
-        }
-        
-        if (has_changes) {
-            printf("[ANIM_SYS] Incremental update completed\n");
-        }
+    TalkingSequence& seq = talking_sequence;
+    if (seq.pending_index == seq.pending_count && !build_next_cycle(seq)) {
+        return nullptr;
     }
-    
-    // Сохраняем текущее состояние
-    memcpy(prev_matrix, matrix, sizeof(prev_matrix));
-    memcpy(current_matrix, matrix, sizeof(current_matrix));
+    return &seq.pending[seq.pending_index];
 }
 
 // Продвинутая система анимации для естественного разговора
-void setup_talking_animation(const std::string& text, uint32_t total_duration_ms, double mouth_speed,
-                            const uint8_t open_matrix[MATRIX_ROWS][MATRIX_COLS],
-                            const uint8_t closed_matrix[MATRIX_ROWS][MATRIX_COLS]) {
-    current_animation_sequence.clear();
+void setup_talking_animation(std::string_view text, uint32_t total_duration_ms, double mouth_speed,
+                            Matrix12x12& open_matrix, Matrix12x12& closed_matrix) {
+    HEAP_TAG("talking_sequence");
+    stop_talking_sequence();
     
     if (text.empty() || total_duration_ms == 0) {
         return;
@@ -140,100 +154,73 @@ void setup_talking_animation(const std::string& text, uint32_t total_duration_ms
     uint32_t open_duration = (cycle_duration_ms * 6) / 10;
     uint32_t closed_duration = (cycle_duration_ms * 4) / 10;
     
-    printf("[TALKING_NATURAL] Setup: text='%s', syllables=%d, total_duration=%lu ms\n",
-           text.c_str(), syllables, total_duration_ms);
+    printf("[TALKING_NATURAL] Setup: text='%.*s', syllables=%d, total_duration=%lu ms\n",
+           (int)text.size(), text.data(), syllables, total_duration_ms);
     printf("[TALKING_NATURAL] Cycle: %lu ms (open: %lu ms, closed: %lu ms), activity: %.2f\n",
            cycle_duration_ms, open_duration, closed_duration, activity_factor);
     
-    // Создаём естественную последовательность с вариациями
-    uint32_t accumulated_time = 0;
-    int cycle_count = 0;
-    
-    while (accumulated_time < total_duration_ms) {
-        // Добавляем естественные вариации (±20%)
-        uint32_t var_open = open_duration + (rand() % (open_duration / 5)) - (open_duration / 10);
-        uint32_t var_closed = closed_duration + (rand() % (closed_duration / 5)) - (closed_duration / 10);
-        
-        // Проверяем, помещается ли полный цикл
-        if (accumulated_time + var_open + var_closed <= total_duration_ms) {
-            current_animation_sequence.push_back({open_matrix, var_open, "OPEN"});
-            current_animation_sequence.push_back({closed_matrix, var_closed, "CLOSED"});
-            accumulated_time += var_open + var_closed;
-            cycle_count++;
-        } else {
-            // Последний неполный цикл
-            uint32_t remaining = total_duration_ms - accumulated_time;
-            if (remaining > 50) { // Минимум 50ms для показа
-                current_animation_sequence.push_back({open_matrix, remaining, "FINAL"});
-                accumulated_time = total_duration_ms;
-            }
-            break;
-        }
-        
-        // Иногда добавляем паузы для естественности (каждые 3-4 цикла)
-        if (cycle_count % 4 == 0 && accumulated_time + 100 < total_duration_ms) {
-            current_animation_sequence.push_back({closed_matrix, 100, "PAUSE"});
-            accumulated_time += 100;
-        }
-    }
+    talking_sequence = {};
+    talking_sequence.open_matrix = &open_matrix;
+    talking_sequence.closed_matrix = &closed_matrix;
+    talking_sequence.open_duration = open_duration;
+    talking_sequence.closed_duration = closed_duration;
+    talking_sequence.total_ms = total_duration_ms;
+    sequence_active = true;
     
     current_frame_index = 0;
     frame_start_time = to_ms_since_boot(get_absolute_time());
-    
-    printf("[TALKING_NATURAL] Created %d frames in %d cycles, planned duration: %lu ms\n",
-           (int)current_animation_sequence.size(), cycle_count, accumulated_time);
 }
 
 // Обновление естественной анимации (вызывается каждый кадр)
 bool update_animation() {
-    if (current_animation_sequence.empty()) {
-        return false;
+    const AnimationFrame* current_frame = sequence_frame();
+    if (!current_frame) {
+        if (sequence_active) {
+            printf("[TALKING_NATURAL] Animation sequence completed (%d frames processed)\n",
+                   (int)current_frame_index);
+        }
+        return false; // Анимация завершена
     }
     
     uint32_t current_time = to_ms_since_boot(get_absolute_time());
     uint32_t elapsed = current_time - frame_start_time;
     
-    if (current_frame_index >= current_animation_sequence.size()) {
-        printf("[TALKING_NATURAL] Animation sequence completed (%d frames processed)\n", 
-               (int)current_animation_sequence.size());
-        return false; // Анимация завершена
-    }
-    
-    const AnimationFrame& current_frame = current_animation_sequence[current_frame_index];
-    
-    if (elapsed >= current_frame.duration_ms) {
+    if (elapsed >= current_frame->duration_ms) {
+        uint32_t intended_ms = frame_start_time + current_frame->duration_ms;
+
         // Переход к следующему кадру
         current_frame_index++;
+        talking_sequence.pending_index++;
         frame_start_time = current_time;
         
-        if (current_frame_index < current_animation_sequence.size()) {
-            const AnimationFrame& next_frame = current_animation_sequence[current_frame_index];
-            draw_matrix(next_frame.matrix, PIXEL_SIZE, false);
+        const AnimationFrame* next_frame = sequence_frame();
+        if (next_frame) {
+            frame_stats_schedule(intended_ms * 1000);
+            compositor_set_mouth(*next_frame->matrix);
             
             // Показываем прогресс каждые 10 кадров для уменьшения спама
             if (current_frame_index % 10 == 0 || current_frame_index < 5) {
-                printf("[TALKING_NATURAL] Frame %d/%d: %s (%lu ms)\n",
-                       (int)current_frame_index + 1, (int)current_animation_sequence.size(),
-                       next_frame.name, next_frame.duration_ms);
+                printf("[TALKING_NATURAL] Frame %d: %s (%lu ms)\n",
+                       (int)current_frame_index + 1, next_frame->name, next_frame->duration_ms);
             }
         }
         
-        return current_frame_index < current_animation_sequence.size();
+        return next_frame != nullptr;
     } else {
-        // Отображаем текущий кадр (только если нужно)
+        // Текущий кадр рта; рисует talking_logic через композитор
+        compositor_set_mouth(*current_frame->matrix);
         if (current_frame_index == 0 || animation_dirty) {
-            draw_matrix(current_frame.matrix, PIXEL_SIZE, animation_dirty);
             animation_dirty = false;
             if (current_frame_index == 0) {
                 printf("[TALKING_NATURAL] Starting first frame: %s (%lu ms)\n",
-                       current_frame.name, current_frame.duration_ms);
+                       current_frame->name, current_frame->duration_ms);
             }
         }
         return true;
     }
 }
 
-int count_syllables(const std::string& text) {
+int count_syllables(std::string_view text) {
     int count = 0;
     for (char c : text) {
         if (strchr(VOWELS, tolower(c))) {
@@ -245,6 +232,7 @@ int count_syllables(const std::string& text) {
 
 // Simple emotion functions
 void neutral(double speed, NeutralState& state) {
+    TRACE_SCOPE(TRACE_EMOTION_NEUTRAL);
     uint32_t current_time = to_ms_since_boot(get_absolute_time());
     
     // Моргание каждые 3-5 секунд с вариациями
@@ -259,8 +247,10 @@ void neutral(double speed, NeutralState& state) {
     
     // Зевота каждые 10-15 секунд
     if (current_time - state.last_yawn > (10000 + (rand() % 5000))) {
-        draw_matrix(NEUTRAL_YAWN, PIXEL_SIZE, false);
+        draw_matrix(NEUTRAL_YAWN);
+        TRACE_BEGIN(TRACE_YAWN_WAIT);
         busy_wait_ms(800); // Короткая пауза вместо sleep_ms
+        TRACE_END(TRACE_YAWN_WAIT);
         state.last_yawn = current_time;
         return;
     }
@@ -268,121 +258,261 @@ void neutral(double speed, NeutralState& state) {
     // Плавная анимация моргания
     if (state.blink) {
         uint32_t blink_time = current_time - state.blink_start;
+
+        // Фазы 1-3 сменяются каждые 100 мс, фаза 4 - глаза снова открыты
+        uint8_t phase = blink_time < 300 ? blink_time / 100 + 1 : 4;
+        if (phase != state.blink_phase) {
+            state.blink_phase = phase;
+            frame_stats_schedule((state.blink_start + (phase - 1) * 100) * 1000);
+        }
         if (blink_time < 100) {
-            draw_matrix(NEUTRAL_HALF_BLINK, PIXEL_SIZE, false);
+            draw_matrix(NEUTRAL_HALF_BLINK);
+            eyes_set_blink(50);
         } else if (blink_time < 200) {
-            draw_matrix(NEUTRAL_BLINK, PIXEL_SIZE, false);
+            draw_matrix(NEUTRAL_BLINK);
+            eyes_set_blink(0);
         } else if (blink_time < 300) {
-            draw_matrix(NEUTRAL_HALF_BLINK, PIXEL_SIZE, false);
+            draw_matrix(NEUTRAL_HALF_BLINK);
+            eyes_set_blink(50);
         } else {
-            draw_matrix(NEUTRAL_NO_BLINK, PIXEL_SIZE, false);
+            draw_matrix(NEUTRAL_NO_BLINK);
+            eyes_set_blink(100);
             state.blink = false;
         }
     } else {
-        draw_matrix(NEUTRAL_NO_BLINK, PIXEL_SIZE, false);
+        draw_matrix(NEUTRAL_NO_BLINK);
+    }
+
+    // Процедурные глаза рисует главный цикл. Пока хост не управляет взглядом,
+    // при моргании глаза переводятся в сторону pupil_direction
+    if (eyes_enabled() && !gaze_stream_active()) {
+        if (state.blink && state.blink_phase == 2 && eyes_params_age_ms() > NEUTRAL_IDLE_GAZE_MS) {
+            EyeParams params = eyes_get_params();
+            if (params.gaze_x != state.pupil_direction * 33) {
+                params.gaze_x = state.pupil_direction * 33;
+                eyes_set_params(params);
+                state.pupil_direction = (rand() % 7) - 3;
+            }
+        }
     }
 }
 
 void smile_pixel(double speed, AnimState& state, uint32_t duration) {
+    TRACE_SCOPE(TRACE_EMOTION_SMILE);
     if (!state.animating) {
         printf("[SMILE] Starting animation with speed=%.2f, duration=%lu\n", speed, duration);
     }
     anime_logic(state, speed, duration, 
-               (const uint8_t*)SMILE_B, (const uint8_t*)SMILE_A, 
-               (const uint8_t*)SMILE_B, (const uint8_t*)SMILE_A, 
-               (const uint8_t*)SMILE);
+               &SMILE_B, &SMILE_A, 
+               &SMILE_B, &SMILE_A, 
+               &SMILE);
 }
 
 void smile_love_pixel(double speed, AnimState& state, uint32_t duration) {
+    TRACE_SCOPE(TRACE_EMOTION_SMILE_LOVE);
     if (!state.animating) {
         printf("[SMILE_LOVE] Starting animation with speed=%.2f, duration=%lu\n", speed, duration);
     }
     anime_logic(state, speed, duration,
-               (const uint8_t*)SMILE_LOVE, (const uint8_t*)SMILE_LOVE_A,
-               (const uint8_t*)SMILE_LOVE_B, (const uint8_t*)SMILE_LOVE_A,
-               (const uint8_t*)SMILE);
+               &SMILE_LOVE, &SMILE_LOVE_A,
+               &SMILE_LOVE_B, &SMILE_LOVE_A,
+               &SMILE);
 }
 
 void embarrassed_pixel(double speed, AnimState& state) {
-    draw_matrix(EMBARRASSED, PIXEL_SIZE, false);
+    TRACE_SCOPE(TRACE_EMOTION_EMBARRASSED);
+    draw_matrix(EMBARRASSED);
 }
 
 void scary_pixel(double speed, AnimState& state, uint32_t duration) {
+    TRACE_SCOPE(TRACE_EMOTION_SCARY);
     if (!state.animating) {
         printf("[SCARY] Starting animation with speed=%.2f, duration=%lu\n", speed, duration);
     }
     anime_logic(state, speed, duration,
-               (const uint8_t*)SCARY_B, (const uint8_t*)SCARY_C,
-               (const uint8_t*)SCARY_D, (const uint8_t*)SCARY_C,
-               (const uint8_t*)SCARY_A);
+               &SCARY_B, &SCARY_C,
+               &SCARY_D, &SCARY_C,
+               &SCARY_A);
 }
 
 void happy_pixel(double speed, AnimState& state, uint32_t duration) {
+    TRACE_SCOPE(TRACE_EMOTION_HAPPY);
     if (!state.animating) {
         printf("[HAPPY] Starting animation with speed=%.2f, duration=%lu\n", speed, duration);
     }
     anime_logic(state, speed, duration,
-               (const uint8_t*)SMILE, (const uint8_t*)SMILE_A,
-               (const uint8_t*)SMILE, (const uint8_t*)HAPPY,
-               (const uint8_t*)HAPPY);
+               &SMILE, &SMILE_A,
+               &SMILE, &HAPPY,
+               &HAPPY);
 }
 
 void sad_pixel(double speed, AnimState& state, uint32_t duration) {
+    TRACE_SCOPE(TRACE_EMOTION_SAD);
     if (!state.animating) {
         printf("[SAD] Starting animation with speed=%.2f, duration=%lu\n", speed, duration);
     }
     anime_logic(state, speed, duration,
-               (const uint8_t*)SAD_A, (const uint8_t*)SAD_A,
-               (const uint8_t*)SAD, (const uint8_t*)SAD,
-               (const uint8_t*)SAD_A);
+               &SAD_A, &SAD_A,
+               &SAD, &SAD,
+               &SAD_A);
 }
 
 void surprise_pixel(double speed, AnimState& state, uint32_t duration) {
+    TRACE_SCOPE(TRACE_EMOTION_SURPRISE);
     if (!state.animating) {
         printf("[SURPRISE] Starting animation with speed=%.2f, duration=%lu\n", speed, duration);
     }
     anime_logic(state, speed, duration,
-               (const uint8_t*)NEUTRAL_NO_BLINK, (const uint8_t*)SURPRISE,
-               (const uint8_t*)SURPRISE, (const uint8_t*)SURPRISE,
-               (const uint8_t*)NEUTRAL_NO_BLINK);
+               &NEUTRAL_NO_BLINK, &SURPRISE,
+               &SURPRISE, &SURPRISE,
+               &NEUTRAL_NO_BLINK);
+}
+
+// Загруженный ассет рисуется прямо из флеша, как встроенные лица
+// Клип декодируется из флеша кадр за кадром; рендерер сам находит изменившиеся клетки
+static void clip_pixel(const FaceAssetEntry* asset, AnimState& state, uint32_t current_time) {
+    static FaceClipPlayer player;
+    if (!state.animating) {
+        if (!face_clip_open(player, face_asset_clip(asset), asset->size)) {
+            return;
+        }
+        state.animating = true;
+        state.cycle_count = 0;
+        state.start_time = current_time;
+        state.last_frame = current_time;
+        printf("[ASSET] Playing clip '%s': %d frames\n", asset->name, player.frame_count);
+        draw_matrix(player.cells, true);
+        return;
+    }
+
+    if (current_time - state.last_frame >= player.duration_ms) {
+        uint32_t intended_ms = state.last_frame + player.duration_ms;
+        if (!face_clip_next(player)) {
+            printf("[ASSET] Clip '%s' ends early, restarting\n", asset->name);
+        }
+        if (player.frame == 0) {
+            state.cycle_count++;
+        }
+        frame_stats_schedule(intended_ms * 1000);
+        draw_matrix(player.cells);
+        state.last_frame = current_time;
+    }
 }
 
+void asset_pixel(const FaceAssetEntry* asset, AnimState& state) {
+    if (asset->type == FACE_ASSET_FACE) {
+        draw_matrix(face_asset_face(asset)->cells, !state.animating);
+        state.animating = true;
+        return;
+    }
+
+    uint32_t current_time = to_ms_since_boot(get_absolute_time());
+    if (asset->type == FACE_ASSET_CLIP) {
+        clip_pixel(asset, state, current_time);
+        return;
+    }
+
+    const FaceAssetFrame* frames = face_asset_frames(asset);
+    if (!state.animating) {
+        state.animating = true;
+        state.frame = 0;
+        state.cycle_count = 0;
+        state.start_time = current_time;
+        state.last_frame = current_time;
+        printf("[ASSET] Playing '%s': %d frames\n", asset->name, asset->frame_count);
+        draw_matrix(face_asset_frame_face(frames[0])->cells, true);
+        return;
+    }
+
+    // Кадры идут по кругу, пока не истечёт длительность эмоции
+    const FaceAssetFrame& frame = frames[state.frame];
+    if (current_time - state.last_frame >= frame.duration_ms) {
+        uint32_t intended_ms = state.last_frame + frame.duration_ms;
+        state.frame = (state.frame + 1) % asset->frame_count;
+        if (state.frame == 0) {
+            state.cycle_count++;
+        }
+        frame_stats_schedule(intended_ms * 1000);
+        draw_matrix(face_asset_frame_face(frames[state.frame])->cells);
+        state.last_frame = current_time;
+    }
+}
+
+// Глаза для разговора по эмоции
+struct TalkingEyesEntry {
+    const char* emotion;
+    TalkingEyes eyes;
+};
+
+static const TalkingEyesEntry TALKING_EYES[] = {
+    {"neutral",      {&NEUTRAL_NO_BLINK, false}},
+    {"angry",        {&ANGRY_CLOSED, false}},
+    {"smile",        {&SMILE, false}},
+    {"smile_love",   {&SMILE_LOVE, false}},
+    {"smile_tricky", {&TALKING_TRICKY_A, false}},
+    {"tricky",       {&SMILE_TRICKY_A, false}},
+    {"ha",           {&HAPPY_CIRCLE, false}},
+    {"happy",        {&HAPPY, false}},
+    {"sad",          {&SAD, false}},
+    {"surprise",     {&SURPRISE, false}},
+    {"embarrassed",  {&EMBARRASSED, true}},
+    {"scary",        {&SCARY_A, false}},
+};
+
+// Рот для разговора по эмоции: открыт / закрыт / в покое
+struct TalkingMouthEntry {
+    const char* emotion;
+    TalkingMouth mouth;
+};
+
+static const TalkingMouthEntry TALKING_MOUTHS[] = {
+    {"neutral",      {&TALKING_A, &TALKING_B, &NEUTRAL_NO_BLINK}},
+    {"angry",        {&ANGRY_OPEN_MOUTH, &ANGRY_CLOSED_MOUTH, &ANGRY_CLOSED}},
+    {"smile_tricky", {&TALKING_TRICKY_A, &TALKING_TRICKY_B, &SMILE_A}},
+    {"tricky",       {&SMILE_TRICKY_A, &SMILE_TRICKY_B, &NEUTRAL_NO_BLINK}},
+    {"smile",        {&SMILE, &TALKING_A, &NEUTRAL_NO_BLINK}},
+    {"ha",           {&HAPPY_CIRCLE, &NEUTRAL_CIRCLE, &NEUTRAL_NO_BLINK}},
+    // Рты с ряда 8: ряд 7 занят румянцем
+    {"embarrassed",  {&HAPPY_CIRCLE, &NEUTRAL_CIRCLE, &EMBARRASSED}},
+};
+
+// Румянец там же, где в EMBARRASSED: ряд 7, под каждым глазом
+static const int BLUSH_ROW = 7;
+static const int BLUSH_LEFT_COL = 2;
+static const int BLUSH_RIGHT_COL = 8;
+
 void talking_pixel(uint32_t duration, double speed, TalkingState& state,
-                  const std::string& text, double mouth_speed, const std::string& emotion) {
-    
-    printf("[TALKING] Called with: duration=%lu, speed=%.2f, mouth_speed=%.2f, emotion='%s', text='%s'\n",
-           duration, speed, mouth_speed, emotion.c_str(), text.c_str());
-    
-    if (emotion == "neutral") {
-        talking_logic(state, text, duration, speed, mouth_speed, 
-                     TALKING_A, TALKING_B, NEUTRAL_NO_BLINK);
-    } else if (emotion == "angry") {
-        talking_logic(state, text, duration, speed, mouth_speed, 
-                     ANGRY_OPEN_MOUTH, ANGRY_CLOSED_MOUTH, ANGRY_CLOSED);
-    } else if (emotion == "smile_tricky") {
-        talking_logic(state, text, duration, speed, mouth_speed, 
-                     TALKING_TRICKY_A, TALKING_TRICKY_B, SMILE_A);
-    } else if (emotion == "tricky") {
-        talking_logic(state, text, duration, speed, mouth_speed, 
-                     SMILE_TRICKY_A, SMILE_TRICKY_B, NEUTRAL_NO_BLINK);
-    } else if (emotion == "smile") {
-        talking_logic(state, text, duration, speed, mouth_speed, 
-                     SMILE, TALKING_A, NEUTRAL_NO_BLINK);
-    } else if (emotion == "ha") {
-        talking_logic(state, text, duration, speed, mouth_speed, 
-                     HAPPY_CIRCLE, NEUTRAL_CIRCLE, NEUTRAL_NO_BLINK);
-    } else {
-        // По умолчанию используем нейтральный разговор
-        talking_logic(state, text, duration, speed, mouth_speed, 
-                     TALKING_A, TALKING_B, NEUTRAL_NO_BLINK);
+                  std::string_view text, double mouth_speed, std::string_view emotion) {
+    TRACE_SCOPE(TRACE_EMOTION_TALKING);
+
+    printf("[TALKING] Called with: duration=%lu, speed=%.2f, mouth_speed=%.2f, emotion='%.*s', text='%.*s'\n",
+           duration, speed, mouth_speed, (int)emotion.size(), emotion.data(), (int)text.size(), text.data());
+
+    // По умолчанию (первая запись таблицы) - нейтральный разговор, глаза и рот выбираются независимо
+    const TalkingEyes* eyes = &TALKING_EYES[0].eyes;
+    for (const TalkingEyesEntry& entry : TALKING_EYES) {
+        if (emotion == entry.emotion) {
+            eyes = &entry.eyes;
+            break;
+        }
+    }
+    const TalkingMouth* mouth = &TALKING_MOUTHS[0].mouth;
+    for (const TalkingMouthEntry& entry : TALKING_MOUTHS) {
+        if (emotion == entry.emotion) {
+            mouth = &entry.mouth;
+            break;
+        }
     }
+
+    talking_logic(state, text, duration, speed, mouth_speed, *eyes, *mouth);
 }
 
-// Stub functions
+// Четырёхкадровая анимация для лица любого размера
+template <int Rows, int Cols>
 void anime_logic(AnimState& state, double speed, uint32_t duration,
-                const uint8_t* matrix_start, const uint8_t* matrix_anim_a,
-                const uint8_t* matrix_anim_b, const uint8_t* matrix_anim_c,
-                const uint8_t* matrix_end) {
+                FaceMatrix<Rows, Cols>* matrix_start, FaceMatrix<Rows, Cols>* matrix_anim_a,
+                FaceMatrix<Rows, Cols>* matrix_anim_b, FaceMatrix<Rows, Cols>* matrix_anim_c,
+                FaceMatrix<Rows, Cols>* matrix_end) {
     
     uint32_t current_time = to_ms_since_boot(get_absolute_time());
     
@@ -395,7 +525,7 @@ void anime_logic(AnimState& state, double speed, uint32_t duration,
         state.cycle_count = 0;
         
         if (matrix_start) {
-            draw_matrix((const uint8_t(*)[MATRIX_COLS])matrix_start, PIXEL_SIZE, true);
+            draw_matrix(*matrix_start, true);
         }
         printf("[ANIME_SMOOTH] Starting: duration=%lu ms, speed=%.2f\n", duration, speed);
         return;
@@ -404,7 +534,7 @@ void anime_logic(AnimState& state, double speed, uint32_t duration,
     // Если анимация не активна и duration <= 2, показываем статичную картинку
     if (!state.animating && duration <= 2) {
         if (matrix_start) {
-            draw_matrix((const uint8_t(*)[MATRIX_COLS])matrix_start, PIXEL_SIZE, false);
+            draw_matrix(*matrix_start);
         }
         return;
     }
@@ -422,10 +552,11 @@ void anime_logic(AnimState& state, double speed, uint32_t duration,
             }
             
             if (current_time - state.last_frame >= frame_duration) {
+                uint32_t intended_ms = state.last_frame + frame_duration;
                 state.frame = (state.frame + 1) % 4;
                 state.cycle_count = elapsed_time / (frame_duration * 2);
                 
-                const uint8_t* current_matrix = nullptr;
+                FaceMatrix<Rows, Cols>* current_matrix = nullptr;
                 
                 switch (state.frame) {
                     case 0: current_matrix = matrix_start; break;
@@ -435,7 +566,8 @@ void anime_logic(AnimState& state, double speed, uint32_t duration,
                 }
                 
                 if (current_matrix) {
-                    draw_matrix((const uint8_t(*)[MATRIX_COLS])current_matrix, PIXEL_SIZE, false);
+                    frame_stats_schedule(intended_ms * 1000);
+                    draw_matrix(*current_matrix);
                 }
                 
                 state.last_frame = current_time;
@@ -444,32 +576,45 @@ void anime_logic(AnimState& state, double speed, uint32_t duration,
             // Завершение анимации
             state.animating = false;
             if (matrix_end) {
-                draw_matrix((const uint8_t(*)[MATRIX_COLS])matrix_end, PIXEL_SIZE, true);
+                draw_matrix(*matrix_end, true);
             }
             printf("[ANIME_SMOOTH] Animation completed\n");
         }
     }
 }
 
-void talking_logic(TalkingState& state, const std::string& text, uint32_t duration,
+#define INSTANTIATE_ANIME_LOGIC(rows, cols)                                          \
+    template void anime_logic<rows, cols>(AnimState&, double, uint32_t,              \
+                                          FaceMatrix<rows, cols>*, FaceMatrix<rows, cols>*, \
+                                          FaceMatrix<rows, cols>*, FaceMatrix<rows, cols>*, \
+                                          FaceMatrix<rows, cols>*);
+FACE_GEOMETRY_LIST(INSTANTIATE_ANIME_LOGIC)
+
+static void set_talking_eyes(const TalkingEyes& eyes) {
+    compositor_set_eyes(*eyes.eyes);
+    compositor_set_overlay(0, eyes.blush ? &BLUSH_CHEEK_SPRITE : nullptr, BLUSH_ROW, BLUSH_LEFT_COL);
+    compositor_set_overlay(1, eyes.blush ? &BLUSH_CHEEK_SPRITE : nullptr, BLUSH_ROW, BLUSH_RIGHT_COL);
+}
+
+void talking_logic(TalkingState& state, std::string_view text, uint32_t duration,
                   double speed, double mouth_speed,
-                  const uint8_t open_matrix[MATRIX_ROWS][MATRIX_COLS],
-                  const uint8_t closed_matrix[MATRIX_ROWS][MATRIX_COLS],
-                  const uint8_t neutral_matrix[MATRIX_ROWS][MATRIX_COLS]) {
+                  const TalkingEyes& eyes, const TalkingMouth& mouth) {
     
     uint32_t current_time = to_ms_since_boot(get_absolute_time());
+    set_talking_eyes(eyes);
     
     // Начинаем новую анимацию разговора с улучшенной синхронизацией
     if (!text.empty() && !state.talking) {
         state.talking = true;
         state.start_time = current_time;
         
-        printf("[TALKING_NATURAL] Starting natural speech: '%s'\n", text.c_str());
+        printf("[TALKING_NATURAL] Starting natural speech: '%.*s'\n", (int)text.size(), text.data());
         printf("[TALKING_NATURAL] Duration: %lu ms, mouth_speed: %.2f (lower=faster movement)\n", 
                duration * 1000, mouth_speed);
         
         // Настраиваем естественную систему анимации
-        setup_talking_animation(text, duration * 1000, mouth_speed, open_matrix, closed_matrix);
+        setup_talking_animation(text, duration * 1000, mouth_speed, *mouth.open, *mouth.closed);
+        subtitles_start(text, duration * 1000);
         animation_dirty = true;
         return;
     }
@@ -479,23 +624,31 @@ void talking_logic(TalkingState& state, const std::string& text, uint32_t durati
         uint32_t elapsed_time = current_time - state.start_time;
         
         if (elapsed_time < speech_duration) {
-            // Обновляем естественную анимацию без блокировок
+            // Обновляем естественную анимацию без блокировок: меняется только слой рта
+            bool force_redraw = animation_dirty;
             bool animation_active = update_animation();
             
             if (!animation_active) {
-                // Анимация завершена раньше времени - показываем нейтральное лицо
-                printf("[TALKING_NATURAL] Animation sequence completed early, showing neutral\n");
-                draw_matrix(neutral_matrix, PIXEL_SIZE, false);
+                // Анимация завершена раньше времени - рот в покое
+                if (sequence_active) {
+                    printf("[TALKING_NATURAL] Animation sequence completed early, showing neutral\n");
+                    stop_talking_sequence();
+                }
+                compositor_set_mouth(*mouth.rest);
             }
+            compositor_present(force_redraw);
         } else {
             // Завершение разговора
             state.talking = false;
-            current_animation_sequence.clear();
-            draw_matrix(neutral_matrix, PIXEL_SIZE, true);
-            printf("[TALKING_NATURAL] Natural speech completed: '%s'\n", text.c_str());
+            stop_talking_sequence();
+            compositor_set_mouth(*mouth.rest);
+            compositor_present(true);
+            subtitles_clear();
+            printf("[TALKING_NATURAL] Natural speech completed: '%.*s'\n", (int)text.size(), text.data());
         }
     } else {
-        // Показываем нейтральное лицо когда не разговариваем
-        draw_matrix(neutral_matrix, PIXEL_SIZE, false);
+        // Показываем лицо в покое когда не разговариваем
+        compositor_set_mouth(*mouth.rest);
+        compositor_present();
     }
 }
@@ -0,0 +1,305 @@
+#include "eyes.h"
+#include "face_renderer.h"
+#include "emotions.h"
+#include "trace.h"
+#include "pico/stdlib.h"
+#include <stdio.h>
+#include <cstring>
+#include <algorithm>
+
+// Use C driver directly
+extern "C" {
+#include "pico/st7789.h"
+}
+
+using Geometry = FaceGeometry<MATRIX_ROWS, MATRIX_COLS>;
+
+static const int BOX_WIDTH = EYE_BOX_COLS * Geometry::CELL_SIZE;
+static const int BOX_HEIGHT = (EYE_BOX_LAST_ROW - EYE_BOX_FIRST_ROW + 1) * Geometry::CELL_SIZE;
+static const int BOX_Y = Geometry::Y_OFFSET + EYE_BOX_FIRST_ROW * Geometry::CELL_SIZE;
+static const int BOX_FIRST_COL[2] = {EYE_BOX_LEFT_FIRST_COL, EYE_BOX_RIGHT_FIRST_COL};
+static const int BOX_X[2] = {
+    Geometry::X_OFFSET + EYE_BOX_LEFT_FIRST_COL * Geometry::CELL_SIZE,
+    Geometry::X_OFFSET + EYE_BOX_RIGHT_FIRST_COL * Geometry::CELL_SIZE
+};
+
+// Глаз битмапов - 2x4 клетки
+static const int EYE_WIDTH = 2 * Geometry::CELL_SIZE;
+static const int EYE_HEIGHT = 4 * Geometry::CELL_SIZE;
+
+static_assert(BOX_WIDTH <= 255, "Eye spans are stored as uint8_t");
+
+// Участок строки бокса [x0, x1) одного индекса палитры
+struct EyeSpan {
+    uint8_t x0;
+    uint8_t x1;
+    uint8_t index;
+};
+
+// В боксе 4 клетки - не больше 4 участков в строке
+#define EYE_LINE_MAX_SPANS EYE_BOX_COLS
+
+struct EyeLine {
+    uint8_t count;
+    EyeSpan spans[EYE_LINE_MAX_SPANS];
+
+    bool operator==(const EyeLine& other) const {
+        if (count != other.count) {
+            return false;
+        }
+        for (int i = 0; i < count; i++) {
+            if (spans[i].x0 != other.spans[i].x0 || spans[i].x1 != other.spans[i].x1
+                || spans[i].index != other.spans[i].index) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void add(int x0, int x1, uint8_t index) {
+        x0 = std::max(x0, 0);
+        x1 = std::min(x1, BOX_WIDTH);
+        if (x1 <= x0) {
+            return;
+        }
+        // Соседние клетки одного цвета - один участок
+        if (count > 0 && spans[count - 1].x1 == x0 && spans[count - 1].index == index) {
+            spans[count - 1].x1 = x1;
+        } else if (count < EYE_LINE_MAX_SPANS) {
+            spans[count++] = {(uint8_t)x0, (uint8_t)x1, index};
+        }
+    }
+};
+
+static bool enabled = false;
+static EyeSource source = EYE_SOURCE_PROCEDURAL;
+static int box_height = BOX_HEIGHT;
+static bool drawn = false;  // lines on screen are valid
+static EyeParams params;
+static uint8_t blink_openness = 100;
+static uint32_t params_time_ms = 0;
+static EyeLine screen_lines[2][BOX_HEIGHT];
+static EyeLine next_lines[BOX_HEIGHT];
+static Palette drawn_palette;
+static uint16_t line[BOX_WIDTH];
+
+static uint32_t isqrt(uint32_t value) {
+    uint32_t root = 0;
+    uint32_t bit = 1u << 30;
+    while (bit > value) {
+        bit >>= 2;
+    }
+    while (bit) {
+        if (value >= root + bit) {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
+
+// Скруглённый прямоугольник глаза построчно, только целые числа.
+// Координаты удвоены, чтобы центры пикселей (x + 0.5) были целыми.
+static void rasterize_procedural(const EyeParams& p, uint8_t openness, EyeLine (&lines)[BOX_HEIGHT]) {
+    int half_w2 = EYE_WIDTH * p.size / 100;
+    int half_h2 = EYE_HEIGHT * p.size / 100;
+    int radius2 = std::min(half_w2, half_h2);
+    int straight2 = half_h2 - radius2;
+
+    int travel_x = BOX_WIDTH - half_w2;  // удвоенный свободный ход = BOX - ширина
+    int travel_y = BOX_HEIGHT - half_h2;
+    int cx2 = BOX_WIDTH + p.gaze_x * travel_x / 100;
+    int cy2 = BOX_HEIGHT + p.gaze_y * travel_y / 100;
+
+    // Веки закрываются к центру, сомкнутые оставляют полоску в четверть клетки
+    int lid2 = std::max(half_h2 * openness / 100, Geometry::CELL_SIZE / 4);
+
+    for (int y = 0; y < BOX_HEIGHT; y++) {
+        int dy2 = std::abs(2 * y + 1 - cy2);
+        lines[y].count = 0;
+        if (dy2 > lid2 || dy2 > half_h2) {
+            continue;
+        }
+        int extent2 = half_w2;
+        if (dy2 > straight2) {
+            int d = dy2 - straight2;
+            extent2 = half_w2 - radius2 + (int)isqrt(radius2 * radius2 - d * d);
+        }
+        lines[y].add((cx2 - extent2) / 2, (cx2 + extent2 + 1) / 2, PALETTE_FACE);
+    }
+}
+
+// Клетки глаз текущего лица со сдвигом: по горизонтали до клетки, по вертикали до половины
+static void rasterize_face_cells(const EyeParams& p, int eye, EyeLine (&lines)[BOX_HEIGHT]) {
+    const PackedCells<MATRIX_ROWS, MATRIX_COLS>& screen = main_face_renderer().screen();
+    int dx = p.gaze_x * Geometry::CELL_SIZE / 100;
+    int dy = p.gaze_y * Geometry::CELL_SIZE / 200;
+
+    for (int y = 0; y < box_height; y++) {
+        lines[y].count = 0;
+        int source_y = y - dy;
+        if (source_y < 0 || source_y >= box_height) {
+            continue;
+        }
+        int row = EYE_BOX_FIRST_ROW + source_y / Geometry::CELL_SIZE;
+        for (int c = 0; c < EYE_BOX_COLS; c++) {
+            uint8_t index = screen.get(row, BOX_FIRST_COL[eye] + c);
+            if (index != PALETTE_BG) {
+                lines[y].add(c * Geometry::CELL_SIZE + dx, (c + 1) * Geometry::CELL_SIZE + dx, index);
+            }
+        }
+    }
+}
+
+// Строки [first, last] бокса в окне [x0, x1)
+static void write_eye_lines(int eye, const EyeLine (&lines)[BOX_HEIGHT], int first, int last,
+                            int x0, int x1, const Palette& palette) {
+    st7789_set_window(BOX_X[eye] + x0, BOX_Y + first, BOX_X[eye] + x1 - 1, BOX_Y + last);
+    for (int y = first; y <= last; y++) {
+        std::fill(line, line + (x1 - x0), palette.colors[PALETTE_BG]);
+        for (int i = 0; i < lines[y].count; i++) {
+            const EyeSpan& span = lines[y].spans[i];
+            int span_x0 = std::max((int)span.x0, x0);
+            int span_x1 = std::min((int)span.x1, x1);
+            if (span_x1 > span_x0) {
+                std::fill(line + span_x0 - x0, line + span_x1 - x0, palette.colors[span.index]);
+            }
+        }
+        st7789_write(line, (x1 - x0) * sizeof(uint16_t));
+    }
+}
+
+// Новые строки одного глаза против того, что на экране: пишется полоса изменившихся
+// строк, окно - объединение старых и новых участков
+static bool update_eye(int eye, const EyeLine (&lines)[BOX_HEIGHT], bool full, const Palette& palette) {
+    EyeLine (&screen)[BOX_HEIGHT] = screen_lines[eye];
+    int first = 0;
+    int last = box_height - 1;
+    int x0 = 0;
+    int x1 = BOX_WIDTH;
+
+    if (!full) {
+        first = box_height;
+        last = -1;
+        x0 = BOX_WIDTH;
+        x1 = 0;
+        for (int y = 0; y < box_height; y++) {
+            if (screen[y] == lines[y]) {
+                continue;
+            }
+            first = std::min(first, y);
+            last = y;
+            const EyeLine* both[2] = {&screen[y], &lines[y]};
+            for (const EyeLine* changed : both) {
+                if (changed->count > 0) {
+                    x0 = std::min(x0, (int)changed->spans[0].x0);
+                    x1 = std::max(x1, (int)changed->spans[changed->count - 1].x1);
+                }
+            }
+        }
+        if (last < 0) {
+            return false;
+        }
+    }
+
+    write_eye_lines(eye, lines, first, last, x0, x1, palette);
+    std::copy(lines, lines + box_height, screen);
+    return true;
+}
+
+static void mask_boxes() {
+    auto& renderer = main_face_renderer();
+    int last_row = source == EYE_SOURCE_PROCEDURAL ? EYE_BOX_LAST_ROW : EYE_CELLS_LAST_ROW;
+    for (int eye = 0; eye < 2; eye++) {
+        renderer.mask_cells(EYE_BOX_FIRST_ROW, last_row,
+                            BOX_FIRST_COL[eye], BOX_FIRST_COL[eye] + EYE_BOX_COLS - 1);
+    }
+    box_height = (last_row - EYE_BOX_FIRST_ROW + 1) * Geometry::CELL_SIZE;
+}
+
+void eyes_enable(EyeSource new_source) {
+    if (enabled && source == new_source) {
+        return;
+    }
+    auto& renderer = main_face_renderer();
+    if (enabled) {
+        // Другой источник - другая маска, освободившиеся клетки рисует лицо
+        renderer.clear_mask();
+        renderer.invalidate();
+    }
+    enabled = true;
+    source = new_source;
+    drawn = false;
+    mask_boxes();
+    printf("[EYES] Eye layer enabled: %s\n", source == EYE_SOURCE_PROCEDURAL ? "procedural" : "face cells");
+}
+
+void eyes_disable() {
+    if (!enabled) {
+        return;
+    }
+    enabled = false;
+    auto& renderer = main_face_renderer();
+    renderer.clear_mask();
+    renderer.invalidate();
+    printf("[EYES] Eye layer disabled\n");
+}
+
+bool eyes_enabled() {
+    return enabled;
+}
+
+void eyes_set_params(const EyeParams& new_params) {
+    eyes_set_gaze(new_params.gaze_x, new_params.gaze_y);
+    params.openness = std::min<uint8_t>(100, new_params.openness);
+    params.size = std::max<uint8_t>(50, std::min<uint8_t>(100, new_params.size));
+    params_time_ms = to_ms_since_boot(get_absolute_time());
+}
+
+void eyes_set_gaze(int8_t gaze_x, int8_t gaze_y) {
+    params.gaze_x = std::max<int8_t>(-100, std::min<int8_t>(100, gaze_x));
+    params.gaze_y = std::max<int8_t>(-100, std::min<int8_t>(100, gaze_y));
+}
+
+uint32_t eyes_params_age_ms() {
+    return to_ms_since_boot(get_absolute_time()) - params_time_ms;
+}
+
+const EyeParams& eyes_get_params() {
+    return params;
+}
+
+void eyes_set_blink(uint8_t openness) {
+    blink_openness = std::min<uint8_t>(100, openness);
+}
+
+bool eyes_update() {
+    // Пока лицо не нарисовано, рамка и фон вокруг боксов ещё не на экране
+    if (!enabled || !main_face_renderer().is_initialized()) {
+        return false;
+    }
+
+    const Palette& palette = get_active_palette();
+    bool full = !drawn || std::memcmp(&palette, &drawn_palette, sizeof(Palette)) != 0;
+    bool written = false;
+
+    TRACE_SCOPE(TRACE_DRAW_EYES);
+    if (source == EYE_SOURCE_PROCEDURAL) {
+        // Оба глаза одинаковы - растеризуем один раз
+        rasterize_procedural(params, params.openness * blink_openness / 100, next_lines);
+        written |= update_eye(0, next_lines, full, palette);
+        written |= update_eye(1, next_lines, full, palette);
+    } else {
+        for (int eye = 0; eye < 2; eye++) {
+            rasterize_face_cells(params, eye, next_lines);
+            written |= update_eye(eye, next_lines, full, palette);
+        }
+    }
+
+    drawn_palette = palette;
+    drawn = true;
+    return written;
+}
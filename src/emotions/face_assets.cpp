@@ -0,0 +1,384 @@
+#include "face_assets.h"
+#include "face_clip.h"
+#include "display_list.h"
+#include "pico/stdlib.h"
+#include "hardware/flash.h"
+#include "hardware/sync.h"
+#include "hardware/regs/addressmap.h"
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+
+static_assert(FACE_ASSETS_SIZE % FLASH_SECTOR_SIZE == 0 && FACE_ASSETS_SIZE > FLASH_SECTOR_SIZE,
+              "FACE_ASSETS_SIZE must be a whole number of sectors, index plus records");
+
+// Область в конце флеша; прошивка не должна до неё дорасти
+static const uint32_t ASSETS_OFFSET = PICO_FLASH_SIZE_BYTES - FACE_ASSETS_SIZE;
+static const uint32_t ASSETS_MAGIC = 0x31534146;  // "FAS1"
+static const uint32_t RECORDS_START = FLASH_SECTOR_SIZE;
+
+extern char __flash_binary_end;
+
+// Первый сектор: заголовок и записи индекса; стёртая запись - 0xFF
+struct FaceAssetIndex {
+    uint32_t magic;
+    uint32_t reserved;
+    FaceAssetEntry entries[(FLASH_SECTOR_SIZE - 8) / sizeof(FaceAssetEntry)];
+};
+static_assert(sizeof(FaceAssetIndex) <= FLASH_SECTOR_SIZE, "index must fit one sector");
+
+static const int MAX_ENTRIES = sizeof(FaceAssetIndex::entries) / sizeof(FaceAssetEntry);
+
+// Клип, загружаемый по частям; его запись индекса появится после последней части
+struct PendingClip {
+    bool active;
+    char name[FACE_ASSET_NAME_MAX + 1];
+    int entry_number;
+    uint32_t data_offset;
+    uint32_t size;
+    uint32_t written;
+};
+static PendingClip pending_clip;
+
+static const uint8_t* region() {
+    return (const uint8_t*)(XIP_BASE + ASSETS_OFFSET);
+}
+
+static const FaceAssetIndex& asset_index() {
+    return *(const FaceAssetIndex*)region();
+}
+
+static bool index_valid() {
+    return asset_index().magic == ASSETS_MAGIC;
+}
+
+static bool entry_used(const FaceAssetEntry& entry) {
+    return (uint8_t)entry.name[0] != 0xff;
+}
+
+static bool region_free_of_firmware() {
+    if ((uintptr_t)&__flash_binary_end - XIP_BASE > ASSETS_OFFSET) {
+        printf("[ASSETS] Firmware overlaps the asset region\n");
+        return false;
+    }
+    return true;
+}
+
+// Запись во флеш: страница дополняется 0xFF, так что уже записанные байты
+// соседей не меняются и можно дописывать с любого смещения
+static void flash_write(uint32_t offset, const void* data, uint32_t length) {
+    static uint8_t page[FLASH_PAGE_SIZE];
+    const uint8_t* src = (const uint8_t*)data;
+    while (length) {
+        uint32_t page_start = offset & ~(FLASH_PAGE_SIZE - 1);
+        uint32_t in_page = offset - page_start;
+        uint32_t chunk = std::min(length, FLASH_PAGE_SIZE - in_page);
+        memset(page, 0xff, sizeof(page));
+        memcpy(page + in_page, src, chunk);
+        uint32_t interrupts = save_and_disable_interrupts();
+        flash_range_program(ASSETS_OFFSET + page_start, page, FLASH_PAGE_SIZE);
+        restore_interrupts(interrupts);
+        offset += chunk;
+        src += chunk;
+        length -= chunk;
+    }
+}
+
+void face_asset_erase() {
+    if (!region_free_of_firmware()) {
+        return;
+    }
+    // DMA не должна читать флеш, пока он стирается
+    display_list_fence();
+    uint32_t interrupts = save_and_disable_interrupts();
+    flash_range_erase(ASSETS_OFFSET, FACE_ASSETS_SIZE);
+    restore_interrupts(interrupts);
+    pending_clip.active = false;
+    uint32_t header[2] = {ASSETS_MAGIC, 0};
+    flash_write(0, header, sizeof(header));
+    printf("[ASSETS] Erased %d KB at flash offset 0x%lx\n", FACE_ASSETS_SIZE / 1024, (unsigned long)ASSETS_OFFSET);
+}
+
+const FaceAssetEntry* face_asset_find(std::string_view name) {
+    if (!index_valid()) {
+        return nullptr;
+    }
+    const FaceAssetEntry* found = nullptr;
+    for (const FaceAssetEntry& entry : asset_index().entries) {
+        if (!entry_used(entry)) {
+            break;
+        }
+        if (name == entry.name) {
+            found = &entry;
+        }
+    }
+    return found;
+}
+
+const FaceAssetFace* face_asset_face(const FaceAssetEntry* entry) {
+    return (const FaceAssetFace*)(region() + entry->offset);
+}
+
+const FaceAssetFrame* face_asset_frames(const FaceAssetEntry* entry) {
+    return (const FaceAssetFrame*)(region() + entry->offset);
+}
+
+const uint8_t* face_asset_clip(const FaceAssetEntry* entry) {
+    return region() + entry->offset;
+}
+
+const FaceAssetFace* face_asset_frame_face(const FaceAssetFrame& frame) {
+    return face_asset_face(&asset_index().entries[frame.face]);
+}
+
+const FaceSpans* face_asset_spans(const uint8_t (&matrix)[MATRIX_ROWS][MATRIX_COLS]) {
+    // Матрица внутри области - всегда начало записи лица
+    const uint8_t* address = &matrix[0][0];
+    if (address < region() + RECORDS_START || address >= region() + FACE_ASSETS_SIZE) {
+        return nullptr;
+    }
+    return &((const FaceAssetFace*)address)->spans;
+}
+
+// Свободная запись индекса и начало места для данных; false, если места нет
+static bool next_free(int& entry_number, uint32_t& data_offset, uint32_t size) {
+    if (!region_free_of_firmware()) {
+        return false;
+    }
+    if (!index_valid()) {
+        face_asset_erase();
+    }
+    data_offset = RECORDS_START;
+    entry_number = 0;
+    for (const FaceAssetEntry& entry : asset_index().entries) {
+        if (!entry_used(entry)) {
+            break;
+        }
+        data_offset = std::max(data_offset, (entry.offset + entry.size + 3) & ~3u);
+        entry_number++;
+    }
+    // Брошенный клип оставляет данные без записи индекса: их тоже не перезаписываем
+    const uint32_t* words = (const uint32_t*)region();
+    for (uint32_t word = FACE_ASSETS_SIZE / 4; word > data_offset / 4; word--) {
+        if (words[word - 1] != 0xffffffff) {
+            data_offset = word * 4;
+            break;
+        }
+    }
+    if (entry_number == MAX_ENTRIES || data_offset + size > FACE_ASSETS_SIZE) {
+        printf("[ASSETS] No room for %lu bytes, erase the region first\n", (unsigned long)size);
+        return false;
+    }
+    return true;
+}
+
+static bool name_valid(std::string_view name) {
+    if (name.empty() || name.size() > FACE_ASSET_NAME_MAX) {
+        printf("[ASSETS] Name must be 1..%d characters\n", FACE_ASSET_NAME_MAX);
+        return false;
+    }
+    return true;
+}
+
+// Запись индекса пишется последней: оборванная загрузка не оставит ссылку на мусор
+static void write_entry(int entry_number, std::string_view name, FaceAssetType type, uint8_t frame_count,
+                        uint32_t data_offset, uint32_t size) {
+    FaceAssetEntry entry;
+    memset(&entry, 0, sizeof(entry));
+    memcpy(entry.name, name.data(), name.size());
+    entry.type = type;
+    entry.frame_count = frame_count;
+    entry.offset = data_offset;
+    entry.size = size;
+    flash_write((uint32_t)((const uint8_t*)&asset_index().entries[entry_number] - region()), &entry, sizeof(entry));
+    printf("[ASSETS] Stored '%.*s': %lu bytes at 0x%lx\n", (int)name.size(), name.data(),
+           (unsigned long)size, (unsigned long)(ASSETS_OFFSET + data_offset));
+}
+
+static bool add_entry(std::string_view name, FaceAssetType type, uint8_t frame_count,
+                      const void* data, uint32_t size) {
+    if (!name_valid(name)) {
+        return false;
+    }
+    if (pending_clip.active) {
+        printf("[ASSETS] Clip '%s' is still uploading\n", pending_clip.name);
+        return false;
+    }
+    int entry_number;
+    uint32_t data_offset;
+    if (!next_free(entry_number, data_offset, size)) {
+        return false;
+    }
+
+    display_list_fence();
+    flash_write(data_offset, data, size);
+    write_entry(entry_number, name, type, frame_count, data_offset, size);
+    return true;
+}
+
+static int hex_digit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+bool face_asset_add_face(std::string_view name, std::string_view packed_hex) {
+    static PackedFace packed;
+    static FaceAssetFace face;
+    if (packed_hex.size() != sizeof(packed.data) * 2) {
+        printf("[ASSETS] Face needs %d hex digits (%d bits per cell), got %d\n",
+               (int)sizeof(packed.data) * 2, FACE_BITS_PER_CELL, (int)packed_hex.size());
+        return false;
+    }
+    for (size_t i = 0; i < sizeof(packed.data); i++) {
+        int high = hex_digit(packed_hex[2 * i]);
+        int low = hex_digit(packed_hex[2 * i + 1]);
+        if (high < 0 || low < 0) {
+            printf("[ASSETS] Bad hex digit in face '%.*s'\n", (int)name.size(), name.data());
+            return false;
+        }
+        packed.data[i] = high << 4 | low;
+    }
+
+    // Во флеш лицо ложится распакованным и с отрезками - как встроенные
+    for (int row = 0; row < MATRIX_ROWS; row++) {
+        for (int col = 0; col < MATRIX_COLS; col++) {
+            face.cells[row][col] = packed.get(row, col);
+        }
+    }
+    face.spans = make_face_spans(face.cells);
+    return add_entry(name, FACE_ASSET_FACE, 0, &face, sizeof(face));
+}
+
+bool face_asset_add_animation(std::string_view name, std::string_view frames) {
+    static FaceAssetFrame parsed[FACE_ASSET_MAX_FRAMES];
+    int count = 0;
+    while (!frames.empty()) {
+        size_t comma = frames.find(',');
+        std::string_view item = frames.substr(0, comma);
+        frames = comma == std::string_view::npos ? std::string_view() : frames.substr(comma + 1);
+
+        size_t colon = item.find(':');
+        std::string_view face_name = item.substr(0, colon);
+        uint32_t duration = 0;
+        for (size_t i = colon == std::string_view::npos ? item.size() : colon + 1; i < item.size(); i++) {
+            if (item[i] < '0' || item[i] > '9') {
+                break;
+            }
+            duration = duration * 10 + (item[i] - '0');
+        }
+
+        const FaceAssetEntry* face = face_asset_find(face_name);
+        if (!face || face->type != FACE_ASSET_FACE) {
+            printf("[ASSETS] Frame %d: no uploaded face '%.*s'\n", count, (int)face_name.size(), face_name.data());
+            return false;
+        }
+        if (count == FACE_ASSET_MAX_FRAMES) {
+            printf("[ASSETS] More than %d frames\n", FACE_ASSET_MAX_FRAMES);
+            return false;
+        }
+        parsed[count].face = (uint8_t)(face - asset_index().entries);
+        parsed[count].reserved = 0;
+        parsed[count].duration_ms = (uint16_t)std::max<uint32_t>(1, std::min<uint32_t>(duration, 0xffff));
+        count++;
+    }
+    if (count == 0) {
+        printf("[ASSETS] Animation '%.*s' has no frames\n", (int)name.size(), name.data());
+        return false;
+    }
+    return add_entry(name, FACE_ASSET_ANIMATION, count, parsed, count * sizeof(FaceAssetFrame));
+}
+
+bool face_asset_add_clip_chunk(std::string_view name, uint32_t offset, uint32_t size, std::string_view data_hex) {
+    static uint8_t chunk[FACE_ASSET_CLIP_CHUNK];
+    if (!name_valid(name)) {
+        return false;
+    }
+    if (offset == 0) {
+        if (size < sizeof(FaceClipHeader)) {
+            printf("[ASSETS] Clip of %lu bytes is too short\n", (unsigned long)size);
+            return false;
+        }
+        pending_clip.active = false;
+        if (!next_free(pending_clip.entry_number, pending_clip.data_offset, size)) {
+            return false;
+        }
+        memset(pending_clip.name, 0, sizeof(pending_clip.name));
+        memcpy(pending_clip.name, name.data(), name.size());
+        pending_clip.size = size;
+        pending_clip.written = 0;
+        pending_clip.active = true;
+    } else if (!pending_clip.active || name != pending_clip.name || size != pending_clip.size
+               || offset != pending_clip.written) {
+        printf("[ASSETS] Clip chunk out of order: expected offset %lu\n",
+               (unsigned long)(pending_clip.active ? pending_clip.written : 0));
+        return false;
+    }
+
+    uint32_t length = data_hex.size() / 2;
+    if (data_hex.size() % 2 || length == 0 || length > sizeof(chunk) || offset + length > size) {
+        printf("[ASSETS] Clip chunk needs 1..%d bytes in hex within the clip size\n", FACE_ASSET_CLIP_CHUNK);
+        return false;
+    }
+    for (uint32_t i = 0; i < length; i++) {
+        int high = hex_digit(data_hex[2 * i]);
+        int low = hex_digit(data_hex[2 * i + 1]);
+        if (high < 0 || low < 0) {
+            printf("[ASSETS] Bad hex digit in clip '%.*s'\n", (int)name.size(), name.data());
+            return false;
+        }
+        chunk[i] = high << 4 | low;
+    }
+
+    display_list_fence();
+    flash_write(pending_clip.data_offset + offset, chunk, length);
+    pending_clip.written += length;
+    if (pending_clip.written < size) {
+        return true;
+    }
+
+    // Клип целиком во флеше: проверяем заголовок и только тогда публикуем
+    pending_clip.active = false;
+    if (!face_clip_valid(region() + pending_clip.data_offset, size)) {
+        return false;
+    }
+    write_entry(pending_clip.entry_number, name, FACE_ASSET_CLIP, 0, pending_clip.data_offset, size);
+    return true;
+}
+
+static const char* type_name(uint8_t type) {
+    switch (type) {
+    case FACE_ASSET_FACE: return "face";
+    case FACE_ASSET_ANIMATION: return "animation";
+    case FACE_ASSET_CLIP: return "clip";
+    default: return "unknown";
+    }
+}
+
+void face_asset_report() {
+    uint32_t used = RECORDS_START;
+    printf("{\"assets\": [");
+    if (index_valid()) {
+        int number = 0;
+        for (const FaceAssetEntry& entry : asset_index().entries) {
+            if (!entry_used(entry)) {
+                break;
+            }
+            // Перекрытая более новой загрузкой запись остаётся до стирания
+            bool current = face_asset_find(entry.name) == &entry;
+            int frames = entry.frame_count;
+            if (entry.type == FACE_ASSET_CLIP) {
+                FaceClipHeader header;
+                memcpy(&header, face_asset_clip(&entry), sizeof(header));
+                frames = header.frame_count;
+            }
+            printf("%s{\"name\": \"%s\", \"type\": \"%s\", \"frames\": %d, \"bytes\": %lu, \"current\": %s}",
+                   number ? ", " : "", entry.name, type_name(entry.type),
+                   frames, (unsigned long)entry.size, current ? "true" : "false");
+            used = std::max(used, entry.offset + entry.size);
+            number++;
+        }
+    }
+    printf("], \"used\": %lu, \"free\": %lu}\n", (unsigned long)used, (unsigned long)(FACE_ASSETS_SIZE - used));
+}
@@ -0,0 +1,98 @@
+#include "face_renderer.h"
+#include "face_clip.h"
+#include "display_list.h"
+#include "pico/stdlib.h"
+#include <stdio.h>
+
+static const int BENCH_ITERATIONS = 10;
+
+// Моргание: полная перерисовка и среднее время инкрементального кадра
+template <int Rows, int Cols>
+static void bench_geometry(const uint8_t (&open)[Rows][Cols], const uint8_t (&closed)[Rows][Cols]) {
+    using Geometry = FaceGeometry<Rows, Cols>;
+    auto& renderer = face_renderer<Rows, Cols>();
+
+    uint32_t start = time_us_32();
+    renderer.present(open, true);
+    // Время до панели: список отрисовки дописывается в фоне
+    display_list_fence();
+    uint32_t full_us = time_us_32() - start;
+
+    start = time_us_32();
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        renderer.present((i % 2) ? open : closed, false);
+    }
+    display_list_fence();
+    uint32_t incremental_us = (time_us_32() - start) / BENCH_ITERATIONS;
+
+    uint32_t changed_cells = 0;
+    for (int row = 0; row < Rows; row++) {
+        for (int col = 0; col < Cols; col++) {
+            if (open[row][col] != closed[row][col]) {
+                changed_cells++;
+            }
+        }
+    }
+
+    printf("{\"bench\": \"%dx%d\", \"cell_px\": %d, \"full_us\": %lu, \"incremental_us\": %lu, "
+           "\"changed_px\": %lu}\n",
+           Rows, Cols, Geometry::CELL_SIZE, full_us, incremental_us,
+           changed_cells * Geometry::CELL_SIZE * Geometry::CELL_SIZE);
+
+    renderer.invalidate();
+}
+
+void face_geometry_benchmark() {
+    printf("[BENCH] Face geometry benchmark, %d blink frames per geometry\n", BENCH_ITERATIONS);
+    bench_geometry(NEUTRAL_NO_BLINK, NEUTRAL_BLINK);
+    bench_geometry(NEUTRAL_NO_BLINK_24.cells, NEUTRAL_BLINK_24.cells);
+    bench_geometry(NEUTRAL_NO_BLINK_48.cells, NEUTRAL_BLINK_48.cells);
+
+    // Следующий кадр эмоции снова рисуется целиком
+    main_face_renderer().invalidate();
+}
+
+// Моргание и разговор из встроенных лиц, как типичный загружаемый клип
+static Matrix12x12* const CLIP_BENCH_FACES[] = {
+    &NEUTRAL_NO_BLINK, &NEUTRAL_HALF_BLINK, &NEUTRAL_BLINK, &NEUTRAL_HALF_BLINK,
+    &NEUTRAL_NO_BLINK, &TALKING_A, &TALKING_B, &TALKING_A,
+};
+static const int CLIP_BENCH_FRAMES = 240;
+static const int CLIP_BENCH_ROUNDS = 20;
+
+void face_clip_benchmark() {
+    static uint8_t clip[8 * 1024];
+    const int sequence = sizeof(CLIP_BENCH_FACES) / sizeof(CLIP_BENCH_FACES[0]);
+
+    uint32_t start = time_us_32();
+    PackedFace previous = pack_face(NEUTRAL_NO_BLINK);
+    size_t used = face_clip_begin(previous, clip, sizeof(clip));
+    for (int i = 0; i < CLIP_BENCH_FRAMES && used; i++) {
+        PackedFace frame = pack_face(*CLIP_BENCH_FACES[i % sequence]);
+        used = face_clip_add_frame(i ? previous : frame, frame, 80, clip, used, sizeof(clip));
+        previous = frame;
+    }
+    if (!used) {
+        printf("[BENCH] Clip does not fit %d bytes\n", (int)sizeof(clip));
+        return;
+    }
+    used = face_clip_finish(clip, used);
+    uint32_t encode_us = time_us_32() - start;
+
+    static FaceClipPlayer player;
+    face_clip_open(player, clip, used);
+    uint32_t checksum = 0;
+    start = time_us_32();
+    for (int i = 0; i < CLIP_BENCH_FRAMES * CLIP_BENCH_ROUNDS; i++) {
+        face_clip_next(player);
+        checksum += player.cells[MATRIX_ROWS / 2][MATRIX_COLS / 2];
+    }
+    uint32_t decode_us = time_us_32() - start;
+    uint32_t decoded = CLIP_BENCH_FRAMES * CLIP_BENCH_ROUNDS;
+
+    printf("{\"bench\": \"clip\", \"frames\": %d, \"bytes\": %u, \"packed_bytes\": %d, "
+           "\"bytes_per_frame\": %u, \"encode_us\": %lu, \"decode_ns_per_frame\": %lu, \"checksum\": %lu}\n",
+           CLIP_BENCH_FRAMES, (unsigned)used, CLIP_BENCH_FRAMES * FACE_CLIP_PACKED_BYTES,
+           (unsigned)(used / CLIP_BENCH_FRAMES), (unsigned long)encode_us,
+           (unsigned long)((uint64_t)decode_us * 1000 / decoded), (unsigned long)checksum);
+}
@@ -0,0 +1,175 @@
+#include "face_clip.h"
+#include <stdio.h>
+#include <string.h>
+
+// Без зависимостей от SDK: тот же код собирается в tools/clip_encode.cpp
+
+static const size_t KEYFRAME_OFFSET = sizeof(FaceClipHeader);
+static const size_t RECORDS_OFFSET = KEYFRAME_OFFSET + FACE_CLIP_PACKED_BYTES;
+static const int CELLS_PER_BYTE = 8 / FACE_BITS_PER_CELL;
+static const int MAX_TOKEN_RUN = 128;
+
+static uint16_t read_u16(const uint8_t* p) {
+    return (uint16_t)(p[0] | p[1] << 8);
+}
+
+bool face_clip_valid(const uint8_t* clip, size_t size) {
+    FaceClipHeader header;
+    if (size < RECORDS_OFFSET + 2) {
+        printf("[CLIP] Clip of %u bytes is too short\n", (unsigned)size);
+        return false;
+    }
+    memcpy(&header, clip, sizeof(header));
+    if (memcmp(header.magic, "FCLP", 4) != 0 || header.size != size || header.frame_count == 0) {
+        printf("[CLIP] Not a clip or size mismatch\n");
+        return false;
+    }
+    if (header.rows != MATRIX_ROWS || header.cols != MATRIX_COLS || header.bits_per_cell != FACE_BITS_PER_CELL) {
+        printf("[CLIP] Clip is %dx%d at %d bits per cell, firmware draws %dx%d at %d\n",
+               header.rows, header.cols, header.bits_per_cell, MATRIX_ROWS, MATRIX_COLS, FACE_BITS_PER_CELL);
+        return false;
+    }
+    return true;
+}
+
+// Клетки одного упакованного байта (клетка не пересекает границу байта)
+static void unpack_byte(FaceClipPlayer& player, int index) {
+    uint8_t value = player.packed.data[index];
+    int cell = index * CELLS_PER_BYTE;
+    for (int i = 0; i < CELLS_PER_BYTE && cell < MATRIX_ROWS * MATRIX_COLS; i++, cell++) {
+        player.cells[cell / MATRIX_COLS][cell % MATRIX_COLS] = value & (FACE_PALETTE_SIZE - 1);
+        value >>= FACE_BITS_PER_CELL;
+    }
+}
+
+static void rewind(FaceClipPlayer& player) {
+    memcpy(player.packed.data, player.clip + KEYFRAME_OFFSET, FACE_CLIP_PACKED_BYTES);
+    for (int i = 0; i < FACE_CLIP_PACKED_BYTES; i++) {
+        unpack_byte(player, i);
+    }
+    player.frame = 0;
+    player.duration_ms = read_u16(player.clip + RECORDS_OFFSET);
+    player.next = player.clip + RECORDS_OFFSET + 2;
+}
+
+bool face_clip_open(FaceClipPlayer& player, const uint8_t* clip, size_t size) {
+    if (!face_clip_valid(clip, size)) {
+        return false;
+    }
+    player.clip = clip;
+    player.end = clip + size;
+    player.frame_count = read_u16(clip + offsetof(FaceClipHeader, frame_count));
+    rewind(player);
+    return true;
+}
+
+bool face_clip_next(FaceClipPlayer& player) {
+    if (player.frame + 1 >= player.frame_count) {
+        rewind(player);
+        return true;
+    }
+
+    const uint8_t* p = player.next;
+    if (player.end - p < 2) {
+        rewind(player);
+        return false;
+    }
+    player.duration_ms = read_u16(p);
+    p += 2;
+
+    // Пропуски и XOR-литералы, пока не покрыт весь кадр
+    int index = 0;
+    while (index < FACE_CLIP_PACKED_BYTES) {
+        if (p == player.end) {
+            rewind(player);
+            return false;
+        }
+        uint8_t token = *p++;
+        if (token < 0x80) {
+            index += token + 1;
+            continue;
+        }
+        int count = token - 0x7f;
+        if (player.end - p < count || index + count > FACE_CLIP_PACKED_BYTES) {
+            rewind(player);
+            return false;
+        }
+        for (int i = 0; i < count; i++, index++) {
+            player.packed.data[index] ^= *p++;
+            unpack_byte(player, index);
+        }
+    }
+
+    player.next = p;
+    player.frame++;
+    return true;
+}
+
+size_t face_clip_begin(const PackedFace& keyframe, uint8_t* out, size_t capacity) {
+    if (capacity < RECORDS_OFFSET) {
+        return 0;
+    }
+    FaceClipHeader header = {{'F', 'C', 'L', 'P'}, MATRIX_ROWS, MATRIX_COLS, FACE_BITS_PER_CELL, 0, 0, 0, 0};
+    memcpy(out, &header, sizeof(header));
+    memcpy(out + KEYFRAME_OFFSET, keyframe.data, FACE_CLIP_PACKED_BYTES);
+    return RECORDS_OFFSET;
+}
+
+size_t face_clip_add_frame(const PackedFace& previous, const PackedFace& frame, uint16_t duration_ms,
+                           uint8_t* out, size_t used, size_t capacity) {
+    FaceClipHeader header;
+    memcpy(&header, out, sizeof(header));
+    size_t pos = used;
+    if (pos + 2 > capacity) {
+        return 0;
+    }
+    out[pos++] = duration_ms & 0xff;
+    out[pos++] = duration_ms >> 8;
+
+    // Кадр 0 - сам ключевой кадр, у него только длительность
+    if (header.frame_count > 0) {
+        uint8_t delta[FACE_CLIP_PACKED_BYTES];
+        for (int i = 0; i < FACE_CLIP_PACKED_BYTES; i++) {
+            delta[i] = previous.data[i] ^ frame.data[i];
+        }
+        int i = 0;
+        while (i < FACE_CLIP_PACKED_BYTES) {
+            int j = i;
+            if (delta[i] == 0) {
+                while (j < FACE_CLIP_PACKED_BYTES && delta[j] == 0 && j - i < MAX_TOKEN_RUN) {
+                    j++;
+                }
+                if (pos + 1 > capacity) {
+                    return 0;
+                }
+                out[pos++] = (uint8_t)(j - i - 1);
+            } else {
+                // Одиночный неизменный байт дешевле оставить внутри литерала
+                while (j < FACE_CLIP_PACKED_BYTES && j - i < MAX_TOKEN_RUN
+                       && (delta[j] != 0 || (j + 1 < FACE_CLIP_PACKED_BYTES && delta[j + 1] != 0
+                                             && j + 1 - i < MAX_TOKEN_RUN))) {
+                    j++;
+                }
+                if (pos + 1 + (j - i) > capacity) {
+                    return 0;
+                }
+                out[pos++] = (uint8_t)(0x7f + (j - i));
+                memcpy(out + pos, delta + i, j - i);
+                pos += j - i;
+            }
+            i = j;
+        }
+    }
+
+    header.frame_count++;
+    memcpy(out, &header, sizeof(header));
+    return pos;
+}
+
+size_t face_clip_finish(uint8_t* out, size_t used) {
+    FaceClipHeader header;
+    memcpy(&header, out, sizeof(header));
+    header.size = (uint32_t)used;
+    memcpy(out, &header, sizeof(header));
+    return used;
+}
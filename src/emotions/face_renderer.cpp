@@ -0,0 +1,673 @@
+#include "face_renderer.h"
+#include "emotions.h"
+#include "trace.h"
+#include "frame_stats.h"
+#include "color_anim.h"
+#include "panel_effects.h"
+#include "tear_sync.h"
+#include "display_list.h"
+#include "hot_path.h"
+#include "pico/stdlib.h"
+#include <algorithm>
+
+// Use C driver directly
+extern "C" {
+#include "pico/st7789.h"
+}
+
+static const uint32_t ANIMATION_FPS = 60;
+
+// Открытие окна (CASET + RASET) стоит примерно столько же, сколько запись ~64 пикселей
+static const int WINDOW_COST_PIXELS = 64;
+
+static Palette active_palette = PALETTE_DEFAULT;
+static uint16_t line[DISPLAY_WIDTH];
+static CellStyle cell_style = CELL_STYLE_ROUNDED;
+
+// Цвета плиток: уровень покрытия -> смесь цвета записи палитры с фоном
+static uint16_t coverage_ramps[FACE_PALETTE_SIZE][CELL_COVERAGE_LEVELS];
+static bool coverage_ramps_ready = false;
+
+static void update_coverage_ramp(uint8_t index) {
+    for (int level = 0; level < CELL_COVERAGE_LEVELS; level++) {
+        coverage_ramps[index][level] = lerp_color565(active_palette.colors[PALETTE_BG],
+                                                     active_palette.colors[index],
+                                                     level * 256 / CELL_COVERAGE_FULL);
+    }
+}
+
+static void update_coverage_ramps() {
+    for (int i = 0; i < FACE_PALETTE_SIZE; i++) {
+        update_coverage_ramp(i);
+    }
+    coverage_ramps_ready = true;
+}
+
+// Продвинутая функция отрисовки с минимальным мерцанием
+void HOT_FUNC(st7789_fill_rect_optimized)(int x, int y, int width, int height, uint16_t color) {
+    // Одно окно на весь прямоугольник, пиксели идут сплошным потоком
+    st7789_set_window(x, y, x + width - 1, y + height - 1);
+    st7789_fill_pixels(color, (size_t)width * height);
+}
+
+// Лицо пишется через список отрисовки (уходит по DMA в фоне) или сразу драйвером.
+// Ожидание развёртки меряет запись на CPU, поэтому с ним пишем сразу.
+static bool HOT_FUNC(use_display_list)() {
+    return display_list_enabled() && tear_sync_mode() == TEAR_SYNC_OFF;
+}
+
+static void HOT_FUNC(face_window)(int x0, int y0, int x1, int y1) {
+    if (use_display_list()) {
+        display_list_window(x0, y0, x1, y1);
+    } else {
+        st7789_set_window(x0, y0, x1, y1);
+    }
+}
+
+// Линия окна, повторённая `repeat` раз
+static void HOT_FUNC(face_lines)(const uint16_t* pixels, int width, int repeat) {
+    if (use_display_list()) {
+        display_list_line(pixels, width, repeat);
+        return;
+    }
+    for (int i = 0; i < repeat; i++) {
+        st7789_write(pixels, width * sizeof(uint16_t));
+    }
+}
+
+static void HOT_FUNC(face_fill_rect)(int x, int y, int width, int height, uint16_t color) {
+    if (use_display_list()) {
+        display_list_window(x, y, x + width - 1, y + height - 1);
+        display_list_fill(color, height);
+    } else {
+        st7789_fill_rect_optimized(x, y, width, height, color);
+    }
+}
+
+template <int Rows, int Cols>
+static inline uint8_t cell_at(const uint8_t (&cells)[Rows][Cols], int row, int col) {
+    return cells[row][col];
+}
+
+template <int Rows, int Cols>
+static inline uint8_t cell_at(const PackedCells<Rows, Cols>& cells, int row, int col) {
+    return cells.get(row, col);
+}
+
+// Скруглённые углы клетки: оба соседа у угла - фон или край лица
+template <int Rows, int Cols, typename Cells>
+static uint8_t HOT_FUNC(cell_corners)(const Cells& cells, int row, int col) {
+    if (cell_style == CELL_STYLE_FLAT || cell_at(cells, row, col) == PALETTE_BG) {
+        return 0;
+    }
+    bool top = row == 0 || cell_at(cells, row - 1, col) == PALETTE_BG;
+    bool bottom = row == Rows - 1 || cell_at(cells, row + 1, col) == PALETTE_BG;
+    bool left = col == 0 || cell_at(cells, row, col - 1) == PALETTE_BG;
+    bool right = col == Cols - 1 || cell_at(cells, row, col + 1) == PALETTE_BG;
+
+    return (top && left ? CELL_CORNER_TL : 0) | (top && right ? CELL_CORNER_TR : 0)
+         | (bottom && right ? CELL_CORNER_BR : 0) | (bottom && left ? CELL_CORNER_BL : 0);
+}
+
+// Что видно в клетке: индекс палитры и форма; у соседа изменённой клетки может смениться форма
+template <int Rows, int Cols, typename Cells>
+static inline uint8_t cell_key(const Cells& cells, int row, int col) {
+    return cell_at(cells, row, col) | (cell_corners<Rows, Cols>(cells, row, col) << 4);
+}
+
+// Значения и углы клеток ряда [first_col, first_col + count); true, если есть скругления
+template <int Rows, int Cols, typename Cells>
+static bool HOT_FUNC(row_corners)(const Cells& cells, int row, int first_col, int count,
+                                  uint8_t* values, uint8_t* corners) {
+    bool rounded = false;
+    for (int i = 0; i < count; i++) {
+        values[i] = cell_at(cells, row, first_col + i);
+        corners[i] = cell_corners<Rows, Cols>(cells, row, first_col + i);
+        rounded |= corners[i] != 0;
+    }
+    return rounded;
+}
+
+// Ряд клеток [first_col, last_col] в строку пикселей
+template <int Rows, int Cols, typename Cells>
+static int HOT_FUNC(compose_row)(const Cells& cells, int row, int first_col, int last_col, int cell_size) {
+    uint16_t* out = line;
+    for (int col = first_col; col <= last_col; col++) {
+        uint16_t* end = out + cell_size;
+        std::fill(out, end, active_palette.colors[cell_at(cells, row, col)]);
+        out = end;
+    }
+    return out - line;
+}
+
+// Одна линия пикселей ряда клеток из плиток; углы без скругления - сплошная заливка
+template <int CellSize>
+static void HOT_FUNC(compose_tile_line)(const uint8_t* values, const uint8_t* corners, int count, int py) {
+    const CellTiles<CellSize>& tiles = cell_tiles<CellSize>();
+    uint16_t* out = line;
+    for (int i = 0; i < count; i++) {
+        if (corners[i] == 0) {
+            std::fill(out, out + CellSize, active_palette.colors[values[i]]);
+        } else {
+            const uint8_t* coverage = tiles.coverage[corners[i]][py];
+            const uint16_t* ramp = coverage_ramps[values[i]];
+            for (int x = 0; x < CellSize; x++) {
+                out[x] = ramp[coverage[x]];
+            }
+        }
+        out += CellSize;
+    }
+}
+
+template <int Cols>
+static int HOT_FUNC(compose_spans)(const FaceRowSpans<Cols>& row_spans, int cell_size) {
+    uint16_t* out = line;
+    for (int i = 0; i < row_spans.count; i++) {
+        uint16_t* end = out + row_spans.spans[i].length * cell_size;
+        std::fill(out, end, active_palette.colors[row_spans.spans[i].value]);
+        out = end;
+    }
+    return out - line;
+}
+
+template <int Rows, int Cols>
+FaceRenderer<Rows, Cols>& face_renderer() {
+    static FaceRenderer<Rows, Cols> renderer;
+    return renderer;
+}
+
+template <int Rows, int Cols>
+bool HOT_FUNC(FaceRenderer<Rows, Cols>::draw)(const uint8_t (&matrix)[Rows][Cols], bool force_redraw) {
+    uint32_t current_time = to_ms_since_boot(get_absolute_time());
+
+    // Строки лица сейчас пишет прокрутка перехода
+    if (panel_slide_active()) {
+        return false;
+    }
+
+    // Ограничиваем частоту обновления для плавности
+    if (!force_redraw && (current_time - last_draw_time_) < (1000 / ANIMATION_FPS)) {
+        return false; // Пропускаем слишком частые обновления
+    }
+
+    last_draw_time_ = current_time;
+    present(matrix, force_redraw);
+    frame_stats_presented(time_us_32());
+    return true;
+}
+
+template <int Rows, int Cols>
+void HOT_FUNC(FaceRenderer<Rows, Cols>::present)(const uint8_t (&matrix)[Rows][Cols], bool force_redraw) {
+    if (!initialized_ || force_redraw) {
+        TRACE_SCOPE(TRACE_DRAW_FULL);
+        if (!border_cleared_) {
+            TRACE_BEGIN(TRACE_BORDER_CLEAR);
+            clear_border(active_palette.colors[PALETTE_BG]);
+            TRACE_END(TRACE_BORDER_CLEAR);
+            border_cleared_ = true;
+        } else if (deferred_writer_ && !has_mask_) {
+            // Кадр запоминается сразу, пиксели берутся из screen_ через compose_screen_line
+            FullDrawWriter writer = deferred_writer_;
+            deferred_writer_ = nullptr;
+            screen_ = pack_face(matrix);
+            initialized_ = true;
+            epoch_++;
+            writer(Geometry::Y_OFFSET, Geometry::HEIGHT);
+            return;
+        }
+        deferred_writer_ = nullptr;
+        draw_full(matrix);
+        initialized_ = true;
+    } else {
+        TRACE_SCOPE(TRACE_DRAW_INCREMENTAL);
+        draw_changes(matrix);
+    }
+
+    // Сохраняем текущее состояние
+    screen_ = pack_face(matrix);
+    epoch_++;
+    display_list_submit();
+}
+
+// Полная перерисовка лица одним проходом по окну лица без повторной записи пикселей
+template <int Rows, int Cols>
+void HOT_FUNC(FaceRenderer<Rows, Cols>::draw_full)(const uint8_t (&matrix)[Rows][Cols]) {
+    if (has_mask_) {
+        write_unmasked(matrix);
+        return;
+    }
+
+    if (!coverage_ramps_ready) {
+        update_coverage_ramps();
+    }
+
+    // Встроенные лица используют таблицы, построенные компилятором
+    const FaceSpans* spans = nullptr;
+    if constexpr (Rows == MATRIX_ROWS && Cols == MATRIX_COLS) {
+        spans = find_face_spans(matrix);
+    }
+
+    face_window(Geometry::X_OFFSET, Geometry::Y_OFFSET,
+                Geometry::X_OFFSET + Geometry::WIDTH - 1, Geometry::Y_OFFSET + Geometry::HEIGHT - 1);
+
+    for (int row = 0; row < Rows; row++) {
+        // Ряды со скруглёнными клетками собираются из плиток по линии
+        uint8_t values[Cols];
+        uint8_t corners[Cols];
+        if (row_corners<Rows, Cols>(matrix, row, 0, Cols, values, corners)) {
+            for (int py = 0; py < Geometry::CELL_SIZE; py++) {
+                compose_tile_line<Geometry::CELL_SIZE>(values, corners, Cols, py);
+                face_lines(line, Geometry::WIDTH, 1);
+            }
+            continue;
+        }
+        // Остальные (пустые и внутренние) одинаковы для всех CELL_SIZE линий ряда
+        int width = spans ? compose_spans(spans->rows[row], Geometry::CELL_SIZE)
+                          : compose_row<Rows, Cols>(matrix, row, 0, Cols - 1, Geometry::CELL_SIZE);
+        face_lines(line, width, Geometry::CELL_SIZE);
+    }
+}
+
+// Инкрементальное обновление: изменённые участки рядов, одинаковые участки
+// соседних рядов объединяются в одно окно
+template <int Rows, int Cols>
+void HOT_FUNC(FaceRenderer<Rows, Cols>::draw_changes)(const uint8_t (&matrix)[Rows][Cols]) {
+    struct Run {
+        uint8_t first;
+        uint8_t last;
+    };
+    // Неизменённый промежуток дешевле перезаписать, чем открывать новое окно
+    constexpr int MAX_GAP_CELLS = WINDOW_COST_PIXELS / (Geometry::CELL_SIZE * Geometry::CELL_SIZE);
+
+    Run band_runs[Cols];
+    Run row_runs[Cols];
+    int band_count = 0;
+    int band_start = 0;
+    bool has_changes = false;
+
+    // Окна кадра копятся и пишутся в порядке, удобном для развёртки панели
+    struct PendingWrite {
+        uint8_t first_row;
+        uint8_t last_row;
+        uint8_t first_col;
+        uint8_t last_col;
+    };
+    static PendingWrite pending[TEAR_SYNC_MAX_RECTS];
+    static ScanRect rects[TEAR_SYNC_MAX_RECTS];
+    int pending_count = 0;
+    auto flush_pending = [&]() {
+        uint8_t order[TEAR_SYNC_MAX_RECTS];
+        tear_sync_order(rects, pending_count, order);
+        for (int i = 0; i < pending_count; i++) {
+            const PendingWrite& write = pending[order[i]];
+            tear_sync_wait(rects[order[i]]);
+            uint32_t start_us = time_us_32();
+            write_cells(matrix, write.first_row, write.last_row, write.first_col, write.last_col);
+            tear_sync_written(rects[order[i]], start_us, time_us_32());
+        }
+        pending_count = 0;
+    };
+
+    for (int row = 0; row <= Rows; row++) {
+        int row_count = 0;
+        if (row < Rows) {
+            for (int col = 0; col < Cols; col++) {
+                if (is_masked(row, col)
+                    || cell_key<Rows, Cols>(matrix, row, col) == cell_key<Rows, Cols>(screen_, row, col)) {
+                    continue;
+                }
+                // Промежуток можно перезаписать, только если в нём нет чужих клеток
+                int gap_first = row_count > 0 ? row_runs[row_count - 1].last + 1 : col;
+                uint64_t gap_mask = col > gap_first ? ((1ull << (col - gap_first)) - 1) << gap_first : 0;
+                if (row_count > 0 && col - gap_first <= MAX_GAP_CELLS && !(mask_[row] & gap_mask)) {
+                    row_runs[row_count - 1].last = col;
+                } else {
+                    row_runs[row_count++] = {(uint8_t)col, (uint8_t)col};
+                }
+            }
+        }
+
+        bool same_band = row < Rows && row_count > 0 && row_count == band_count;
+        for (int i = 0; same_band && i < row_count; i++) {
+            same_band = row_runs[i].first == band_runs[i].first && row_runs[i].last == band_runs[i].last;
+        }
+        if (same_band) {
+            continue;
+        }
+
+        for (int i = 0; i < band_count; i++) {
+            if (pending_count == TEAR_SYNC_MAX_RECTS) {
+                flush_pending();
+            }
+            pending[pending_count] = {(uint8_t)band_start, (uint8_t)(row - 1), band_runs[i].first, band_runs[i].last};
+            int x0 = band_runs[i].first * Geometry::CELL_SIZE;
+            int x1 = (band_runs[i].last + 1) * Geometry::CELL_SIZE;
+            int y0 = Geometry::Y_OFFSET + band_start * Geometry::CELL_SIZE;
+            int y1 = Geometry::Y_OFFSET + row * Geometry::CELL_SIZE - 1;
+            rects[pending_count++] = {(int16_t)y0, (int16_t)y1, (uint32_t)(x1 - x0) * (y1 - y0 + 1)};
+            has_changes = true;
+        }
+        std::copy(row_runs, row_runs + row_count, band_runs);
+        band_count = row_count;
+        band_start = row;
+    }
+    flush_pending();
+
+    if (has_changes) {
+        printf("[ANIM_SYS] Incremental update completed\n");
+    }
+}
+
+template <int Rows, int Cols>
+template <typename Cells>
+void HOT_FUNC(FaceRenderer<Rows, Cols>::write_cells)(const Cells& cells, int first_row, int last_row,
+                                                     int first_col, int last_col) {
+    int x = Geometry::X_OFFSET + first_col * Geometry::CELL_SIZE;
+    int y = Geometry::Y_OFFSET + first_row * Geometry::CELL_SIZE;
+    int count = last_col - first_col + 1;
+    int width = count * Geometry::CELL_SIZE;
+    int height = (last_row - first_row + 1) * Geometry::CELL_SIZE;
+
+    if (!coverage_ramps_ready) {
+        update_coverage_ramps();
+    }
+
+    face_window(x, y, x + width - 1, y + height - 1);
+    for (int row = first_row; row <= last_row; row++) {
+        uint8_t values[Cols];
+        uint8_t corners[Cols];
+
+        // Без скруглений все линии ряда одинаковы - собираем строку один раз
+        if (!row_corners<Rows, Cols>(cells, row, first_col, count, values, corners)) {
+            compose_row<Rows, Cols>(cells, row, first_col, last_col, Geometry::CELL_SIZE);
+            face_lines(line, width, Geometry::CELL_SIZE);
+            continue;
+        }
+        for (int py = 0; py < Geometry::CELL_SIZE; py++) {
+            compose_tile_line<Geometry::CELL_SIZE>(values, corners, count, py);
+            face_lines(line, width, 1);
+        }
+    }
+}
+
+// Все клетки, кроме замаскированных: ряды участками между ними
+template <int Rows, int Cols>
+template <typename Cells>
+void HOT_FUNC(FaceRenderer<Rows, Cols>::write_unmasked)(const Cells& cells) {
+    for (int row = 0; row < Rows; row++) {
+        int col = 0;
+        while (col < Cols) {
+            if (is_masked(row, col)) {
+                col++;
+                continue;
+            }
+            int run_start = col;
+            while (col < Cols && !is_masked(row, col)) {
+                col++;
+            }
+            write_cells(cells, row, row, run_start, col - 1);
+        }
+    }
+}
+
+template <int Rows, int Cols>
+void FaceRenderer<Rows, Cols>::refresh() {
+    if (initialized_) {
+        TRACE_SCOPE(TRACE_DRAW_FULL);
+        write_unmasked(screen_);
+        epoch_++;
+        display_list_submit();
+    }
+}
+
+template <int Rows, int Cols>
+void HOT_FUNC(FaceRenderer<Rows, Cols>::compose_screen_line)(int x0, int x1, int y, uint16_t* out) const {
+    constexpr int face_right = Geometry::X_OFFSET + Geometry::WIDTH;
+    const uint16_t bg = active_palette.colors[PALETTE_BG];
+    if (!initialized_ || y < Geometry::Y_OFFSET || y >= Geometry::Y_OFFSET + Geometry::HEIGHT) {
+        std::fill(out, out + (x1 - x0), bg);
+        return;
+    }
+    if (!coverage_ramps_ready) {
+        update_coverage_ramps();
+    }
+
+    const CellTiles<Geometry::CELL_SIZE>& tiles = cell_tiles<Geometry::CELL_SIZE>();
+    int row = (y - Geometry::Y_OFFSET) / Geometry::CELL_SIZE;
+    int py = (y - Geometry::Y_OFFSET) % Geometry::CELL_SIZE;
+    int x = x0;
+    while (x < x1) {
+        if (x < Geometry::X_OFFSET || x >= face_right) {
+            *out++ = bg;
+            x++;
+            continue;
+        }
+        // Кусок линии внутри одной клетки
+        int col = (x - Geometry::X_OFFSET) / Geometry::CELL_SIZE;
+        int cell_x = Geometry::X_OFFSET + col * Geometry::CELL_SIZE;
+        int end = std::min(x1, cell_x + Geometry::CELL_SIZE);
+        uint8_t value = screen_.get(row, col);
+        uint8_t corners = cell_corners<Rows, Cols>(screen_, row, col);
+        if (corners == 0) {
+            std::fill(out, out + (end - x), active_palette.colors[value]);
+            out += end - x;
+        } else {
+            const uint8_t* coverage = tiles.coverage[corners][py];
+            const uint16_t* ramp = coverage_ramps[value];
+            for (int px = x; px < end; px++) {
+                *out++ = ramp[coverage[px - cell_x]];
+            }
+        }
+        x = end;
+    }
+}
+
+template <int Rows, int Cols>
+void FaceRenderer<Rows, Cols>::mask_cells(int first_row, int last_row, int first_col, int last_col) {
+    uint64_t bits = ((~0ull) >> (63 - (last_col - first_col))) << first_col;
+    for (int row = first_row; row <= last_row; row++) {
+        mask_[row] |= bits;
+    }
+    has_mask_ = true;
+}
+
+template <int Rows, int Cols>
+void FaceRenderer<Rows, Cols>::clear_mask() {
+    std::fill(mask_, mask_ + Rows, 0);
+    has_mask_ = false;
+}
+
+// Клетки, которые надо перерисовать при смене цвета записи палитры: сама запись,
+// а для фона ещё и скруглённые углы клеток, в которых фон подмешан
+template <int Rows, int Cols>
+static inline bool uses_palette_entry(const PackedCells<Rows, Cols>& screen, uint8_t index, int row, int col) {
+    return screen.get(row, col) == index
+        || (index == PALETTE_BG && cell_corners<Rows, Cols>(screen, row, col) != 0);
+}
+
+// Перерисовка ряда клеток одного индекса палитры, возвращает число пикселей
+template <int Rows, int Cols>
+uint32_t FaceRenderer<Rows, Cols>::repaint_palette_row(uint8_t index, int row, uint16_t color) {
+    uint32_t pixels = 0;
+    int col = 0;
+    while (col < Cols) {
+        if (is_masked(row, col) || !uses_palette_entry(screen_, index, row, col)) {
+            col++;
+            continue;
+        }
+        int run_start = col;
+        while (col < Cols && !is_masked(row, col) && uses_palette_entry(screen_, index, row, col)) {
+            col++;
+        }
+        int width = (col - run_start) * Geometry::CELL_SIZE;
+        if (cell_style == CELL_STYLE_ROUNDED) {
+            write_cells(screen_, row, row, run_start, col - 1);
+        } else {
+            face_fill_rect(Geometry::X_OFFSET + run_start * Geometry::CELL_SIZE,
+                           Geometry::Y_OFFSET + row * Geometry::CELL_SIZE,
+                           width, Geometry::CELL_SIZE, color);
+        }
+        pixels += width * Geometry::CELL_SIZE;
+    }
+    if (pixels > 0) {
+        epoch_++;
+        display_list_submit();
+    }
+    return pixels;
+}
+
+template <int Rows, int Cols>
+uint32_t FaceRenderer<Rows, Cols>::count_palette_row_pixels(uint8_t index, int row) const {
+    uint32_t cells = 0;
+    for (int col = 0; col < Cols; col++) {
+        if (!is_masked(row, col) && uses_palette_entry(screen_, index, row, col)) {
+            cells++;
+        }
+    }
+    return cells * Geometry::CELL_SIZE * Geometry::CELL_SIZE;
+}
+
+// Области экрана вне лица не рисуются никогда - очищаем их один раз
+template <int Rows, int Cols>
+void FaceRenderer<Rows, Cols>::clear_border(uint16_t color) {
+    clear_border_lines(0, DISPLAY_HEIGHT, color);
+}
+
+template <int Rows, int Cols>
+uint32_t FaceRenderer<Rows, Cols>::border_pixels(int first_line, int lines) const {
+    constexpr int face_bottom = Geometry::Y_OFFSET + Geometry::HEIGHT;
+    int last_line = std::min(first_line + lines, DISPLAY_HEIGHT);
+    int face_lines = std::max(0, std::min(last_line, face_bottom) - std::max(first_line, Geometry::Y_OFFSET));
+    int all_lines = std::max(0, last_line - first_line);
+    return (uint32_t)(all_lines - face_lines) * DISPLAY_WIDTH + (uint32_t)face_lines * (DISPLAY_WIDTH - Geometry::WIDTH);
+}
+
+// Рамка в строках [first_line, first_line + lines): над и под лицом целиком, рядом с лицом - поля
+template <int Rows, int Cols>
+void FaceRenderer<Rows, Cols>::clear_border_lines(int first_line, int lines, uint16_t color) {
+    constexpr int face_right = Geometry::X_OFFSET + Geometry::WIDTH;
+    constexpr int face_bottom = Geometry::Y_OFFSET + Geometry::HEIGHT;
+    int last_line = std::min(first_line + lines, DISPLAY_HEIGHT);
+    epoch_++;
+
+    int top_end = std::min(last_line, Geometry::Y_OFFSET);
+    if (first_line < top_end) {
+        face_fill_rect(0, first_line, DISPLAY_WIDTH, top_end - first_line, color);
+    }
+    int bottom_start = std::max(first_line, face_bottom);
+    if (bottom_start < last_line) {
+        face_fill_rect(0, bottom_start, DISPLAY_WIDTH, last_line - bottom_start, color);
+    }
+    int side_start = std::max(first_line, Geometry::Y_OFFSET);
+    int side_end = std::min(last_line, face_bottom);
+    if (side_start < side_end) {
+        if (Geometry::X_OFFSET > 0) {
+            face_fill_rect(0, side_start, Geometry::X_OFFSET, side_end - side_start, color);
+        }
+        if (face_right < DISPLAY_WIDTH) {
+            face_fill_rect(face_right, side_start, DISPLAY_WIDTH - face_right, side_end - side_start, color);
+        }
+    }
+    display_list_submit();
+}
+
+#define INSTANTIATE_FACE_RENDERER(rows, cols)  \
+    template class FaceRenderer<rows, cols>; \
+    template FaceRenderer<rows, cols>& face_renderer<rows, cols>();
+FACE_GEOMETRY_LIST(INSTANTIATE_FACE_RENDERER)
+
+// Рамка фона перекрашивается полосами строк, каждая не дороже бюджета кадра
+static const int BORDER_STRIP_LINES = COLOR_ANIM_PIXEL_BUDGET / DISPLAY_WIDTH;
+static const int BORDER_STRIPS = (DISPLAY_HEIGHT + BORDER_STRIP_LINES - 1) / BORDER_STRIP_LINES;
+
+// Palette control works on the renderer of the built-in faces
+int repaint_palette_rows(uint8_t index, int first_row, uint32_t& pixel_budget) {
+    auto& renderer = main_face_renderer();
+    if (!renderer.is_initialized()) {
+        return PALETTE_REPAINT_DONE;
+    }
+    uint16_t color = active_palette.colors[index];
+    // Для фона после рядов лица идут полосы рамки вокруг лица
+    int last_row = index == PALETTE_BG ? MATRIX_ROWS + BORDER_STRIPS - 1 : MATRIX_ROWS - 1;
+    bool painted = false;
+
+    for (int row = first_row; row <= last_row; row++) {
+        int strip_line = (row - MATRIX_ROWS) * BORDER_STRIP_LINES;
+        uint32_t cost = row < MATRIX_ROWS
+            ? renderer.count_palette_row_pixels(index, row)
+            : renderer.border_pixels(strip_line, BORDER_STRIP_LINES);
+        if (cost == 0) {
+            continue;
+        }
+        // Шаг дороже остатка ждёт пополнения; без очереди идёт только шаг дороже всего бюджета
+        if (cost > pixel_budget && (painted || cost <= COLOR_ANIM_PIXEL_BUDGET)) {
+            return row;
+        }
+        if (row < MATRIX_ROWS) {
+            renderer.repaint_palette_row(index, row, color);
+        } else {
+            renderer.clear_border_lines(strip_line, BORDER_STRIP_LINES, color);
+        }
+        pixel_budget = cost < pixel_budget ? pixel_budget - cost : 0;
+        painted = true;
+    }
+    return PALETTE_REPAINT_DONE;
+}
+
+void set_palette_entry(uint8_t index, uint16_t color, bool repaint) {
+    if (index >= FACE_PALETTE_SIZE || active_palette.colors[index] == color) {
+        return;
+    }
+    active_palette.colors[index] = color;
+    if (index == PALETTE_BG) {
+        update_coverage_ramps();
+    } else {
+        update_coverage_ramp(index);
+    }
+
+    auto& renderer = main_face_renderer();
+    if (repaint && renderer.is_initialized()) {
+        for (int row = 0; row < MATRIX_ROWS; row++) {
+            renderer.repaint_palette_row(index, row, color);
+        }
+        if (index == PALETTE_BG) {
+            renderer.clear_border(color);
+        }
+    }
+}
+
+void set_palette(const Palette& palette) {
+    for (int i = 0; i < FACE_PALETTE_SIZE; i++) {
+        set_palette_entry(i, palette.colors[i]);
+    }
+}
+
+const Palette& get_active_palette() {
+    return active_palette;
+}
+
+void set_cell_style(CellStyle style) {
+    if (style == cell_style) {
+        return;
+    }
+    cell_style = style;
+    printf("[RENDER] Cell style: %s\n", style == CELL_STYLE_ROUNDED ? "rounded" : "flat");
+
+    // Перерисовываем то, что сейчас на экране (у неактивных геометрий ничего нет)
+#define REFRESH_FACE_RENDERER(rows, cols) face_renderer<rows, cols>().refresh();
+    FACE_GEOMETRY_LIST(REFRESH_FACE_RENDERER)
+#undef REFRESH_FACE_RENDERER
+}
+
+CellStyle get_cell_style() {
+    return cell_style;
+}
+
+void prepare_cell_tiles() {
+    uint32_t start = time_us_32();
+#define PREPARE_CELL_TILES(rows, cols) cell_tiles<FaceGeometry<rows, cols>::CELL_SIZE>();
+    FACE_GEOMETRY_LIST(PREPARE_CELL_TILES)
+#undef PREPARE_CELL_TILES
+    update_coverage_ramps();
+    printf("[RENDER] Cell tiles generated in %lu us\n", (unsigned long)(time_us_32() - start));
+}
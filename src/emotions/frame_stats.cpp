@@ -0,0 +1,134 @@
+#include "frame_stats.h"
+#include <stdio.h>
+#include <cstring>
+
+// Гистограмма опоздания: мелкие корзины до 32 мс, крупные до ~1 с
+static const uint32_t FINE_BUCKET_US = 250;
+static const int FINE_BUCKETS = 128;
+static const uint32_t COARSE_BUCKET_US = 16000;
+static const int COARSE_BUCKETS = 64;
+static const int HISTOGRAM_BUCKETS = FINE_BUCKETS + COARSE_BUCKETS + 1;  // + overflow
+static const uint32_t FINE_LIMIT_US = FINE_BUCKET_US * FINE_BUCKETS;
+
+static const char* const STAT_EMOTIONS[] = {
+    "neutral", "smile", "smile_love", "embarrassed",
+    "scary", "happy", "sad", "surprise", "talking", "other"
+};
+static const int STAT_EMOTION_COUNT = sizeof(STAT_EMOTIONS) / sizeof(STAT_EMOTIONS[0]);
+
+struct EmotionFrameStats {
+    uint32_t frames;
+    uint32_t misses;
+    uint32_t max_lateness_us;
+    uint16_t histogram[HISTOGRAM_BUCKETS];
+};
+
+static EmotionFrameStats frame_stats[STAT_EMOTION_COUNT];
+static int current_stats = STAT_EMOTION_COUNT - 1;
+static bool frame_pending = false;
+static uint32_t pending_intended_us = 0;
+
+static int bucket_for(uint32_t lateness_us) {
+    if (lateness_us < FINE_LIMIT_US) {
+        return lateness_us / FINE_BUCKET_US;
+    }
+    uint32_t coarse = (lateness_us - FINE_LIMIT_US) / COARSE_BUCKET_US;
+    return coarse < (uint32_t)COARSE_BUCKETS ? FINE_BUCKETS + coarse : HISTOGRAM_BUCKETS - 1;
+}
+
+// Upper edge of a bucket, used as the reported percentile value
+static uint32_t bucket_limit_us(int bucket) {
+    if (bucket < FINE_BUCKETS) {
+        return (bucket + 1) * FINE_BUCKET_US;
+    }
+    return FINE_LIMIT_US + (bucket - FINE_BUCKETS + 1) * COARSE_BUCKET_US;
+}
+
+static uint32_t percentile_us(const EmotionFrameStats& stats, uint32_t permille) {
+    uint32_t total = 0;
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        total += stats.histogram[i];
+    }
+    if (total == 0) {
+        return 0;
+    }
+    uint32_t target = (total * permille + 999) / 1000;
+    uint32_t seen = 0;
+    for (int i = 0; i < HISTOGRAM_BUCKETS - 1; i++) {
+        seen += stats.histogram[i];
+        if (seen >= target) {
+            uint32_t limit = bucket_limit_us(i);
+            return limit < stats.max_lateness_us ? limit : stats.max_lateness_us;
+        }
+    }
+    return stats.max_lateness_us;
+}
+
+void frame_stats_set_emotion(std::string_view emotion) {
+    frame_pending = false;
+    current_stats = STAT_EMOTION_COUNT - 1;
+    for (int i = 0; i < STAT_EMOTION_COUNT - 1; i++) {
+        if (emotion == STAT_EMOTIONS[i]) {
+            current_stats = i;
+            break;
+        }
+    }
+}
+
+static void frame_stats_record(uint32_t intended_us, uint32_t presented_us) {
+    EmotionFrameStats& stats = frame_stats[current_stats];
+    int32_t delta = (int32_t)(presented_us - intended_us);
+    uint32_t lateness_us = delta > 0 ? (uint32_t)delta : 0;
+
+    stats.frames++;
+    if (lateness_us > stats.max_lateness_us) {
+        stats.max_lateness_us = lateness_us;
+    }
+
+    uint16_t& count = stats.histogram[bucket_for(lateness_us)];
+    if (count == UINT16_MAX) {
+        // Старые кадры теряют вес, форма распределения сохраняется
+        for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+            stats.histogram[i] >>= 1;
+        }
+    }
+    count++;
+
+    if (lateness_us > FRAME_DEADLINE_US) {
+        stats.misses++;
+        printf("[FRAME_MISS] %s frame late by %lu us (budget %d us)\n",
+               STAT_EMOTIONS[current_stats], lateness_us, FRAME_DEADLINE_US);
+    }
+}
+
+void frame_stats_schedule(uint32_t intended_us) {
+    frame_pending = true;
+    pending_intended_us = intended_us;
+}
+
+void frame_stats_presented(uint32_t presented_us) {
+    if (!frame_pending) {
+        return;
+    }
+    frame_pending = false;
+    frame_stats_record(pending_intended_us, presented_us);
+}
+
+void frame_stats_report() {
+    printf("[FRAME_STATS] budget=%d us\n", FRAME_DEADLINE_US);
+    for (int i = 0; i < STAT_EMOTION_COUNT; i++) {
+        const EmotionFrameStats& stats = frame_stats[i];
+        if (stats.frames == 0) {
+            continue;
+        }
+        printf("{\"frame_stats\": \"%s\", \"frames\": %lu, \"misses\": %lu, "
+               "\"p50_us\": %lu, \"p99_us\": %lu, \"max_us\": %lu}\n",
+               STAT_EMOTIONS[i], stats.frames, stats.misses,
+               percentile_us(stats, 500), percentile_us(stats, 990), stats.max_lateness_us);
+    }
+}
+
+void frame_stats_reset() {
+    memset(frame_stats, 0, sizeof(frame_stats));
+    printf("[FRAME_STATS] Counters reset\n");
+}
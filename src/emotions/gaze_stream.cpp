@@ -0,0 +1,157 @@
+#include "gaze_stream.h"
+#include "eyes.h"
+#include "pico/stdlib.h"
+#include <stdio.h>
+#include <cstdlib>
+#include <algorithm>
+
+// Последние измерения задержки команда -> запись на панель
+#define GAZE_LATENCY_SAMPLES 64
+// Шаг интегрирования пружины, длинные паузы между вызовами режутся на шаги
+#define GAZE_STEP_US 5000
+#define GAZE_MAX_DT_US 50000
+
+// Позиция и скорость по оси в Q16 (единицы взгляда -100..100)
+struct GazeAxis {
+    int64_t position;
+    int64_t velocity;
+    int64_t target;
+};
+
+static GazeAxis axes[2];
+static bool active = false;
+static uint32_t last_target_us = 0;
+static uint32_t last_update_us = 0;
+static uint32_t last_seq = 0;
+
+static bool pending = false;
+static uint32_t pending_rx_us = 0;
+
+static uint32_t targets = 0;
+static uint32_t superseded = 0;
+static uint32_t presented = 0;
+static uint32_t max_latency_us = 0;
+static uint32_t latency_samples[GAZE_LATENCY_SAMPLES];
+static uint32_t latency_count = 0;
+
+static int64_t to_q16(int value) {
+    return (int64_t)std::max(-100, std::min(100, value)) << 16;
+}
+
+static int from_q16(int64_t value) {
+    return (int)((value + (1 << 15)) >> 16);
+}
+
+void gaze_stream_line(const char* line, uint32_t rx_us) {
+    char* end = nullptr;
+    const char* cursor = line + 1;  // после 'G'
+    long x = strtol(cursor, &end, 10);
+    if (end == cursor) {
+        return;
+    }
+    cursor = end;
+    long y = strtol(cursor, &end, 10);
+    if (end == cursor) {
+        return;
+    }
+    cursor = end;
+    long seq = strtol(cursor, &end, 10);
+    if (end != cursor) {
+        last_seq = (uint32_t)seq;
+    }
+
+    if (!active) {
+        // Пружина стартует с того места, куда глаза смотрят сейчас
+        const EyeParams& params = eyes_get_params();
+        axes[0] = {to_q16(params.gaze_x), 0, 0};
+        axes[1] = {to_q16(params.gaze_y), 0, 0};
+        last_update_us = rx_us;
+        active = true;
+    }
+    axes[0].target = to_q16(x);
+    axes[1].target = to_q16(y);
+    last_target_us = rx_us;
+
+    targets++;
+    // Предыдущая цель так и не попала на экран - задержку меряем от новой
+    if (pending) {
+        superseded++;
+    }
+    pending = true;
+    pending_rx_us = rx_us;
+}
+
+void gaze_stream_update(uint32_t now_us) {
+    if (!active) {
+        return;
+    }
+
+    if (now_us - last_target_us > GAZE_STREAM_TIMEOUT_MS * 1000u) {
+        axes[0].target = 0;
+        axes[1].target = 0;
+    }
+
+    // Критически затухающая пружина: a = w^2 (target - x) - 2 w v
+    uint32_t dt = std::min<uint32_t>(now_us - last_update_us, GAZE_MAX_DT_US);
+    last_update_us = now_us;
+    while (dt > 0) {
+        uint32_t step = std::min<uint32_t>(dt, GAZE_STEP_US);
+        for (GazeAxis& axis : axes) {
+            int64_t accel = (int64_t)GAZE_OMEGA * GAZE_OMEGA * (axis.target - axis.position)
+                          - 2 * GAZE_OMEGA * axis.velocity;
+            axis.velocity += accel * step / 1000000;
+            axis.position += axis.velocity * step / 1000000;
+        }
+        dt -= step;
+    }
+    eyes_set_gaze(from_q16(axes[0].position), from_q16(axes[1].position));
+
+    // После таймаута поток заканчивается, когда глаза вернулись в центр
+    bool settled = true;
+    for (const GazeAxis& axis : axes) {
+        settled &= axis.target == 0 && std::abs(axis.position) < (1 << 15) && std::abs(axis.velocity) < (1 << 16);
+    }
+    if (settled) {
+        eyes_set_gaze(0, 0);
+        active = false;
+        pending = false;
+    }
+}
+
+bool gaze_stream_active() {
+    return active;
+}
+
+void gaze_stream_presented(uint32_t presented_us) {
+    if (!pending) {
+        return;
+    }
+    pending = false;
+    uint32_t latency = presented_us - pending_rx_us;
+    latency_samples[presented % GAZE_LATENCY_SAMPLES] = latency;
+    presented++;
+    latency_count = std::min<uint32_t>(latency_count + 1, GAZE_LATENCY_SAMPLES);
+    max_latency_us = std::max(max_latency_us, latency);
+}
+
+void gaze_stream_report() {
+    uint32_t sorted[GAZE_LATENCY_SAMPLES];
+    std::copy(latency_samples, latency_samples + latency_count, sorted);
+    std::sort(sorted, sorted + latency_count);
+    auto percentile = [&](uint32_t permille) -> uint32_t {
+        return latency_count ? sorted[(latency_count - 1) * permille / 1000] : 0;
+    };
+
+    printf("{\"gaze_stats\": \"stream\", \"targets\": %lu, \"superseded\": %lu, \"presented\": %lu, "
+           "\"last_seq\": %lu, \"p50_us\": %lu, \"p99_us\": %lu, \"max_us\": %lu}\n",
+           targets, superseded, presented, last_seq,
+           percentile(500), percentile(990), max_latency_us);
+}
+
+void gaze_stream_reset_stats() {
+    targets = 0;
+    superseded = 0;
+    presented = 0;
+    max_latency_us = 0;
+    latency_count = 0;
+}
@@ -1,7 +1,13 @@
 #include "mrx.h"
+#include "palette.h"
+#include "boot_splash.h"
+#include "hot_path.h"
+#include "face_assets.h"
+
+// Faces and span tables are HOT_ASSET: read every frame, so in SRAM with ROBOT_RAM_HOT_PATH
 
 // Angry expressions
-const uint8_t ANGRY_CLOSED_MOUTH[MATRIX_ROWS][MATRIX_COLS] = {
+HOT_ASSET constexpr uint8_t ANGRY_CLOSED_MOUTH[MATRIX_ROWS][MATRIX_COLS] = {
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 1, 0, 0, 0, 0, 0, 0, 1, 0, 0},  // Глаза
@@ -16,7 +22,7 @@ const uint8_t ANGRY_CLOSED_MOUTH[MATRIX_ROWS][MATRIX_COLS] = {
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}
 };
 
-const uint8_t ANGRY_CLOSED[MATRIX_ROWS][MATRIX_COLS] = {
+HOT_ASSET constexpr uint8_t ANGRY_CLOSED[MATRIX_ROWS][MATRIX_COLS] = {
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 1, 0, 0, 0, 0, 0, 0, 1, 0, 0},  // Глаза
@@ -31,7 +37,7 @@ const uint8_t ANGRY_CLOSED[MATRIX_ROWS][MATRIX_COLS] = {
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}
 };
 
-const uint8_t ANGRY_OPEN_MOUTH[MATRIX_ROWS][MATRIX_COLS] = {
+HOT_ASSET constexpr uint8_t ANGRY_OPEN_MOUTH[MATRIX_ROWS][MATRIX_COLS] = {
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 1, 0, 0, 0, 0, 0, 0, 1, 0, 0},  // Глаза
@@ -47,7 +53,7 @@ const uint8_t ANGRY_OPEN_MOUTH[MATRIX_ROWS][MATRIX_COLS] = {
 };
 
 // Neutral expressions
-const uint8_t NEUTRAL_NO_BLINK[MATRIX_ROWS][MATRIX_COLS] = {
+HOT_ASSET constexpr uint8_t NEUTRAL_NO_BLINK[MATRIX_ROWS][MATRIX_COLS] = {
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 1, 1, 0, 0, 0, 0, 1, 1, 0, 0},
@@ -62,7 +68,7 @@ const uint8_t NEUTRAL_NO_BLINK[MATRIX_ROWS][MATRIX_COLS] = {
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}
 };
 
-const uint8_t NEUTRAL_BLINK[MATRIX_ROWS][MATRIX_COLS] = {
+HOT_ASSET constexpr uint8_t NEUTRAL_BLINK[MATRIX_ROWS][MATRIX_COLS] = {
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
@@ -77,7 +83,7 @@ const uint8_t NEUTRAL_BLINK[MATRIX_ROWS][MATRIX_COLS] = {
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}
 };
 
-const uint8_t NEUTRAL_YAWN[MATRIX_ROWS][MATRIX_COLS] = {
+HOT_ASSET constexpr uint8_t NEUTRAL_YAWN[MATRIX_ROWS][MATRIX_COLS] = {
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 1, 1, 0, 0, 0, 0, 1, 1, 0, 0},
@@ -92,7 +98,7 @@ const uint8_t NEUTRAL_YAWN[MATRIX_ROWS][MATRIX_COLS] = {
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}
 };
 
-const uint8_t NEUTRAL_SLEEP[MATRIX_ROWS][MATRIX_COLS] = {
+HOT_ASSET constexpr uint8_t NEUTRAL_SLEEP[MATRIX_ROWS][MATRIX_COLS] = {
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
@@ -107,7 +113,7 @@ const uint8_t NEUTRAL_SLEEP[MATRIX_ROWS][MATRIX_COLS] = {
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}
 };
 
-const uint8_t NEUTRAL_HALF_BLINK[MATRIX_ROWS][MATRIX_COLS] = {
+HOT_ASSET constexpr uint8_t NEUTRAL_HALF_BLINK[MATRIX_ROWS][MATRIX_COLS] = {
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
@@ -122,7 +128,7 @@ const uint8_t NEUTRAL_HALF_BLINK[MATRIX_ROWS][MATRIX_COLS] = {
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}
 };
 
-const uint8_t NEUTRAL_CIRCLE[MATRIX_ROWS][MATRIX_COLS] = {
+HOT_ASSET constexpr uint8_t NEUTRAL_CIRCLE[MATRIX_ROWS][MATRIX_COLS] = {
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 1, 1, 0, 0, 0, 0, 1, 1, 0, 0},
@@ -138,7 +144,7 @@ const uint8_t NEUTRAL_CIRCLE[MATRIX_ROWS][MATRIX_COLS] = {
 };
 
 // Smile expressions
-const uint8_t SMILE[MATRIX_ROWS][MATRIX_COLS] = {
+HOT_ASSET constexpr uint8_t SMILE[MATRIX_ROWS][MATRIX_COLS] = {
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 1, 1, 0, 0, 0, 0, 1, 1, 0, 0},
@@ -153,7 +159,7 @@ const uint8_t SMILE[MATRIX_ROWS][MATRIX_COLS] = {
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}
 };
 
-const uint8_t SMILE_A[MATRIX_ROWS][MATRIX_COLS] = {
+HOT_ASSET constexpr uint8_t SMILE_A[MATRIX_ROWS][MATRIX_COLS] = {
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0},
@@ -168,7 +174,7 @@ const uint8_t SMILE_A[MATRIX_ROWS][MATRIX_COLS] = {
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}
 };
 
-const uint8_t SMILE_B[MATRIX_ROWS][MATRIX_COLS] = {
+HOT_ASSET constexpr uint8_t SMILE_B[MATRIX_ROWS][MATRIX_COLS] = {
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0},
@@ -184,13 +190,13 @@ const uint8_t SMILE_B[MATRIX_ROWS][MATRIX_COLS] = {
 };
 
 // Love smile expressions
-const uint8_t SMILE_LOVE[MATRIX_ROWS][MATRIX_COLS] = {
+HOT_ASSET constexpr uint8_t SMILE_LOVE[MATRIX_ROWS][MATRIX_COLS] = {
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
-    {0, 0, 1, 0, 1, 0, 0, 1, 0, 1, 0, 0},
-    {0, 0, 1, 1, 1, 0, 0, 1, 1, 1, 0, 0},
-    {0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0},
+    {0, 0, 2, 0, 2, 0, 0, 2, 0, 2, 0, 0},  // Сердечки (палитра 2)
+    {0, 0, 2, 2, 2, 0, 0, 2, 2, 2, 0, 0},
+    {0, 0, 0, 2, 0, 0, 0, 0, 2, 0, 0, 0},
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 1, 0, 0, 0, 0, 0, 0, 1, 0, 0},
     {0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0},
@@ -199,13 +205,13 @@ const uint8_t SMILE_LOVE[MATRIX_ROWS][MATRIX_COLS] = {
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}
 };
 
-const uint8_t SMILE_LOVE_A[MATRIX_ROWS][MATRIX_COLS] = {
+HOT_ASSET constexpr uint8_t SMILE_LOVE_A[MATRIX_ROWS][MATRIX_COLS] = {
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
-    {0, 0, 1, 0, 1, 0, 0, 1, 0, 1, 0, 0},
-    {0, 0, 1, 1, 1, 0, 0, 1, 1, 1, 0, 0},
-    {0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0},
+    {0, 0, 2, 0, 2, 0, 0, 2, 0, 2, 0, 0},  // Сердечки (палитра 2)
+    {0, 0, 2, 2, 2, 0, 0, 2, 2, 2, 0, 0},
+    {0, 0, 0, 2, 0, 0, 0, 0, 2, 0, 0, 0},
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0},
     {0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0},
@@ -214,13 +220,13 @@ const uint8_t SMILE_LOVE_A[MATRIX_ROWS][MATRIX_COLS] = {
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}
 };
 
-const uint8_t SMILE_LOVE_B[MATRIX_ROWS][MATRIX_COLS] = {
+HOT_ASSET constexpr uint8_t SMILE_LOVE_B[MATRIX_ROWS][MATRIX_COLS] = {
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
-    {0, 0, 1, 0, 1, 0, 0, 1, 0, 1, 0, 0},
-    {0, 0, 1, 1, 1, 0, 0, 1, 1, 1, 0, 0},
-    {0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0},
+    {0, 0, 2, 0, 2, 0, 0, 2, 0, 2, 0, 0},  // Сердечки (палитра 2)
+    {0, 0, 2, 2, 2, 0, 0, 2, 2, 2, 0, 0},
+    {0, 0, 0, 2, 0, 0, 0, 0, 2, 0, 0, 0},
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 0, 1, 1, 1, 1, 1, 1, 0, 0, 0},
@@ -230,7 +236,7 @@ const uint8_t SMILE_LOVE_B[MATRIX_ROWS][MATRIX_COLS] = {
 };
 
 // Embarrassed expression
-const uint8_t EMBARRASSED[MATRIX_ROWS][MATRIX_COLS] = {
+HOT_ASSET constexpr uint8_t EMBARRASSED[MATRIX_ROWS][MATRIX_COLS] = {
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
@@ -238,7 +244,7 @@ const uint8_t EMBARRASSED[MATRIX_ROWS][MATRIX_COLS] = {
     {0, 0, 1, 1, 0, 0, 0, 0, 1, 1, 0, 0},
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
-    {0, 0, 1, 1, 0, 0, 0, 0, 1, 1, 0, 0},
+    {0, 0, 3, 3, 0, 0, 0, 0, 3, 3, 0, 0},  // Румянец (палитра 3)
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0},
     {0, 0, 0, 0, 1, 1, 1, 1, 0, 0, 0, 0},
@@ -246,7 +252,7 @@ const uint8_t EMBARRASSED[MATRIX_ROWS][MATRIX_COLS] = {
 };
 
 // Surprise expression
-const uint8_t SURPRISE[MATRIX_ROWS][MATRIX_COLS] = {
+HOT_ASSET constexpr uint8_t SURPRISE[MATRIX_ROWS][MATRIX_COLS] = {
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 1, 1, 0, 0, 0, 0, 1, 1, 0, 0},
@@ -262,7 +268,7 @@ const uint8_t SURPRISE[MATRIX_ROWS][MATRIX_COLS] = {
 };
 
 // Sad expressions
-const uint8_t SAD[MATRIX_ROWS][MATRIX_COLS] = {
+HOT_ASSET constexpr uint8_t SAD[MATRIX_ROWS][MATRIX_COLS] = {
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0},
@@ -277,7 +283,7 @@ const uint8_t SAD[MATRIX_ROWS][MATRIX_COLS] = {
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}
 };
 
-const uint8_t SAD_A[MATRIX_ROWS][MATRIX_COLS] = {
+HOT_ASSET constexpr uint8_t SAD_A[MATRIX_ROWS][MATRIX_COLS] = {
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 1, 1, 0, 0, 0, 0, 1, 1, 0, 0},
@@ -293,7 +299,7 @@ const uint8_t SAD_A[MATRIX_ROWS][MATRIX_COLS] = {
 };
 
 // Happy expressions
-const uint8_t HAPPY[MATRIX_ROWS][MATRIX_COLS] = {
+HOT_ASSET constexpr uint8_t HAPPY[MATRIX_ROWS][MATRIX_COLS] = {
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 1, 1, 0, 0, 0, 0, 1, 1, 0, 0},
@@ -308,7 +314,7 @@ const uint8_t HAPPY[MATRIX_ROWS][MATRIX_COLS] = {
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}
 };
 
-const uint8_t HAPPY_CIRCLE[MATRIX_ROWS][MATRIX_COLS] = {
+HOT_ASSET constexpr uint8_t HAPPY_CIRCLE[MATRIX_ROWS][MATRIX_COLS] = {
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 1, 1, 0, 0, 0, 0, 1, 1, 0, 0},
@@ -324,7 +330,7 @@ const uint8_t HAPPY_CIRCLE[MATRIX_ROWS][MATRIX_COLS] = {
 };
 
 // Scary expressions
-const uint8_t SCARY_A[MATRIX_ROWS][MATRIX_COLS] = {
+HOT_ASSET constexpr uint8_t SCARY_A[MATRIX_ROWS][MATRIX_COLS] = {
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 1, 0, 0, 0, 0, 0, 0, 1, 0, 0},
@@ -339,7 +345,7 @@ const uint8_t SCARY_A[MATRIX_ROWS][MATRIX_COLS] = {
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}
 };
 
-const uint8_t SCARY_B[MATRIX_ROWS][MATRIX_COLS] = {
+HOT_ASSET constexpr uint8_t SCARY_B[MATRIX_ROWS][MATRIX_COLS] = {
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 1, 0, 0, 0, 0, 0, 0, 1, 0, 0},
@@ -354,7 +360,7 @@ const uint8_t SCARY_B[MATRIX_ROWS][MATRIX_COLS] = {
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}
 };
 
-const uint8_t SCARY_C[MATRIX_ROWS][MATRIX_COLS] = {
+HOT_ASSET constexpr uint8_t SCARY_C[MATRIX_ROWS][MATRIX_COLS] = {
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 1, 0, 0, 0, 0, 0, 0, 1, 0, 0},
@@ -369,7 +375,7 @@ const uint8_t SCARY_C[MATRIX_ROWS][MATRIX_COLS] = {
     {0, 0, 0, 1, 1, 1, 1, 1, 1, 0, 0, 0}
 };
 
-const uint8_t SCARY_D[MATRIX_ROWS][MATRIX_COLS] = {
+HOT_ASSET constexpr uint8_t SCARY_D[MATRIX_ROWS][MATRIX_COLS] = {
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 1, 0, 0, 0, 0, 0, 0, 1, 0, 0},
@@ -385,7 +391,7 @@ const uint8_t SCARY_D[MATRIX_ROWS][MATRIX_COLS] = {
 };
 
 // Talking expressions
-const uint8_t TALKING_A[MATRIX_ROWS][MATRIX_COLS] = {
+HOT_ASSET constexpr uint8_t TALKING_A[MATRIX_ROWS][MATRIX_COLS] = {
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 1, 1, 0, 0, 0, 0, 1, 1, 0, 0},
@@ -400,7 +406,7 @@ const uint8_t TALKING_A[MATRIX_ROWS][MATRIX_COLS] = {
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}
 };
 
-const uint8_t TALKING_B[MATRIX_ROWS][MATRIX_COLS] = {
+HOT_ASSET constexpr uint8_t TALKING_B[MATRIX_ROWS][MATRIX_COLS] = {
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 1, 1, 0, 0, 0, 0, 1, 1, 0, 0},
@@ -416,7 +422,7 @@ const uint8_t TALKING_B[MATRIX_ROWS][MATRIX_COLS] = {
 };
 
 // Tricky talking expressions
-const uint8_t TALKING_TRICKY_A[MATRIX_ROWS][MATRIX_COLS] = {
+HOT_ASSET constexpr uint8_t TALKING_TRICKY_A[MATRIX_ROWS][MATRIX_COLS] = {
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 1, 1, 0, 0, 0, 0, 1, 1, 0, 0},
@@ -431,7 +437,7 @@ const uint8_t TALKING_TRICKY_A[MATRIX_ROWS][MATRIX_COLS] = {
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}
 };
 
-const uint8_t TALKING_TRICKY_B[MATRIX_ROWS][MATRIX_COLS] = {
+HOT_ASSET constexpr uint8_t TALKING_TRICKY_B[MATRIX_ROWS][MATRIX_COLS] = {
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 1, 1, 0, 0, 0, 0, 1, 1, 0, 0},
@@ -447,7 +453,7 @@ const uint8_t TALKING_TRICKY_B[MATRIX_ROWS][MATRIX_COLS] = {
 };
 
 // Tricky smile expressions
-const uint8_t SMILE_TRICKY_A[MATRIX_ROWS][MATRIX_COLS] = {
+HOT_ASSET constexpr uint8_t SMILE_TRICKY_A[MATRIX_ROWS][MATRIX_COLS] = {
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0},
@@ -462,7 +468,7 @@ const uint8_t SMILE_TRICKY_A[MATRIX_ROWS][MATRIX_COLS] = {
     {0, 0, 0, 0, 1, 1, 1, 1, 0, 0, 0, 0}
 };
 
-const uint8_t SMILE_TRICKY_B[MATRIX_ROWS][MATRIX_COLS] = {
+HOT_ASSET constexpr uint8_t SMILE_TRICKY_B[MATRIX_ROWS][MATRIX_COLS] = {
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0},
@@ -475,4 +481,121 @@ const uint8_t SMILE_TRICKY_B[MATRIX_ROWS][MATRIX_COLS] = {
     {0, 0, 1, 0, 1, 0, 0, 1, 0, 1, 0, 0},
     {0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0},
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}
-};
\ No newline at end of file
+};
+
+// Run-length span tables, built by the compiler from the matrices above
+#define FACE_SPANS(name) \
+    static_assert(face_fits_palette(name), #name " uses a colour outside the palette"); \
+    HOT_ASSET constexpr FaceSpans name##_SPANS = make_face_spans(name)
+
+FACE_SPANS(ANGRY_CLOSED_MOUTH);
+FACE_SPANS(ANGRY_CLOSED);
+FACE_SPANS(ANGRY_OPEN_MOUTH);
+FACE_SPANS(NEUTRAL_NO_BLINK);
+FACE_SPANS(NEUTRAL_BLINK);
+FACE_SPANS(NEUTRAL_YAWN);
+FACE_SPANS(NEUTRAL_SLEEP);
+FACE_SPANS(NEUTRAL_HALF_BLINK);
+FACE_SPANS(NEUTRAL_CIRCLE);
+FACE_SPANS(SMILE);
+FACE_SPANS(SMILE_A);
+FACE_SPANS(SMILE_B);
+FACE_SPANS(SMILE_LOVE);
+FACE_SPANS(SMILE_LOVE_A);
+FACE_SPANS(SMILE_LOVE_B);
+FACE_SPANS(EMBARRASSED);
+FACE_SPANS(SURPRISE);
+FACE_SPANS(SAD);
+FACE_SPANS(SAD_A);
+FACE_SPANS(HAPPY);
+FACE_SPANS(HAPPY_CIRCLE);
+FACE_SPANS(SCARY_A);
+FACE_SPANS(SCARY_B);
+FACE_SPANS(SCARY_C);
+FACE_SPANS(SCARY_D);
+FACE_SPANS(TALKING_A);
+FACE_SPANS(TALKING_B);
+FACE_SPANS(TALKING_TRICKY_A);
+FACE_SPANS(TALKING_TRICKY_B);
+FACE_SPANS(SMILE_TRICKY_A);
+FACE_SPANS(SMILE_TRICKY_B);
+
+// Лица, у которых глаза доходят до ряда 6 или рот начинается в ряду 6
+static_assert(face_eyes_last_row(SCARY_A) == 6, "scary eyes reach row 6");
+static_assert(face_eyes_last_row(SURPRISE) == 4 && face_eyes_last_row(HAPPY) == 4,
+              "row 6 of surprise and happy is the mouth");
+
+#define FACE_SPAN_ENTRY(name) { &name, &name##_SPANS, face_eyes_last_row(name) }
+
+HOT_ASSET static const struct {
+    const uint8_t (*matrix)[MATRIX_ROWS][MATRIX_COLS];
+    const FaceSpans* spans;
+    int8_t eyes_last_row;
+} FACE_SPAN_TABLE[] = {
+    FACE_SPAN_ENTRY(ANGRY_CLOSED_MOUTH),
+    FACE_SPAN_ENTRY(ANGRY_CLOSED),
+    FACE_SPAN_ENTRY(ANGRY_OPEN_MOUTH),
+    FACE_SPAN_ENTRY(NEUTRAL_NO_BLINK),
+    FACE_SPAN_ENTRY(NEUTRAL_BLINK),
+    FACE_SPAN_ENTRY(NEUTRAL_YAWN),
+    FACE_SPAN_ENTRY(NEUTRAL_SLEEP),
+    FACE_SPAN_ENTRY(NEUTRAL_HALF_BLINK),
+    FACE_SPAN_ENTRY(NEUTRAL_CIRCLE),
+    FACE_SPAN_ENTRY(SMILE),
+    FACE_SPAN_ENTRY(SMILE_A),
+    FACE_SPAN_ENTRY(SMILE_B),
+    FACE_SPAN_ENTRY(SMILE_LOVE),
+    FACE_SPAN_ENTRY(SMILE_LOVE_A),
+    FACE_SPAN_ENTRY(SMILE_LOVE_B),
+    FACE_SPAN_ENTRY(EMBARRASSED),
+    FACE_SPAN_ENTRY(SURPRISE),
+    FACE_SPAN_ENTRY(SAD),
+    FACE_SPAN_ENTRY(SAD_A),
+    FACE_SPAN_ENTRY(HAPPY),
+    FACE_SPAN_ENTRY(HAPPY_CIRCLE),
+    FACE_SPAN_ENTRY(SCARY_A),
+    FACE_SPAN_ENTRY(SCARY_B),
+    FACE_SPAN_ENTRY(SCARY_C),
+    FACE_SPAN_ENTRY(SCARY_D),
+    FACE_SPAN_ENTRY(TALKING_A),
+    FACE_SPAN_ENTRY(TALKING_B),
+    FACE_SPAN_ENTRY(TALKING_TRICKY_A),
+    FACE_SPAN_ENTRY(TALKING_TRICKY_B),
+    FACE_SPAN_ENTRY(SMILE_TRICKY_A),
+    FACE_SPAN_ENTRY(SMILE_TRICKY_B),
+};
+
+const FaceSpans* find_face_spans(const uint8_t (&matrix)[MATRIX_ROWS][MATRIX_COLS]) {
+    for (const auto& entry : FACE_SPAN_TABLE) {
+        if (entry.matrix == &matrix) {
+            return entry.spans;
+        }
+    }
+    // Загруженные лица хранят отрезки рядом с клетками во флеше
+    return face_asset_spans(matrix);
+}
+
+int find_face_eyes_last_row(const uint8_t (&matrix)[MATRIX_ROWS][MATRIX_COLS]) {
+    for (const auto& entry : FACE_SPAN_TABLE) {
+        if (entry.matrix == &matrix) {
+            return entry.eyes_last_row;
+        }
+    }
+    return face_eyes_last_row(matrix);
+}
+
+// Upscaled faces for the 24x24 and 48x48 geometries
+constexpr FaceCells<24, 24> NEUTRAL_NO_BLINK_24 = upscale_face<2>(NEUTRAL_NO_BLINK);
+constexpr FaceCells<24, 24> NEUTRAL_BLINK_24 = upscale_face<2>(NEUTRAL_BLINK);
+constexpr FaceCells<48, 48> NEUTRAL_NO_BLINK_48 = upscale_face<4>(NEUTRAL_NO_BLINK);
+constexpr FaceCells<48, 48> NEUTRAL_BLINK_48 = upscale_face<4>(NEUTRAL_BLINK);
+
+// Boot splash lines, flat cells in the default palette
+constexpr FaceLines<MATRIX_ROWS, SplashGeometry::WIDTH> NEUTRAL_SPLASH =
+    make_face_lines<SplashGeometry::CELL_SIZE>(NEUTRAL_NO_BLINK, PALETTE_DEFAULT.colors);
+
+// Effect overlays
+HOT_ASSET constexpr uint8_t BLUSH_CHEEK[1][2] = {
+    {3, 3}  // Румянец (палитра 3)
+};
+const CellSprite BLUSH_CHEEK_SPRITE = {1, 2, &BLUSH_CHEEK[0][0]};
@@ -0,0 +1,22 @@
+#include "palette.h"
+#include "colors.h"
+
+static const Palette PALETTE_ANGRY = {{STYLE_BG, STYLE_FACE_RED, STYLE_FACE_RED, PINK}};
+static const Palette PALETTE_EMBARRASSED = {{STYLE_BG, STYLE_FACE, STYLE_FACE_RED, color565(255, 110, 140)}};
+
+static const struct {
+    const char* emotion;
+    const Palette* palette;
+} EMOTION_PALETTES[] = {
+    {"angry", &PALETTE_ANGRY},
+    {"embarrassed", &PALETTE_EMBARRASSED},
+};
+
+const Palette& palette_for_emotion(std::string_view emotion) {
+    for (const auto& entry : EMOTION_PALETTES) {
+        if (emotion == entry.emotion) {
+            return *entry.palette;
+        }
+    }
+    return PALETTE_DEFAULT;
+}
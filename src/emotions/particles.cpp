@@ -0,0 +1,504 @@
+#include "particles.h"
+#include "face_renderer.h"
+#include "colors.h"
+#include "trace.h"
+#include "hot_path.h"
+#include "panel_effects.h"
+#include "pico/stdlib.h"
+#include <stdio.h>
+#include <cstdlib>
+#include <algorithm>
+
+// Use C driver directly
+extern "C" {
+#include "pico/st7789.h"
+}
+
+using Geometry = FaceGeometry<MATRIX_ROWS, MATRIX_COLS>;
+
+static const int FACE_LEFT = Geometry::X_OFFSET;
+static const int FACE_TOP = Geometry::Y_OFFSET;
+static const int FACE_RIGHT = Geometry::X_OFFSET + Geometry::WIDTH;
+static const int FACE_BOTTOM = Geometry::Y_OFFSET + Geometry::HEIGHT;
+
+// Однобитный спрайт: строка - байт, старший бит - левый пиксель
+struct ParticleSprite {
+    uint8_t width;
+    uint8_t height;
+    uint8_t frames;
+    uint16_t frame_ms;
+    uint16_t color;
+    const uint8_t* rows;  // frames * height
+};
+
+HOT_ASSET static const uint8_t HEART_ROWS[] = {
+    0b01101100,
+    0b11111110,
+    0b11111110,
+    0b01111100,
+    0b00111000,
+    0b00010000,
+};
+
+HOT_ASSET static const uint8_t TEAR_ROWS[] = {
+    0b00100000,
+    0b01110000,
+    0b01110000,
+    0b11111000,
+    0b11111000,
+    0b01110000,
+};
+
+HOT_ASSET static const uint8_t SWEAT_ROWS[] = {
+    0b01000000,
+    0b11100000,
+    0b11100000,
+    0b11100000,
+    0b01000000,
+};
+
+// Искра мерцает: большой крест / маленький ромб
+HOT_ASSET static const uint8_t SPARKLE_ROWS[] = {
+    0b00100000,
+    0b00100000,
+    0b11111000,
+    0b00100000,
+    0b00100000,
+
+    0b00000000,
+    0b00100000,
+    0b01110000,
+    0b00100000,
+    0b00000000,
+};
+
+// Физика вида частицы: ускорение (пикс/с^2, минус - вверх) и время жизни
+struct ParticleKindInfo {
+    ParticleSprite sprite;
+    int16_t gravity;
+    uint16_t life_ms;
+};
+
+static const ParticleKindInfo PARTICLE_KINDS[PARTICLE_KIND_COUNT] = {
+    {{7, 6, 1, 0, STYLE_FACE_RED, HEART_ROWS}, -20, 2500},   // PARTICLE_HEART
+    {{5, 6, 1, 0, LIGHT_BLUE, TEAR_ROWS}, 240, 1500},        // PARTICLE_TEAR
+    {{3, 5, 1, 0, LIGHT_BLUE, SWEAT_ROWS}, 80, 1200},        // PARTICLE_SWEAT
+    {{5, 5, 2, 150, GOLD, SPARKLE_ROWS}, 0, 600},            // PARTICLE_SPARKLE
+};
+
+// Источник частиц эмоции. Область появления - в процентах размера лица,
+// скорость - пикс/с, rate - частиц в секунду при intensity 1.0
+struct ParticleEmitter {
+    const char* emotion;
+    ParticleKind kind;
+    uint16_t rate;
+    int8_t x_min, x_max, y_min, y_max;
+    int16_t vx_min, vx_max, vy_min, vy_max;
+};
+
+static const ParticleEmitter EMOTION_EMITTERS[] = {
+    // Сердечки поднимаются снизу лица
+    {"smile_love", PARTICLE_HEART, 6, 5, 95, 85, 95, -15, 15, -60, -30},
+    // Слёзы из-под каждого глаза
+    {"sad", PARTICLE_TEAR, 2, 20, 30, 48, 50, 0, 0, 10, 30},
+    {"sad", PARTICLE_TEAR, 2, 70, 80, 48, 50, 0, 0, 10, 30},
+    // Капля пота у виска
+    {"embarrassed", PARTICLE_SWEAT, 1, 85, 92, 8, 20, 0, 0, 0, 10},
+    // Искры вокруг верхней части лица
+    {"happy", PARTICLE_SPARKLE, 5, 5, 95, 5, 30, 0, 0, 0, 0},
+};
+
+// [x0, x1) x [y0, y1) в пикселях дисплея
+struct ParticleRect {
+    int16_t x0, y0, x1, y1;
+
+    bool empty() const { return x1 <= x0 || y1 <= y0; }
+    bool operator==(const ParticleRect& other) const {
+        return x0 == other.x0 && y0 == other.y0 && x1 == other.x1 && y1 == other.y1;
+    }
+    bool intersects(const ParticleRect& other) const {
+        return x0 < other.x1 && other.x0 < x1 && y0 < other.y1 && other.y0 < y1;
+    }
+    ParticleRect united(const ParticleRect& other) const {
+        if (empty()) return other;
+        if (other.empty()) return *this;
+        return {std::min(x0, other.x0), std::min(y0, other.y0),
+                std::max(x1, other.x1), std::max(y1, other.y1)};
+    }
+};
+
+// Позиция центра и скорость в Q8 (1/256 пикселя, 1/256 пикс/с)
+struct Particle {
+    int32_t x;
+    int32_t y;
+    int32_t vx;
+    int32_t vy;
+    uint32_t age_ms;
+    ParticleKind kind;
+    bool alive;
+    bool on_screen;
+    uint8_t drawn_frame;
+    ParticleRect drawn;
+};
+
+static Particle pool[PARTICLE_POOL_SIZE];
+static int active_count = 0;
+
+static const ParticleEmitter* emitters[PARTICLE_MAX_EMITTERS];
+static int emitter_count = 0;
+static int64_t spawn_credit[PARTICLE_MAX_EMITTERS];  // 1 частица = SPAWN_CREDIT_UNIT
+static uint32_t intensity_permille = 0;
+static const int64_t SPAWN_CREDIT_UNIT = 1000000000;  // permille * мкс
+
+static uint32_t last_frame_us = 0;
+static bool frame_started = false;
+static uint32_t drawn_epoch = 0;
+
+static ParticleRect dirty[PARTICLE_POOL_SIZE];
+static int dirty_count = 0;
+static uint16_t line[DISPLAY_WIDTH];
+
+// Стоимость кадра частиц
+static uint32_t stat_frames = 0;
+static uint64_t stat_total_us = 0;
+static uint32_t stat_max_us = 0;
+static uint64_t stat_pixels = 0;
+
+static int random_range(int lo, int hi) {
+    return hi > lo ? lo + rand() % (hi - lo + 1) : lo;
+}
+
+static const ParticleSprite& sprite_of(const Particle& p) {
+    return PARTICLE_KINDS[p.kind].sprite;
+}
+
+static uint8_t sprite_frame(const Particle& p) {
+    const ParticleSprite& sprite = sprite_of(p);
+    return sprite.frames > 1 ? (p.age_ms / sprite.frame_ms) % sprite.frames : 0;
+}
+
+// Прямоугольник спрайта, обрезанный по лицу
+static ParticleRect particle_rect(const Particle& p) {
+    const ParticleSprite& sprite = sprite_of(p);
+    int left = (p.x >> 8) - sprite.width / 2;
+    int top = (p.y >> 8) - sprite.height / 2;
+    return {(int16_t)std::max(left, FACE_LEFT), (int16_t)std::max(top, FACE_TOP),
+            (int16_t)std::min(left + sprite.width, FACE_RIGHT),
+            (int16_t)std::min(top + sprite.height, FACE_BOTTOM)};
+}
+
+bool particles_spawn(ParticleKind kind, int x, int y, int vx, int vy) {
+    for (Particle& p : pool) {
+        // Слот ещё на экране - сначала его надо стереть
+        if (p.alive || p.on_screen) {
+            continue;
+        }
+        p.x = x * 256;
+        p.y = y * 256;
+        p.vx = vx * 256;
+        p.vy = vy * 256;
+        p.age_ms = 0;
+        p.kind = kind;
+        p.alive = true;
+        active_count++;
+        return true;
+    }
+    return false;
+}
+
+static void kill(Particle& p) {
+    if (p.alive) {
+        p.alive = false;
+        active_count--;
+    }
+}
+
+static void kill_all() {
+    for (Particle& p : pool) {
+        kill(p);
+    }
+}
+
+static void spawn_from(const ParticleEmitter& emitter) {
+    int x = FACE_LEFT + random_range(emitter.x_min, emitter.x_max) * Geometry::WIDTH / 100;
+    int y = FACE_TOP + random_range(emitter.y_min, emitter.y_max) * Geometry::HEIGHT / 100;
+    particles_spawn(emitter.kind, x, y,
+                    random_range(emitter.vx_min, emitter.vx_max),
+                    random_range(emitter.vy_min, emitter.vy_max));
+}
+
+void particles_start_for_emotion(std::string_view emotion, double intensity) {
+    kill_all();
+    emitter_count = 0;
+    intensity_permille = (uint32_t)(std::max(0.0, std::min(1.0, intensity)) * 1000);
+    for (const ParticleEmitter& emitter : EMOTION_EMITTERS) {
+        if (emotion == emitter.emotion && emitter_count < PARTICLE_MAX_EMITTERS) {
+            spawn_credit[emitter_count] = 0;
+            emitters[emitter_count++] = &emitter;
+        }
+    }
+    if (emitter_count > 0) {
+        printf("[PARTICLES] %d emitter(s) for %.*s, intensity %lu/1000\n",
+               emitter_count, (int)emotion.size(), emotion.data(), intensity_permille);
+    }
+}
+
+void particles_stop() {
+    kill_all();
+    emitter_count = 0;
+}
+
+int particles_active() {
+    return active_count;
+}
+
+// Целочисленная физика: v += g dt, x += v dt
+static void step_particles(uint32_t dt_us) {
+    uint32_t dt_ms = dt_us / 1000;
+    for (Particle& p : pool) {
+        if (!p.alive) {
+            continue;
+        }
+        const ParticleKindInfo& info = PARTICLE_KINDS[p.kind];
+        p.vy += (int32_t)((int64_t)info.gravity * 256 * dt_us / 1000000);
+        p.x += (int32_t)((int64_t)p.vx * dt_us / 1000000);
+        p.y += (int32_t)((int64_t)p.vy * dt_us / 1000000);
+        p.age_ms += dt_ms;
+        if (p.age_ms >= info.life_ms || particle_rect(p).empty()) {
+            kill(p);
+        }
+    }
+}
+
+static void spawn_particles(uint32_t dt_us) {
+    for (int i = 0; i < emitter_count; i++) {
+        spawn_credit[i] += (int64_t)emitters[i]->rate * intensity_permille * dt_us;
+        while (spawn_credit[i] >= SPAWN_CREDIT_UNIT) {
+            spawn_from(*emitters[i]);
+            spawn_credit[i] -= SPAWN_CREDIT_UNIT;
+        }
+    }
+}
+
+// Пересекающиеся прямоугольники сливаются, чтобы пиксели не писались дважды
+static void add_dirty(ParticleRect rect) {
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        for (int i = 0; i < dirty_count; i++) {
+            if (dirty[i].intersects(rect)) {
+                rect = rect.united(dirty[i]);
+                dirty[i] = dirty[--dirty_count];
+                merged = true;
+                break;
+            }
+        }
+    }
+    dirty[dirty_count++] = rect;
+}
+
+static void stamp(const Particle& p, int y, int x0, int x1) {
+    const ParticleSprite& sprite = sprite_of(p);
+    int left = (p.x >> 8) - sprite.width / 2;
+    int sprite_y = y - ((p.y >> 8) - sprite.height / 2);
+    if (sprite_y < 0 || sprite_y >= sprite.height) {
+        return;
+    }
+    uint8_t bits = sprite.rows[sprite_frame(p) * sprite.height + sprite_y];
+    for (int bx = 0; bx < sprite.width; bx++) {
+        int x = left + bx;
+        if ((bits & (0x80 >> bx)) && x >= x0 && x < x1) {
+            line[x - x0] = sprite.color;
+        }
+    }
+}
+
+// Клетки лица, которыми владеет другой слой (глаза), не трогаем
+static bool rect_masked(const ParticleRect& rect) {
+    const auto& renderer = main_face_renderer();
+    int first_row = (rect.y0 - FACE_TOP) / Geometry::CELL_SIZE;
+    int last_row = (rect.y1 - 1 - FACE_TOP) / Geometry::CELL_SIZE;
+    int first_col = (rect.x0 - FACE_LEFT) / Geometry::CELL_SIZE;
+    int last_col = (rect.x1 - 1 - FACE_LEFT) / Geometry::CELL_SIZE;
+    for (int row = first_row; row <= last_row; row++) {
+        for (int col = first_col; col <= last_col; col++) {
+            if (renderer.is_masked(row, col)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+static uint32_t write_rect(const ParticleRect& rect) {
+    const auto& renderer = main_face_renderer();
+    int width = rect.x1 - rect.x0;
+    uint8_t hits[PARTICLE_POOL_SIZE];
+    int hit_count = 0;
+    for (int i = 0; i < PARTICLE_POOL_SIZE; i++) {
+        if (pool[i].alive && particle_rect(pool[i]).intersects(rect)) {
+            hits[hit_count++] = i;
+        }
+    }
+
+    bool masked = rect_masked(rect);
+    if (!masked) {
+        st7789_set_window(rect.x0, rect.y0, rect.x1 - 1, rect.y1 - 1);
+    }
+    for (int y = rect.y0; y < rect.y1; y++) {
+        renderer.compose_screen_line(rect.x0, rect.x1, y, line);
+        for (int i = 0; i < hit_count; i++) {
+            stamp(pool[hits[i]], y, rect.x0, rect.x1);
+        }
+        if (!masked) {
+            st7789_write(line, width * sizeof(uint16_t));
+            continue;
+        }
+        // Строка участками между замаскированными клетками
+        int row = (y - FACE_TOP) / Geometry::CELL_SIZE;
+        int x = rect.x0;
+        while (x < rect.x1) {
+            int col = (x - FACE_LEFT) / Geometry::CELL_SIZE;
+            int cell_end = std::min<int>(rect.x1, FACE_LEFT + (col + 1) * Geometry::CELL_SIZE);
+            if (!renderer.is_masked(row, col)) {
+                st7789_set_window(x, y, cell_end - 1, y);
+                st7789_write(line + (x - rect.x0), (cell_end - x) * sizeof(uint16_t));
+            }
+            x = cell_end;
+        }
+    }
+    return (uint32_t)width * (rect.y1 - rect.y0);
+}
+
+// Перерисовка: объединение старого и нового прямоугольника каждой сдвинувшейся
+// частицы; после перерисовки лица - все частицы на экране
+static uint32_t render_particles() {
+    TRACE_SCOPE(TRACE_DRAW_PARTICLES);
+    const auto& renderer = main_face_renderer();
+    bool face_changed = renderer.epoch() != drawn_epoch;
+    dirty_count = 0;
+
+    for (Particle& p : pool) {
+        if (!p.alive && !p.on_screen) {
+            continue;
+        }
+        ParticleRect now = p.alive ? particle_rect(p) : ParticleRect{0, 0, 0, 0};
+        uint8_t frame = p.alive ? sprite_frame(p) : 0;
+        if (p.alive && p.on_screen && !face_changed && now == p.drawn && frame == p.drawn_frame) {
+            continue;
+        }
+        ParticleRect area = p.on_screen ? p.drawn.united(now) : now;
+        if (!area.empty()) {
+            add_dirty(area);
+        }
+        p.drawn = now;
+        p.drawn_frame = frame;
+        p.on_screen = p.alive && !now.empty();
+    }
+
+    uint32_t pixels = 0;
+    for (int i = 0; i < dirty_count; i++) {
+        pixels += write_rect(dirty[i]);
+    }
+    drawn_epoch = renderer.epoch();
+    return pixels;
+}
+
+static bool anything_on_screen() {
+    for (const Particle& p : pool) {
+        if (p.on_screen) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void particles_update(uint32_t now_us) {
+    if (!frame_started) {
+        last_frame_us = now_us;
+        frame_started = true;
+    }
+    uint32_t dt_us = now_us - last_frame_us;
+    if (dt_us < PARTICLE_FRAME_US) {
+        return;
+    }
+    last_frame_us = now_us;
+    // Под частицами должно быть нарисованное лицо; переход ещё не дописал его
+    if (!main_face_renderer().is_initialized() || panel_slide_active()) {
+        return;
+    }
+    if (emitter_count == 0 && active_count == 0 && !anything_on_screen()) {
+        return;
+    }
+
+    uint32_t start = time_us_32();
+    dt_us = std::min<uint32_t>(dt_us, 50000);
+    step_particles(dt_us);
+    spawn_particles(dt_us);
+    uint32_t pixels = render_particles();
+    uint32_t elapsed = time_us_32() - start;
+
+    stat_frames++;
+    stat_total_us += elapsed;
+    stat_max_us = std::max(stat_max_us, elapsed);
+    stat_pixels += pixels;
+}
+
+void particles_report() {
+    printf("{\"particle_stats\": \"frame\", \"frames\": %lu, \"active\": %d, \"avg_us\": %lu, "
+           "\"max_us\": %lu, \"avg_px\": %lu}\n",
+           stat_frames, active_count,
+           stat_frames ? (uint32_t)(stat_total_us / stat_frames) : 0, stat_max_us,
+           stat_frames ? (uint32_t)(stat_pixels / stat_frames) : 0);
+}
+
+void particles_reset_stats() {
+    stat_frames = 0;
+    stat_total_us = 0;
+    stat_max_us = 0;
+    stat_pixels = 0;
+}
+
+static const int BENCH_FRAMES = 30;
+static const int BENCH_COUNTS[] = {8, 16, 32, PARTICLE_POOL_SIZE};
+
+// Частицы всех видов по сетке над лицом, кадры без ограничения частоты
+void particles_benchmark() {
+    auto& renderer = main_face_renderer();
+    renderer.present(NEUTRAL_NO_BLINK, true);
+
+    int saved_emitters = emitter_count;
+    emitter_count = 0;
+    printf("[BENCH] Particle benchmark, %d frames per count\n", BENCH_FRAMES);
+
+    for (int count : BENCH_COUNTS) {
+        kill_all();
+        render_particles();
+        for (int i = 0; i < count; i++) {
+            int x = FACE_LEFT + 12 + (i % 8) * (Geometry::WIDTH - 24) / 7;
+            int y = FACE_TOP + 12 + (i / 8) * (Geometry::HEIGHT - 24) / 5;
+            particles_spawn((ParticleKind)(i % PARTICLE_KIND_COUNT), x, y, (i % 5) * 10 - 20, -20);
+        }
+
+        uint32_t step_us = 0;
+        uint32_t pixels = 0;
+        uint32_t start = time_us_32();
+        for (int frame = 0; frame < BENCH_FRAMES; frame++) {
+            uint32_t step_start = time_us_32();
+            step_particles(PARTICLE_FRAME_US);
+            step_us += time_us_32() - step_start;
+            pixels += render_particles();
+        }
+        uint32_t frame_us = (time_us_32() - start) / BENCH_FRAMES;
+
+        printf("{\"bench\": \"particles\", \"count\": %d, \"frame_us\": %lu, \"step_us\": %lu, "
+               "\"px\": %lu}\n",
+               count, frame_us, step_us / BENCH_FRAMES, pixels / BENCH_FRAMES);
+    }
+
+    kill_all();
+    render_particles();
+    emitter_count = saved_emitters;
+    // Следующий кадр эмоции снова рисуется целиком
+    renderer.invalidate();
+}
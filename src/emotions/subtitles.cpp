@@ -0,0 +1,354 @@
+#include "subtitles.h"
+#include "subtitle_font.h"
+#include "face_renderer.h"
+#include "emotions.h"
+#include "panel_effects.h"
+#include "pico/stdlib.h"
+#include <stdio.h>
+#include <algorithm>
+
+// Use C driver directly
+extern "C" {
+#include "pico/st7789.h"
+}
+
+using Geometry = FaceGeometry<MATRIX_ROWS, MATRIX_COLS>;
+
+// Полоса под лицом; её строки - кольцо аппаратной прокрутки
+static const int BAND_TOP = Geometry::Y_OFFSET + Geometry::HEIGHT;
+static const int BAND_HEIGHT = DISPLAY_HEIGHT - BAND_TOP;
+
+static const int GLYPH_WIDTH = SUBTITLE_FONT_WIDTH * SUBTITLE_SCALE;
+static const int GLYPH_HEIGHT = SUBTITLE_FONT_HEIGHT * SUBTITLE_SCALE;
+static const int ADVANCE = GLYPH_WIDTH + SUBTITLE_SCALE;
+static const int LINE_PITCH = GLYPH_HEIGHT + 4;
+static const int LINE_TOP_MARGIN = (LINE_PITCH - GLYPH_HEIGHT) / 2;
+static const int VISIBLE_LINES = BAND_HEIGHT / LINE_PITCH;
+static const int LINE_CHARS = DISPLAY_WIDTH / ADVANCE;
+
+static_assert(VISIBLE_LINES >= 1, "Subtitle band is lower than one text line");
+static_assert(BAND_HEIGHT % LINE_PITCH == 0, "Scroll ring must hold whole text lines");
+static_assert(SUBTITLE_CACHE_SIZE >= LINE_CHARS, "Glyph cache must hold a whole line");
+
+struct SubtitleLine {
+    uint16_t start;
+    uint8_t length;
+};
+
+// Глиф, развёрнутый в цвета: одна строка пикселей на строку шрифта, с межбуквенным интервалом
+struct CachedGlyph {
+    uint16_t codepoint;
+    uint32_t last_use;
+    uint16_t pixels[SUBTITLE_FONT_HEIGHT][ADVANCE];
+};
+
+static const uint16_t NO_GLYPH = 0xffff;
+
+static bool enabled = false;
+static bool showing = false;
+static bool scroll_claimed = false;
+static uint32_t scroll_generation = 0;
+
+static uint16_t text[SUBTITLE_MAX_CHARS];
+static SubtitleLine lines[SUBTITLE_MAX_LINES];
+static int line_count = 0;
+
+static uint32_t start_us = 0;
+static uint32_t duration_us = 0;
+static uint32_t last_step_us = 0;
+static int first_line = 0;   // верхняя видимая строка текста
+static int scroll_px = 0;    // сдвиг к следующей строке, 0..LINE_PITCH-1
+static int scroll_top = 0;   // строка кольца, показанная вверху полосы
+
+static CachedGlyph cache[SUBTITLE_CACHE_SIZE];
+static uint32_t cache_clock = 0;
+static uint32_t cache_hits = 0;
+static uint32_t cache_misses = 0;
+static uint16_t text_color = 0;
+static uint16_t bg_color = 0;
+
+static uint16_t row_pixels[DISPLAY_WIDTH];
+
+// UTF-8 -> коды символов BMP; битые последовательности пропускаются
+static int decode_utf8(std::string_view utf8, uint16_t* out, int max_chars) {
+    int count = 0;
+    size_t i = 0;
+    while (i < utf8.size() && count < max_chars) {
+        uint8_t lead = utf8[i++];
+        uint32_t codepoint;
+        int extra;
+        if (lead < 0x80) {
+            codepoint = lead;
+            extra = 0;
+        } else if ((lead & 0xe0) == 0xc0) {
+            codepoint = lead & 0x1f;
+            extra = 1;
+        } else if ((lead & 0xf0) == 0xe0) {
+            codepoint = lead & 0x0f;
+            extra = 2;
+        } else if ((lead & 0xf8) == 0xf0) {
+            codepoint = lead & 0x07;
+            extra = 3;
+        } else {
+            continue;
+        }
+        bool valid = true;
+        for (int k = 0; k < extra; k++) {
+            if (i >= utf8.size() || (utf8[i] & 0xc0) != 0x80) {
+                valid = false;
+                break;
+            }
+            codepoint = (codepoint << 6) | (utf8[i++] & 0x3f);
+        }
+        if (!valid) {
+            continue;
+        }
+        if (codepoint < 0x20) {
+            codepoint = ' ';
+        }
+        out[count++] = codepoint <= 0xffff ? codepoint : '?';
+    }
+    return count;
+}
+
+// Перенос по словам; слово длиннее строки режется
+static void wrap_lines(int char_count) {
+    line_count = 0;
+    int pos = 0;
+    while (pos < char_count && line_count < SUBTITLE_MAX_LINES) {
+        while (pos < char_count && text[pos] == ' ') {
+            pos++;
+        }
+        if (pos >= char_count) {
+            break;
+        }
+        int end = std::min(pos + LINE_CHARS, char_count);
+        if (end < char_count && text[end] != ' ') {
+            int space = end;
+            while (space > pos && text[space] != ' ') {
+                space--;
+            }
+            if (space > pos) {
+                end = space;
+            }
+        }
+        int length = end - pos;
+        while (length > 0 && text[pos + length - 1] == ' ') {
+            length--;
+        }
+        lines[line_count++] = {(uint16_t)pos, (uint8_t)length};
+        pos = end;
+    }
+}
+
+static const SubtitleGlyph* find_glyph(uint16_t codepoint) {
+    int lo = 0;
+    int hi = SUBTITLE_FONT_GLYPHS - 1;
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        if (SUBTITLE_FONT[mid].codepoint == codepoint) {
+            return &SUBTITLE_FONT[mid];
+        }
+        if (SUBTITLE_FONT[mid].codepoint < codepoint) {
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return codepoint == '?' ? nullptr : find_glyph('?');
+}
+
+static void flush_cache() {
+    for (CachedGlyph& entry : cache) {
+        entry.codepoint = NO_GLYPH;
+    }
+}
+
+// Глиф из кэша; промах вытесняет давно не использованный
+static const CachedGlyph& cached_glyph(uint16_t codepoint) {
+    cache_clock++;
+    CachedGlyph* victim = &cache[0];
+    for (CachedGlyph& entry : cache) {
+        if (entry.codepoint == codepoint) {
+            entry.last_use = cache_clock;
+            cache_hits++;
+            return entry;
+        }
+        if (entry.codepoint == NO_GLYPH || entry.last_use < victim->last_use) {
+            victim = &entry;
+            if (entry.codepoint == NO_GLYPH) {
+                break;
+            }
+        }
+    }
+
+    cache_misses++;
+    const SubtitleGlyph* glyph = find_glyph(codepoint);
+    for (int row = 0; row < SUBTITLE_FONT_HEIGHT; row++) {
+        uint8_t bits = glyph ? glyph->rows[row] : 0;
+        uint16_t* out = victim->pixels[row];
+        for (int bx = 0; bx < SUBTITLE_FONT_WIDTH; bx++) {
+            std::fill(out, out + SUBTITLE_SCALE, (bits & (0x80 >> bx)) ? text_color : bg_color);
+            out += SUBTITLE_SCALE;
+        }
+        std::fill(out, victim->pixels[row] + ADVANCE, bg_color);
+    }
+    victim->codepoint = codepoint;
+    victim->last_use = cache_clock;
+    return *victim;
+}
+
+// Пиксельная строка `y` (0..LINE_PITCH-1) строки текста, по центру полосы
+static void compose_text_row(int line_index, int y) {
+    std::fill(row_pixels, row_pixels + DISPLAY_WIDTH, bg_color);
+    int glyph_y = y - LINE_TOP_MARGIN;
+    if (line_index < 0 || line_index >= line_count || glyph_y < 0 || glyph_y >= GLYPH_HEIGHT) {
+        return;
+    }
+    const SubtitleLine& line = lines[line_index];
+    int font_row = glyph_y / SUBTITLE_SCALE;
+    int x = (DISPLAY_WIDTH - line.length * ADVANCE + SUBTITLE_SCALE) / 2;
+    for (int i = 0; i < line.length; i++, x += ADVANCE) {
+        uint16_t codepoint = text[line.start + i];
+        if (codepoint == ' ') {
+            continue;
+        }
+        const uint16_t* pixels = cached_glyph(codepoint).pixels[font_row];
+        std::copy(pixels, pixels + std::min(ADVANCE, DISPLAY_WIDTH - x), row_pixels + x);
+    }
+}
+
+// Содержимое позиции полосы `position` с учётом незаконченного сдвига
+static void compose_band_row(int position) {
+    int content = position + scroll_px;
+    compose_text_row(first_line + content / LINE_PITCH, content % LINE_PITCH);
+}
+
+static void set_scroll(int top) {
+    scroll_top = top;
+    // Пока эффект панели держит прокрутку, полоса займёт её после него
+    if (panel_scroll_busy()) {
+        scroll_claimed = false;
+        return;
+    }
+    if (!scroll_claimed || scroll_generation != panel_scroll_generation()) {
+        panel_scroll_area(BAND_TOP, BAND_HEIGHT);
+        scroll_generation = panel_scroll_generation();
+        scroll_claimed = true;
+    }
+    panel_scroll_to(top);
+}
+
+// Вся полоса одним окном: строки кольца по порядку
+static void draw_band() {
+    st7789_set_window(0, BAND_TOP, DISPLAY_WIDTH - 1, DISPLAY_HEIGHT - 1);
+    for (int ring_row = 0; ring_row < BAND_HEIGHT; ring_row++) {
+        compose_band_row((ring_row - scroll_top + BAND_HEIGHT) % BAND_HEIGHT);
+        st7789_write(row_pixels, sizeof(row_pixels));
+    }
+}
+
+// Сдвиг на пиксель: уходящая вверх строка кольца получает строку следующей
+// строки текста и после прокрутки появляется внизу полосы
+static void scroll_step() {
+    compose_band_row(BAND_HEIGHT);
+    st7789_set_window(0, BAND_TOP + scroll_top, DISPLAY_WIDTH - 1, BAND_TOP + scroll_top);
+    st7789_write(row_pixels, sizeof(row_pixels));
+    set_scroll((scroll_top + 1) % BAND_HEIGHT);
+    if (++scroll_px == LINE_PITCH) {
+        scroll_px = 0;
+        first_line++;
+    }
+}
+
+static bool update_colors() {
+    const Palette& palette = get_active_palette();
+    uint16_t new_text = palette.colors[PALETTE_FACE];
+    uint16_t new_bg = palette.colors[PALETTE_BG];
+    if (new_text == text_color && new_bg == bg_color) {
+        return false;
+    }
+    text_color = new_text;
+    bg_color = new_bg;
+    flush_cache();
+    return true;
+}
+
+// Нулевой codepoint в пустом кэше выглядел бы закэшированным
+void subtitles_init() {
+    flush_cache();
+}
+
+void subtitles_set_enabled(bool new_enabled) {
+    if (!new_enabled) {
+        subtitles_clear();
+    }
+    enabled = new_enabled;
+    printf("[SUBTITLES] %s\n", enabled ? "Enabled" : "Disabled");
+}
+
+bool subtitles_enabled() {
+    return enabled;
+}
+
+void subtitles_start(std::string_view utf8, uint32_t duration_ms) {
+    if (!enabled) {
+        return;
+    }
+    subtitles_clear();
+    wrap_lines(decode_utf8(utf8, text, SUBTITLE_MAX_CHARS));
+    if (line_count == 0) {
+        return;
+    }
+
+    update_colors();
+    first_line = 0;
+    scroll_px = 0;
+    set_scroll(0);
+    draw_band();
+    showing = true;
+    start_us = time_us_32();
+    last_step_us = start_us;
+    duration_us = duration_ms * 1000;
+    printf("[SUBTITLES] %d line(s), %d per band\n", line_count, VISIBLE_LINES);
+}
+
+void subtitles_clear() {
+    if (!showing) {
+        return;
+    }
+    showing = false;
+    set_scroll(0);
+    st7789_set_window(0, BAND_TOP, DISPLAY_WIDTH - 1, DISPLAY_HEIGHT - 1);
+    st7789_fill_pixels(bg_color, (size_t)DISPLAY_WIDTH * BAND_HEIGHT);
+    printf("[SUBTITLES] Cleared, glyph cache hits %lu, misses %lu\n", cache_hits, cache_misses);
+}
+
+void subtitles_update(uint32_t now_us) {
+    if (!showing) {
+        return;
+    }
+    // Смена палитры (и перерисовка рамки фоном) - полоса целиком
+    if (update_colors()) {
+        draw_band();
+    }
+    // Тряска и переходы прокручивают экран: шаги ждут, потом полоса снова занимает область
+    if (panel_scroll_busy()) {
+        return;
+    }
+    if (!scroll_claimed || scroll_generation != panel_scroll_generation()) {
+        set_scroll(scroll_top);
+    }
+    if (now_us - last_step_us < SUBTITLE_SCROLL_STEP_US) {
+        return;
+    }
+    last_step_us = now_us;
+
+    // Произносимая строка - нижняя видимая
+    uint32_t elapsed = std::min(now_us - start_us, duration_us);
+    int spoken = duration_us ? (int)((uint64_t)elapsed * line_count / duration_us) : line_count - 1;
+    int target = std::max(0, std::min(spoken - (VISIBLE_LINES - 1), line_count - VISIBLE_LINES));
+    if (first_line < target || scroll_px > 0) {
+        scroll_step();
+    }
+}
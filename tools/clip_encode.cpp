@@ -0,0 +1,151 @@
+// Host encoder for face clips (include/emotions/face_clip.h): text frames in,
+// a .fclip file out, ready for tools/upload_assets.py. Every frame is decoded
+// back and compared, and the decoder is timed over the whole clip.
+//
+// Input: "frame <ms>" followed by 12 rows of 12 whitespace-separated palette
+// indices, repeated ("#" starts a comment). Build with the firmware's
+// FACE_BITS_PER_CELL:
+//
+//   g++ -std=c++17 -O2 -DFACE_BITS_PER_CELL=4 -Iinclude/emotions tools/clip_encode.cpp src/emotions/face_clip.cpp -o clip_encode
+//   ./clip_encode frames.txt blink.fclip [decode_rounds]
+
+#include "face_clip.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+struct Frame {
+    PackedFace packed{};
+    uint16_t duration_ms = 0;
+};
+
+static std::vector<Frame> read_frames(const char* path) {
+    std::ifstream input(path);
+    if (!input) {
+        fprintf(stderr, "cannot open %s\n", path);
+        exit(2);
+    }
+    std::vector<Frame> frames;
+    std::string line;
+    int row = MATRIX_ROWS;
+    while (std::getline(input, line)) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream words(line);
+        std::string first;
+        if (!(words >> first)) {
+            continue;
+        }
+        if (first == "frame") {
+            int duration = 0;
+            words >> duration;
+            frames.push_back(Frame());
+            frames.back().duration_ms = (uint16_t)std::max(1, std::min(duration, 0xffff));
+            row = 0;
+            continue;
+        }
+        if (row >= MATRIX_ROWS) {
+            fprintf(stderr, "row outside a frame: %s\n", line.c_str());
+            exit(2);
+        }
+        // Клетки - числа через пробел: индексы палитры бывают двузначными
+        std::vector<int> cells;
+        std::istringstream numbers(line);
+        int cell;
+        while (numbers >> cell) {
+            cells.push_back(cell);
+        }
+        if (!numbers.eof()) {
+            fprintf(stderr, "frame %zu row %d: not a number: %s\n", frames.size(), row, line.c_str());
+            exit(2);
+        }
+        if (cells.size() != (size_t)MATRIX_COLS) {
+            fprintf(stderr, "frame %zu row %d: %zu cells, need %d\n", frames.size(), row, cells.size(), MATRIX_COLS);
+            exit(2);
+        }
+        for (int col = 0; col < MATRIX_COLS; col++) {
+            if (cells[col] < 0 || cells[col] >= FACE_PALETTE_SIZE) {
+                fprintf(stderr, "frame %zu: cell %d does not fit %d bits\n", frames.size(), cells[col], FACE_BITS_PER_CELL);
+                exit(2);
+            }
+            frames.back().packed.set(row, col, cells[col]);
+        }
+        row++;
+    }
+    if (frames.empty() || row != MATRIX_ROWS) {
+        fprintf(stderr, "need at least one complete frame\n");
+        exit(2);
+    }
+    return frames;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        fprintf(stderr, "usage: %s frames.txt out.fclip [decode_rounds]\n", argv[0]);
+        return 2;
+    }
+    std::vector<Frame> frames = read_frames(argv[1]);
+    int rounds = argc > 3 ? atoi(argv[3]) : 1000;
+
+    std::vector<uint8_t> clip(sizeof(FaceClipHeader) + frames.size() * (2 + 2 * FACE_CLIP_PACKED_BYTES));
+    size_t used = face_clip_begin(frames[0].packed, clip.data(), clip.size());
+    for (size_t i = 0; i < frames.size(); i++) {
+        const PackedFace& previous = i ? frames[i - 1].packed : frames[0].packed;
+        used = face_clip_add_frame(previous, frames[i].packed, frames[i].duration_ms, clip.data(), used, clip.size());
+    }
+    used = face_clip_finish(clip.data(), used);
+    clip.resize(used);
+
+    // Проверка: декодер восстанавливает каждый кадр
+    FaceClipPlayer player;
+    if (!face_clip_open(player, clip.data(), clip.size())) {
+        return 1;
+    }
+    for (size_t i = 0; i < frames.size(); i++) {
+        if (i && !face_clip_next(player)) {
+            fprintf(stderr, "frame %zu: clip data ended early\n", i);
+            return 1;
+        }
+        for (int row = 0; row < MATRIX_ROWS; row++) {
+            for (int col = 0; col < MATRIX_COLS; col++) {
+                if (player.cells[row][col] != frames[i].packed.get(row, col)) {
+                    fprintf(stderr, "frame %zu: cell %d,%d decoded wrong\n", i, row, col);
+                    return 1;
+                }
+            }
+        }
+        if (player.duration_ms != frames[i].duration_ms) {
+            fprintf(stderr, "frame %zu: duration decoded wrong\n", i);
+            return 1;
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    uint32_t checksum = 0;
+    for (int round = 0; round < rounds; round++) {
+        for (size_t i = 0; i < frames.size(); i++) {
+            face_clip_next(player);
+            checksum += player.cells[MATRIX_ROWS / 2][MATRIX_COLS / 2];
+        }
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    double per_frame = rounds ? ns / ((double)rounds * frames.size()) : 0;
+
+    std::ofstream output(argv[2], std::ios::binary);
+    output.write((const char*)clip.data(), clip.size());
+    if (!output) {
+        fprintf(stderr, "cannot write %s\n", argv[2]);
+        return 2;
+    }
+
+    size_t raw = frames.size() * FACE_CLIP_PACKED_BYTES;
+    printf("{\"frames\": %zu, \"bytes\": %zu, \"bytes_per_frame\": %.1f, \"packed_bytes\": %zu, "
+           "\"ratio\": %.1f, \"decode_ns_per_frame\": %.0f, \"checksum\": %u}\n",
+           frames.size(), used, (double)used / frames.size(), raw, (double)raw / used, per_frame, checksum);
+    return 0;
+}
@@ -0,0 +1,91 @@
+#!/usr/bin/env python3
+"""Stream look-at targets to the robot and report command-to-photon latency.
+
+Sends "G <x> <y> <seq>" lines at a fixed rate (a slow circle by default, or
+targets read from stdin as "x y" pairs), then asks the firmware for its
+latency statistics with {"cmd": "gaze_stats"}:
+
+    {"gaze_stats": "stream", "targets": N, "superseded": K, "presented": M,
+     "last_seq": S, "p50_us": ..., "p99_us": ..., "max_us": ...}
+
+Latency is measured on the device from the end of a received line until the
+eye layer has written the first frame that moved the eyes toward it.
+
+Usage:
+    python3 tools/gaze_stream.py --port /dev/ttyACM0 --rate 60 --seconds 10
+    my_tracker | python3 tools/gaze_stream.py --port /dev/ttyACM0 --stdin
+"""
+
+import argparse
+import math
+import sys
+import time
+
+
+def circle_targets(radius):
+    start = time.time()
+    while True:
+        phase = (time.time() - start) * 2 * math.pi / 4.0  # один оборот за 4 с
+        yield round(radius * math.cos(phase)), round(radius * math.sin(phase))
+
+
+def stdin_targets():
+    for line in sys.stdin:
+        parts = line.split()
+        if len(parts) >= 2:
+            yield int(float(parts[0])), int(float(parts[1]))
+
+
+def request_stats(ser, timeout=2.0):
+    ser.reset_input_buffer()
+    ser.write(b'{"cmd": "gaze_stats"}\n')
+    deadline = time.time() + timeout
+    while time.time() < deadline:
+        line = ser.readline().decode("utf-8", errors="replace").strip()
+        if line.startswith('{"gaze_stats"'):
+            return line
+    return None
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--port", required=True, help="serial port of the robot")
+    parser.add_argument("--rate", type=float, default=60.0, help="targets per second")
+    parser.add_argument("--seconds", type=float, default=10.0, help="stream duration")
+    parser.add_argument("--radius", type=int, default=80, help="circle radius, -100..100 units")
+    parser.add_argument("--stdin", action="store_true", help='read "x y" targets from stdin')
+    args = parser.parse_args()
+
+    import serial  # pyserial
+
+    targets = stdin_targets() if args.stdin else circle_targets(args.radius)
+    period = 1.0 / args.rate
+
+    with serial.Serial(args.port, 115200, timeout=0.5) as ser:
+        ser.write(b'{"cmd": "gaze_stats_reset"}\n')
+        time.sleep(0.1)
+
+        sent = 0
+        next_send = time.time()
+        end = next_send + args.seconds
+        for x, y in targets:
+            now = time.time()
+            if not args.stdin and now >= end:
+                break
+            if now < next_send:
+                time.sleep(next_send - now)
+            ser.write(f"G {x} {y} {sent}\n".encode())
+            sent += 1
+            next_send += period
+
+        print(f"sent {sent} targets at {args.rate:g} Hz", file=sys.stderr)
+        stats = request_stats(ser)
+        if stats is None:
+            print("no gaze_stats reply", file=sys.stderr)
+            return 1
+        print(stats)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
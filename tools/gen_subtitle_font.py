@@ -0,0 +1,106 @@
+#!/usr/bin/env python3
+"""Convert tools/subtitle_font.txt into include/emotions/subtitle_font.h.
+
+Each glyph in the text file is a header line "U+XXXX name" followed by up to
+8 rows of 5 characters ("#" = pixel, "." = empty); missing rows are empty.
+"U+XXXX name = U+YYYY" reuses the bitmap of another glyph (Cyrillic letters
+that look like Latin ones).
+
+The header holds glyphs sorted by code point for binary search, one byte per
+row with the leftmost pixel in bit 7.
+
+Usage:
+    python3 tools/gen_subtitle_font.py
+"""
+
+import argparse
+import os
+import sys
+
+WIDTH = 5
+HEIGHT = 8
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+
+def parse(path):
+    glyphs = {}
+    aliases = {}
+    current = None
+    for number, raw in enumerate(open(path, encoding="utf-8"), 1):
+        line = raw.rstrip("\n")
+        if not line.strip() or line.startswith("#") and not set(line) <= {"#", "."}:
+            current = None
+            continue
+        if line.startswith("U+"):
+            parts = line.split()
+            code = int(parts[0][2:], 16)
+            if len(parts) == 4 and parts[2] == "=":
+                aliases[code] = int(parts[3][2:], 16)
+                current = None
+            else:
+                glyphs[code] = []
+                current = code
+            continue
+        if current is None or len(line) != WIDTH or not set(line) <= {"#", "."}:
+            sys.exit(f"{path}:{number}: unexpected line {line!r}")
+        if len(glyphs[current]) == HEIGHT:
+            sys.exit(f"{path}:{number}: glyph U+{current:04X} has more than {HEIGHT} rows")
+        glyphs[current].append(line)
+
+    for code, target in aliases.items():
+        if target not in glyphs:
+            sys.exit(f"U+{code:04X} refers to missing U+{target:04X}")
+        glyphs[code] = glyphs[target]
+    return glyphs
+
+
+def row_byte(row):
+    value = 0
+    for i, c in enumerate(row):
+        if c == "#":
+            value |= 0x80 >> i
+    return value
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--input", default=os.path.join(ROOT, "tools", "subtitle_font.txt"))
+    parser.add_argument("--output", default=os.path.join(ROOT, "include", "emotions", "subtitle_font.h"))
+    args = parser.parse_args()
+
+    glyphs = parse(args.input)
+    out = [
+        "// Generated by tools/gen_subtitle_font.py from tools/subtitle_font.txt, do not edit",
+        "#ifndef SUBTITLE_FONT_H",
+        "#define SUBTITLE_FONT_H",
+        "",
+        "#include <cstdint>",
+        "",
+        f"#define SUBTITLE_FONT_WIDTH {WIDTH}",
+        f"#define SUBTITLE_FONT_HEIGHT {HEIGHT}",
+        f"#define SUBTITLE_FONT_GLYPHS {len(glyphs)}",
+        "",
+        "// Glyph rows, leftmost pixel in bit 7; sorted by code point",
+        "struct SubtitleGlyph {",
+        "    uint16_t codepoint;",
+        "    uint8_t rows[SUBTITLE_FONT_HEIGHT];",
+        "};",
+        "",
+        "static const SubtitleGlyph SUBTITLE_FONT[SUBTITLE_FONT_GLYPHS] = {",
+    ]
+    for code in sorted(glyphs):
+        rows = glyphs[code] + ["." * WIDTH] * (HEIGHT - len(glyphs[code]))
+        data = ", ".join(f"0x{row_byte(r):02x}" for r in rows)
+        char = chr(code) if code > 0x20 and chr(code) not in "\\" else " "
+        out.append(f"    {{0x{code:04x}, {{{data}}}}},  // {char}")
+    out += ["};", "", "#endif // SUBTITLE_FONT_H", ""]
+
+    with open(args.output, "w", encoding="utf-8") as f:
+        f.write("\n".join(out))
+    print(f"{len(glyphs)} glyphs -> {args.output}", file=sys.stderr)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
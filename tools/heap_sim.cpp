@@ -0,0 +1,143 @@
+// Host soak run of the heap profiler: every round sends each emotion as a
+// JSON command through the firmware's parse_json, resets its state and
+// steps a face clip, with every new/delete counted under the emotion's tag,
+// then prints the same JSON as {"cmd":"heap_stats"} on the device. Exits
+// with 1 when live bytes grew between the first and the last round (a leak)
+// or a tag's peak is over the budget. The talking sequence and subtitles
+// need the SDK and are only measured on the device.
+//
+//   g++ -std=c++17 -O2 -DROBOT_HEAP_PROF=1 -Iinclude/core -Iinclude/emotions tools/heap_sim.cpp src/core/heap_prof.cpp src/core/states.cpp src/core/json_command.cpp src/emotions/face_clip.cpp -o heap_sim
+//   ./heap_sim [rounds] [budget_bytes]
+
+#include "heap_prof.h"
+#include "states.h"
+#include "fixed_string.h"
+#include "json_command.h"
+#include "face_clip.h"
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <fcntl.h>
+#include <unistd.h>
+
+// new/delete хоста идут в счётчики профилировщика, как перехват newlib на устройстве
+void* operator new(size_t size) {
+    void* ptr = malloc(size ? size : 1);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    heap_prof_alloc(ptr, size);
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept {
+    heap_prof_free(ptr);
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    operator delete(ptr);
+}
+
+// У хоста нет арены прошивки: фрагментацию показывает только устройство
+void heap_prof_arena(HeapArena& arena) {
+    arena = {};
+}
+
+static const char* const EMOTIONS[] = {
+    "neutral", "smile", "smile_love", "embarrassed", "scary", "happy", "sad", "surprise", "talking",
+};
+
+static NeutralState neutral_state;
+static TalkingState talking_state;
+static AnimState anim_state;
+
+// Клип из двух кадров: моргание, которое крутится всё время прогона
+static uint8_t clip[sizeof(FaceClipHeader) + 2 * (2 + 2 * FACE_CLIP_PACKED_BYTES)];
+static FaceClipPlayer player;
+
+static void make_clip() {
+    PackedFace open{}, closed{};
+    for (int col = 2; col < MATRIX_COLS - 2; col++) {
+        open.set(3, col, 1);
+        open.set(4, col, 1);
+        closed.set(4, col, 1);
+    }
+    size_t used = face_clip_begin(open, clip, sizeof(clip));
+    used = face_clip_add_frame(open, open, 120, clip, used, sizeof(clip));
+    used = face_clip_add_frame(open, closed, 40, clip, used, sizeof(clip));
+    used = face_clip_finish(clip, used);
+    if (!face_clip_open(player, clip, used)) {
+        fprintf(stderr, "clip did not encode\n");
+        exit(2);
+    }
+}
+
+// Один раунд: каждая эмоция приходит командой и включается, как в main.cpp
+static void run_round(int round) {
+    static FixedString<16> talking_emotion;
+    static char command[128];
+    for (const char* emotion : EMOTIONS) {
+        HEAP_TAG(emotion);
+        snprintf(command, sizeof(command), "{\"emotion\": \"%s\", \"intensity\": 0.%d, \"talking_emotion\": \"%s\"}",
+                 emotion, round % 10, EMOTIONS[round % (sizeof(EMOTIONS) / sizeof(EMOTIONS[0]))]);
+        JsonFields fields = parse_json(command);
+        const JsonField* name_field = fields.find("emotion");
+        const JsonField* talking_field = fields.find("talking_emotion");
+        if (!name_field || !talking_field) {
+            fprintf(stderr, "parse_json lost a field: %s\n", command);
+            exit(2);
+        }
+        std::string_view name = name_field->value;
+        void* state = name == "neutral" ? (void*)&neutral_state
+                    : name == "talking" ? (void*)&talking_state : (void*)&anim_state;
+        reset_state(name, state);
+        talking_emotion = talking_field->value;
+        face_clip_next(player);
+    }
+}
+
+int main(int argc, char** argv) {
+    int rounds = argc > 1 ? atoi(argv[1]) : 10000;
+    // Без бюджета пики только выводятся; 0 - эмоции не должны трогать кучу
+    bool has_budget = argc > 2;
+    uint32_t budget = has_budget ? (uint32_t)atoi(argv[2]) : 0;
+
+    make_clip();
+    // Лог разбора JSON на каждую команду не нужен: stdout молчит до отчёта
+    fflush(stdout);
+    int saved_stdout = dup(STDOUT_FILENO);
+    int null_fd = open("/dev/null", O_WRONLY);
+    dup2(null_fd, STDOUT_FILENO);
+    close(null_fd);
+
+    run_round(0);
+    uint32_t first_live = heap_prof_live();
+    for (int round = 1; round < rounds; round++) {
+        run_round(round);
+    }
+    uint32_t last_live = heap_prof_live();
+    fflush(stdout);
+    dup2(saved_stdout, STDOUT_FILENO);
+    close(saved_stdout);
+
+    heap_prof_report();
+    bool failed = false;
+    if (last_live > first_live) {
+        printf("LEAK: %u bytes live after round 1, %u after round %d\n", first_live, last_live, rounds);
+        failed = true;
+    }
+    for (const char* emotion : EMOTIONS) {
+        uint32_t peak = heap_prof_tag_peak(emotion);
+        if (has_budget && peak > budget) {
+            printf("OVER BUDGET: %s peak %u > %u bytes\n", emotion, peak, budget);
+            failed = true;
+        }
+    }
+    if (has_budget && heap_prof_tag_peak("parse_json") > budget) {
+        printf("OVER BUDGET: parse_json peak %u > %u bytes\n", heap_prof_tag_peak("parse_json"), budget);
+        failed = true;
+    }
+    printf("%d rounds, heap peak %u bytes: %s\n", rounds, heap_prof_peak(), failed ? "FAIL" : "ok");
+    return failed ? 1 : 0;
+}
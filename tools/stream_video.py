@@ -0,0 +1,161 @@
+#!/usr/bin/env python3
+"""Push a test video to the robot's framebuffer stream over USB.
+
+Sends {"cmd": "stream_start"}, then binary packets (include/display/fb_stream.h):
+a 16-byte header "FS", type, x, y, w, h, length and the payload. Frames are
+encoded up front and sent in a loop, so the numbers show what the USB link
+and the panel manage rather than the encoder. At the end a STOP packet makes
+the firmware print its {"stream": ...} report (fps and bytes per second).
+
+Modes:
+    rle     palette (PALETTE packet) and (count-1, index) runs; logos, QR codes
+    rgb565  raw pixels, 2 bytes each; photos, gradients
+
+Usage:
+    python3 tools/stream_video.py --port /dev/ttyACM0
+    python3 tools/stream_video.py --port /dev/ttyACM0 --mode rgb565 --seconds 5
+    python3 tools/stream_video.py --port /dev/ttyACM0 --gif logo.gif --rect 40,80,160,160
+    python3 tools/stream_video.py --output stream.bin --frames 10
+"""
+
+import argparse
+import itertools
+import json
+import struct
+import sys
+import time
+
+SCREEN_W = 240
+SCREEN_H = 320
+
+RECT_RGB565 = 1
+RECT_RLE = 2
+PALETTE = 3
+FRAME = 4
+STOP = 5
+
+
+def packet(kind, x=0, y=0, w=0, h=0, payload=b""):
+    return struct.pack("<2sBBHHHHI", b"FS", kind, 0, x, y, w, h, len(payload)) + payload
+
+
+def rgb565(r, g, b):
+    return (r & 0xF8) << 8 | (g & 0xFC) << 3 | b >> 3
+
+
+def rle(indices):
+    out = bytearray()
+    for value, group in itertools.groupby(indices):
+        count = sum(1 for _ in group)
+        while count:
+            run = min(count, 256)
+            out += bytes((run - 1, value))
+            count -= run
+    return bytes(out)
+
+
+# Тестовая картинка: бегущие полосы и прыгающий квадрат, 16 цветов
+TEST_PALETTE = [rgb565(int(255 * i / 7), 40, int(255 * (7 - i) / 7)) for i in range(8)] + \
+               [rgb565(255, 255, 255)] * 8
+
+
+def test_frames(count, w, h):
+    size = min(48, w, h)
+    for t in range(count):
+        bx = abs((t * 5) % (2 * (w - size)) - (w - size)) if w > size else 0
+        by = abs((t * 3) % (2 * (h - size)) - (h - size)) if h > size else 0
+        rows = []
+        for y in range(h):
+            band = ((y + t * 4) // 20) % 8
+            row = bytearray([band]) * w
+            if by <= y < by + size:
+                row[bx:bx + size] = bytes([8]) * size
+            rows.append(bytes(row))
+        yield TEST_PALETTE, b"".join(rows)
+
+
+def gif_frames(path, w, h):
+    from PIL import Image, ImageSequence  # Pillow
+
+    with Image.open(path) as image:
+        for frame in ImageSequence.Iterator(image):
+            picture = frame.convert("RGB").resize((w, h)).quantize(colors=256)
+            rgb = picture.getpalette()[:768]
+            colors = [rgb565(*rgb[i:i + 3]) for i in range(0, len(rgb), 3)]
+            yield colors, picture.tobytes()
+
+
+def encode(frames, mode, x, y, w, h):
+    encoded = []
+    for colors, indices in frames:
+        if mode == "rle":
+            data = packet(PALETTE, 0, 0, len(colors), 0, struct.pack(f"<{len(colors)}H", *colors))
+            data += packet(RECT_RLE, x, y, w, h, rle(indices))
+        else:
+            pixels = [struct.pack("<H", color) for color in colors]
+            data = packet(RECT_RGB565, x, y, w, h, b"".join(pixels[i] for i in indices))
+        encoded.append(data + packet(FRAME))
+    return encoded
+
+
+def wait_line(ser, prefix, timeout):
+    deadline = time.time() + timeout
+    while time.time() < deadline:
+        line = ser.readline().decode("utf-8", errors="replace").strip()
+        if line.startswith(prefix):
+            return line
+    return None
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--port", help="serial port of the robot")
+    parser.add_argument("--output", help="write the packets to a file instead")
+    parser.add_argument("--mode", choices=("rle", "rgb565"), default="rle")
+    parser.add_argument("--gif", help="animated GIF instead of the test pattern (needs Pillow)")
+    parser.add_argument("--rect", default=f"0,0,{SCREEN_W},{SCREEN_H}", help="x,y,w,h on the screen")
+    parser.add_argument("--frames", type=int, default=60, help="test pattern frames to encode")
+    parser.add_argument("--seconds", type=float, default=10, help="how long to loop the video")
+    args = parser.parse_args()
+
+    x, y, w, h = (int(v) for v in args.rect.split(","))
+    if w <= 0 or h <= 0 or x + w > SCREEN_W or y + h > SCREEN_H:
+        sys.exit(f"--rect must fit the {SCREEN_W}x{SCREEN_H} screen")
+    frames = gif_frames(args.gif, w, h) if args.gif else test_frames(args.frames, w, h)
+    encoded = encode(frames, args.mode, x, y, w, h)
+    average = sum(len(frame) for frame in encoded) / len(encoded)
+    print(f"{len(encoded)} frames, {average:.0f} bytes per frame ({args.mode})")
+
+    if args.output:
+        with open(args.output, "wb") as output:
+            output.write(b"".join(encoded) + packet(STOP))
+        return
+    if not args.port:
+        sys.exit("--port or --output is required")
+
+    import serial  # pyserial
+
+    with serial.Serial(args.port, 115200, timeout=0.5) as ser:
+        ser.reset_input_buffer()
+        ser.write((json.dumps({"cmd": "stream_start"}) + "\n").encode())
+        if not wait_line(ser, '{"status"', 3.0):
+            sys.exit("no reply to stream_start")
+
+        # USB не теряет данные: запись блокируется, пока прошивка не заберёт пакеты
+        sent = frames_sent = 0
+        start = time.time()
+        for frame in itertools.cycle(encoded):
+            ser.write(frame)
+            sent += len(frame)
+            frames_sent += 1
+            if time.time() - start >= args.seconds:
+                break
+        ser.write(packet(STOP))
+        ser.flush()
+        elapsed = time.time() - start
+        print(f"host: {frames_sent / elapsed:.1f} fps, {sent / elapsed:.0f} B/s")
+        print(wait_line(ser, '{"stream"', 5.0) or "no stream report")
+
+
+if __name__ == "__main__":
+    main()
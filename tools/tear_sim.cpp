@@ -0,0 +1,113 @@
+// Host simulation of tear-free presentation: the scanline model and the
+// write scheduler from src/display/scanline_model.cpp against a line-by-line
+// replay of the panel refresh, for face updates arriving at random times.
+//
+//   g++ -std=c++17 -O2 -Iinclude/display tools/tear_sim.cpp src/display/scanline_model.cpp -o tear_sim
+//   ./tear_sim [frames]
+
+#include "scanline_model.h"
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// Кадр лица 12x12 (клетка 20 px, лицо с y = 40): типичные изменённые полосы
+struct Update {
+    const char* name;
+    std::vector<ScanRect> rects;
+};
+
+static ScanRect cells(int first_row, int last_row, int first_col, int last_col) {
+    int y0 = 40 + first_row * 20;
+    int y1 = 40 + (last_row + 1) * 20 - 1;
+    return {(int16_t)y0, (int16_t)y1, (uint32_t)(last_col - first_col + 1) * 20 * (y1 - y0 + 1)};
+}
+
+static const Update UPDATES[] = {
+    {"blink", {cells(2, 4, 2, 4), cells(2, 4, 7, 9)}},
+    {"mouth", {cells(8, 10, 3, 8)}},
+    {"talk", {cells(2, 3, 2, 9), cells(8, 10, 2, 9)}},
+    {"full", {cells(0, 11, 0, 11)}},
+};
+
+// Независимая проверка: строки полосы записываются по порядку с постоянной скоростью,
+// луч читает каждую строку раз в кадр; разрыв - проход луча видит и старые, и новые строки
+static bool replay_tears(const ScanlineModel& m, const ScanRect& r, uint32_t start, uint32_t end) {
+    int rows = r.y1 - r.y0 + 1;
+    int64_t first_frame = ((int64_t)start - m.vsync_us) / m.frame_us - 2;
+    for (int64_t k = first_frame; k < first_frame + 6 + (end - start) / m.frame_us; k++) {
+        int64_t frame_start = (int64_t)m.vsync_us + k * m.frame_us;
+        bool seen_old = false, seen_new = false;
+        for (int y = r.y0; y <= r.y1; y++) {
+            int scan_row = m.top_down ? y : m.active_lines - 1 - y;
+            int64_t t = frame_start + m.line_start_us(m.porch_lines + scan_row);
+            int64_t written = start + (int64_t)(end - start) * (y - r.y0 + 1) / rows;
+            if (t >= written) {
+                seen_new = true;
+            } else {
+                seen_old = true;
+            }
+        }
+        // Проход целиком до или после записи не считается
+        int64_t pass_start = frame_start + m.line_start_us(m.porch_lines + (m.top_down ? r.y0 : m.active_lines - 1 - r.y1));
+        if (seen_old && seen_new && pass_start + m.frame_us > (int64_t)start) {
+            return true;
+        }
+    }
+    return false;
+}
+
+struct Result {
+    int writes = 0;
+    int tears = 0;
+    int model_mismatch = 0;
+    uint64_t wait_us = 0;
+};
+
+static void run(const ScanlineModel& m, bool scheduled, int frames, Result& result) {
+    srand(1);
+    for (int f = 0; f < frames; f++) {
+        const Update& u = UPDATES[rand() % (sizeof(UPDATES) / sizeof(UPDATES[0]))];
+        uint32_t t = 1000000 + (uint32_t)f * 16667 * 3 + rand() % 16667;
+        uint8_t order[32];
+        int count = (int)u.rects.size();
+        if (scheduled) {
+            scanline_order(m, u.rects.data(), count, t, order);
+        } else {
+            for (int i = 0; i < count; i++) {
+                order[i] = i;
+            }
+        }
+        for (int i = 0; i < count; i++) {
+            const ScanRect& r = u.rects[order[i]];
+            uint32_t duration = m.write_us(r.pixels);
+            if (scheduled) {
+                uint32_t delay = m.safe_delay(r.y0, r.y1, duration, t);
+                result.wait_us += delay;
+                t += delay;
+            }
+            bool tear = replay_tears(m, r, t, t + duration);
+            result.writes++;
+            result.tears += tear;
+            result.model_mismatch += tear != m.tears(r.y0, r.y1, t, t + duration);
+            t += duration;
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    int frames = argc > 1 ? atoi(argv[1]) : 2000;
+    for (int top_down = 1; top_down >= 0; top_down--) {
+        ScanlineModel m;
+        m.top_down = top_down;
+        m.vsync_us = 1234;
+        for (int scheduled = 0; scheduled <= 1; scheduled++) {
+            Result r;
+            run(m, scheduled, frames, r);
+            printf("%-9s %-9s writes %5d  tears %5d (%5.1f%%)  model mismatches %d  avg wait %lu us\n",
+                   top_down ? "top-down" : "bottom-up", scheduled ? "scheduled" : "immediate",
+                   r.writes, r.tears, 100.0 * r.tears / r.writes, r.model_mismatch,
+                   (unsigned long)(r.wait_us / r.writes));
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,128 @@
+#!/usr/bin/env python3
+"""Convert a robot_pico trace dump into Chrome/Perfetto trace-event JSON.
+
+The firmware prints the ring buffer in response to {"cmd": "trace_dump"}:
+
+    [TRACE] Dump begin: events=N dropped=M
+    T <timestamp_us> <B|E> <name>
+    ...
+    [TRACE] Dump end
+
+Usage:
+    python3 tools/trace_to_chrome.py serial.log -o trace.json
+    python3 tools/trace_to_chrome.py --port /dev/ttyACM0 -o trace.json
+
+Open the result in chrome://tracing or https://ui.perfetto.dev.
+"""
+
+import argparse
+import json
+import sys
+import time
+
+DUMP_BEGIN = "[TRACE] Dump begin"
+DUMP_END = "[TRACE] Dump end"
+
+
+def read_from_port(port, timeout):
+    import serial  # pyserial, only needed for live capture
+
+    with serial.Serial(port, 115200, timeout=0.5) as ser:
+        ser.reset_input_buffer()
+        ser.write(b'{"cmd": "trace_dump"}\n')
+        lines = []
+        deadline = time.time() + timeout
+        while time.time() < deadline:
+            line = ser.readline().decode("utf-8", errors="replace").rstrip()
+            if not line:
+                continue
+            lines.append(line)
+            if line.startswith(DUMP_END):
+                break
+        return lines
+
+
+def parse_dump(lines):
+    """Return (timestamp_us, phase, name) tuples of the last dump in the log.
+
+    A dump that was cut off before its end marker is used as-is.
+    """
+    events = []
+    for line in lines:
+        line = line.strip()
+        if line.startswith(DUMP_BEGIN):
+            events = []
+        elif line.startswith("T "):
+            parts = line.split()
+            if len(parts) != 4 or parts[2] not in ("B", "E"):
+                continue
+            events.append((int(parts[1]), parts[2], parts[3]))
+    return events
+
+
+def unwrap_timestamps(events):
+    """time_us_32() wraps every ~71.6 minutes; make timestamps monotonic."""
+    offset = 0
+    previous = None
+    unwrapped = []
+    for ts, phase, name in events:
+        if previous is not None and ts < previous and previous - ts > (1 << 31):
+            offset += 1 << 32
+        previous = ts
+        unwrapped.append((ts + offset, phase, name))
+    return unwrapped
+
+
+def to_chrome(events):
+    trace_events = []
+    depth = {}
+    base = events[0][0] if events else 0
+    for ts, phase, name in events:
+        # The ring buffer may start in the middle of a span: drop unmatched ends
+        if phase == "E":
+            if depth.get(name, 0) == 0:
+                continue
+            depth[name] -= 1
+        else:
+            depth[name] = depth.get(name, 0) + 1
+        trace_events.append({
+            "name": name,
+            "cat": "draw" if name.startswith(("draw_", "st7789")) else "main",
+            "ph": phase,
+            "ts": ts - base,
+            "pid": 1,
+            "tid": 1,
+        })
+    return {"traceEvents": trace_events, "displayTimeUnit": "ms"}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("log", nargs="?", help="serial log containing a trace dump")
+    parser.add_argument("--port", help="request a dump from this serial port")
+    parser.add_argument("--timeout", type=float, default=10.0)
+    parser.add_argument("-o", "--output", default="trace.json")
+    args = parser.parse_args()
+
+    if args.port:
+        lines = read_from_port(args.port, args.timeout)
+    elif args.log:
+        with open(args.log, encoding="utf-8", errors="replace") as f:
+            lines = f.read().splitlines()
+    else:
+        parser.error("either a log file or --port is required")
+
+    events = unwrap_timestamps(parse_dump(lines))
+    if not events:
+        print("No trace events found", file=sys.stderr)
+        return 1
+
+    with open(args.output, "w") as f:
+        json.dump(to_chrome(events), f)
+    span_ms = (events[-1][0] - events[0][0]) / 1000.0
+    print(f"Wrote {len(events)} events covering {span_ms:.1f} ms to {args.output}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,143 @@
+#!/usr/bin/env python3
+"""Upload faces and animations into the robot's flash asset region.
+
+Reads an asset file and sends one command per asset (several for a clip):
+
+    face wink               # 12 rows of 12 palette indices
+    0 0 0 0 0 0 0 0 0 0 0 0
+    ...
+    anim wink_loop          # frames: uploaded face and duration in ms
+    wink:120, neutral_up:400
+    clip talk blink.fclip   # made by tools/clip_encode.cpp, path relative to the file
+
+Faces go out as {"cmd": "asset_face", "name": ..., "cells": "<hex>"} with
+the cells packed like PackedFace (FACE_BITS_PER_CELL bits per cell, row by
+row, first cell in the low bits); animations as {"cmd": "asset_anim", ...};
+clips as {"cmd": "asset_clip", "name": ..., "offset": ..., "size": ...,
+"data": "<hex>"} chunks of up to 512 bytes, in order.
+The firmware appends them to the region; a name uploaded again replaces the
+older asset. Show one with {"emotion": "wink", "duration": 5}.
+
+Usage:
+    python3 tools/upload_assets.py --port /dev/ttyACM0 faces.txt
+    python3 tools/upload_assets.py --port /dev/ttyACM0 --erase --bits 2 faces.txt
+    python3 tools/upload_assets.py --dry-run faces.txt
+"""
+
+import argparse
+import json
+import os
+import sys
+import time
+
+ROWS = 12
+COLS = 12
+CLIP_CHUNK = 512
+
+
+def parse_assets(path):
+    assets = []
+    with open(path, encoding="utf-8") as source:
+        lines = [line.split("#")[0].strip() for line in source]
+    lines = [line for line in lines if line]
+    i = 0
+    while i < len(lines):
+        kind, _, name = lines[i].partition(" ")
+        name = name.strip()
+        if kind == "face":
+            rows = []
+            for line in lines[i + 1:i + 1 + ROWS]:
+                cells = [int(c) for c in (line.split() if " " in line else line)]
+                if len(cells) != COLS:
+                    sys.exit(f"face {name}: row '{line}' needs {COLS} cells")
+                rows.append(cells)
+            if len(rows) != ROWS:
+                sys.exit(f"face {name}: needs {ROWS} rows")
+            assets.append(("face", name, rows))
+            i += 1 + ROWS
+        elif kind == "anim":
+            frames = lines[i + 1].replace(" ", "")
+            assets.append(("anim", name, frames))
+            i += 2
+        elif kind == "clip":
+            name, _, clip_path = name.partition(" ")
+            with open(os.path.join(os.path.dirname(path), clip_path.strip()), "rb") as clip:
+                assets.append(("clip", name, clip.read()))
+            i += 1
+        else:
+            sys.exit(f"unknown line '{lines[i]}', expected 'face <name>', 'anim <name>' or 'clip <name> <file>'")
+    return assets
+
+
+def pack_face(rows, bits):
+    data = bytearray((ROWS * COLS * bits + 7) // 8)
+    for row in range(ROWS):
+        for col in range(COLS):
+            value = rows[row][col]
+            if value >= 1 << bits:
+                raise ValueError(f"cell {value} does not fit {bits} bits")
+            bit = (row * COLS + col) * bits
+            data[bit // 8] |= value << (bit % 8)
+    return data.hex()
+
+
+def asset_commands(asset, bits):
+    kind, name, body = asset
+    if kind == "face":
+        return [{"cmd": "asset_face", "name": name, "cells": pack_face(body, bits)}]
+    if kind == "clip":
+        if body[:4] != b"FCLP" or body[6] != bits:
+            sys.exit(f"clip {name}: not a clip encoded for {bits} bits per cell")
+        return [{"cmd": "asset_clip", "name": name, "offset": offset, "size": len(body),
+                 "data": body[offset:offset + CLIP_CHUNK].hex()}
+                for offset in range(0, len(body), CLIP_CHUNK)]
+    return [{"cmd": "asset_anim", "name": name, "frames": body}]
+
+
+def send(ser, command, timeout=3.0):
+    # Запись во флеш идёт с выключенными прерываниями: ждём ответа на каждую команду
+    ser.write((json.dumps(command) + "\n").encode())
+    deadline = time.time() + timeout
+    while time.time() < deadline:
+        line = ser.readline().decode("utf-8", errors="replace").strip()
+        if line.startswith('{"status"') or line.startswith('{"assets"'):
+            return True, line
+        if line.startswith("[ERROR]"):
+            return False, line
+    return False, "no reply"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("file", help="asset file")
+    parser.add_argument("--port", help="serial port of the robot")
+    parser.add_argument("--bits", type=int, choices=(2, 4), default=4, help="FACE_BITS_PER_CELL of the firmware")
+    parser.add_argument("--erase", action="store_true", help="erase the asset region first")
+    parser.add_argument("--dry-run", action="store_true", help="print the commands instead of sending")
+    args = parser.parse_args()
+
+    commands = [command for asset in parse_assets(args.file) for command in asset_commands(asset, args.bits)]
+    if args.erase:
+        commands.insert(0, {"cmd": "asset_erase"})
+    commands.append({"cmd": "asset_list"})
+
+    if args.dry_run:
+        for command in commands:
+            print(json.dumps(command))
+        return
+    if not args.port:
+        sys.exit("--port is required unless --dry-run")
+
+    import serial  # pyserial
+
+    with serial.Serial(args.port, 115200, timeout=0.5) as ser:
+        ser.reset_input_buffer()
+        for command in commands:
+            ok, reply = send(ser, command)
+            print(f"{command['cmd']} {command.get('name', '')}: {reply}")
+            if not ok:
+                sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()